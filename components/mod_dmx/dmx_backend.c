@@ -0,0 +1,32 @@
+/**
+ * @file dmx_backend.c
+ * @brief DMX output backend registry
+ */
+
+#include "dmx_backend.h"
+#include <string.h>
+
+static const dmx_backend_ops_t *s_backends[DMX_BACKEND_MAX];
+static int s_backend_count = 0;
+
+esp_err_t dmx_backend_register(const dmx_backend_ops_t *ops)
+{
+    if (!ops || !ops->name || !ops->init || !ops->submit || !ops->deinit) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < s_backend_count; ++i) {
+        if (s_backends[i] == ops) return ESP_OK;
+    }
+    if (s_backend_count >= DMX_BACKEND_MAX) return ESP_ERR_NO_MEM;
+    s_backends[s_backend_count++] = ops;
+    return ESP_OK;
+}
+
+const dmx_backend_ops_t *dmx_backend_find(const char *name)
+{
+    if (!name) return NULL;
+    for (int i = 0; i < s_backend_count; ++i) {
+        if (strcmp(s_backends[i]->name, name) == 0) return s_backends[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file dmx_backend.h
+ * @brief DMX output backend interface (MOD_DMX internal)
+ *
+ * Every output driver (RMT, UART, virtual, ...) exports one ops table. The
+ * core keeps a registry of tables and binds one to each port at runtime; it
+ * only ever talks to a port through its table.
+ *
+ * Contract:
+ *  - submit() never blocks. It returns ESP_ERR_INVALID_STATE when the
+ *    backend has no room for another frame (the previous one has not
+ *    finished); the core retries on the next completion.
+ *  - Every accepted frame is reported exactly once, in submission order,
+ *    through the on_frame_done callback given to init(). The callback may
+ *    run in ISR, esp_timer or (virtual backend) thread context.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "dmx_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DMX_BACKEND_MAX  8   // Registry capacity
+
+/**
+ * @brief Completion callback, see contract above
+ * @return true if a higher priority task was woken (ISR callers should yield)
+ */
+typedef bool (*dmx_frame_done_cb_t)(int port);
+
+/**
+ * @brief Per-port backend configuration
+ */
+typedef struct {
+    int gpio_tx;                    // TX pin (-1 if unused)
+    int gpio_de;                    // RS-485 driver enable (-1 if unused)
+    int hw_unit;                    // Peripheral unit, e.g. UART number (-1 = any)
+    const char *target;             // Backend specific (virtual: output path)
+    dmx_frame_done_cb_t on_frame_done;
+} dmx_backend_port_cfg_t;
+
+/**
+ * @brief Backend counters exposed through dmx_port_stats_t
+ */
+typedef struct {
+    uint16_t isr_last;              // Interrupts for the last frame
+    uint16_t isr_max;               // Worst interrupts per frame since reset
+    bool dma;                       // Frames are streamed via DMA
+} dmx_backend_stats_t;
+
+/**
+ * @brief Backend operations table
+ *
+ * stats and reset_stats are optional (NULL).
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(int port, const dmx_backend_port_cfg_t *cfg);
+    esp_err_t (*submit)(int port, const uint8_t *data, uint16_t len, const dmx_timing_t *timing);
+    esp_err_t (*deinit)(int port);
+    void (*stats)(int port, dmx_backend_stats_t *out);
+    void (*reset_stats)(int port);
+} dmx_backend_ops_t;
+
+/**
+ * @brief Add a backend to the registry
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on missing ops, ESP_ERR_NO_MEM when full.
+ *         Registering the same table twice is a no-op.
+ */
+esp_err_t dmx_backend_register(const dmx_backend_ops_t *ops);
+
+/**
+ * @brief Look up a registered backend by name
+ * @return Ops table or NULL
+ */
+const dmx_backend_ops_t *dmx_backend_find(const char *name);
+
+/* Built-in backends */
+extern const dmx_backend_ops_t dmx_rmt_backend;
+extern const dmx_backend_ops_t dmx_uart_backend;
+extern const dmx_backend_ops_t dmx_virtual_backend;
+extern const dmx_backend_ops_t dmx_lcd_backend;      // CONFIG_MODDMX_LCD_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,61 +1,352 @@
 #include "mod_dmx.h"
 #include "dmx_types.h"
-#include "sys_mod.h"  // For sys_get_dmx_buffer, sys_snapshot_restore, sys_get_config, sys_get_state
+#include "sys_mod.h"  // For sys_dmx_acquire_frame, sys_snapshot_restore, sys_get_config, sys_get_state
 #include "esp_log.h"
-#include "driver/uart.h"
 #include "esp_timer.h"
+#include "esp_attr.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "dmx_sched.h"
+#include "dmx_backend.h"
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/uart.h"
+#endif
 #include <string.h>
 
 static const char *TAG = "MOD_DMX";
 
 
-// Forward declarations for backend implementations
-esp_err_t dmx_rmt_init(int port_idx, int gpio_tx);
-esp_err_t dmx_rmt_send_frame(int port_idx, const uint8_t* data, uint16_t len);
+bool dmx_core_frame_done(int port_idx);
 
-esp_err_t dmx_uart_init_port(int port_idx, uart_port_t uart_num, int tx_pin, int de_pin);
-void IRAM_ATTR dmx_uart_send_frame(int port_idx, const uint8_t* data);
+// Default port -> backend mapping and wiring
+typedef struct {
+    const char *backend;
+    dmx_backend_port_cfg_t cfg;
+} dmx_port_map_t;
+
+static const dmx_port_map_t s_default_map[DMX_PORT_COUNT] = {
+#if CONFIG_IDF_TARGET_LINUX
+    [DMX_PORT_A] = { "virtual", { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1 } },
+    [DMX_PORT_B] = { "virtual", { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1 } },
+    [DMX_PORT_C] = { "virtual", { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1 } },
+    [DMX_PORT_D] = { "virtual", { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1 } },
+#if DMX_PORT_COUNT > 4
+    [4 ... DMX_PORT_COUNT - 1] = { "virtual", { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1 } },
+#endif
+#else
+    [DMX_PORT_A] = { "rmt",  { .gpio_tx = GPIO_PORT_A_TX, .gpio_de = -1, .hw_unit = -1 } },
+    [DMX_PORT_B] = { "rmt",  { .gpio_tx = GPIO_PORT_B_TX, .gpio_de = -1, .hw_unit = -1 } },
+    [DMX_PORT_C] = { "uart", { .gpio_tx = GPIO_PORT_C_TX, .gpio_de = GPIO_PORT_C_DE, .hw_unit = UART_NUM_1 } },
+    [DMX_PORT_D] = { "uart", { .gpio_tx = GPIO_PORT_D_TX, .gpio_de = GPIO_PORT_D_DE, .hw_unit = UART_NUM_2 } },
+#if DMX_PORT_COUNT > 4
+    // Lane N of the LCD_CAM bus; its pins come from CONFIG_MODDMX_LCD_DATA_GPIOS
+    [4 ... DMX_PORT_COUNT - 1] = { "lcd", { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1 } },
+#endif
+#endif
+};
+
+// Frame handed to a backend and not yet reported complete
+typedef struct {
+    int64_t start_us;
+    int64_t deadline_us;
+    int64_t rx_us;          // oldest merge carried by this frame, 0 if none
+} dmx_inflight_t;
 
-// Local port metadata
-typedef enum {
-    DMX_BACKEND_RMT = 0,
-    DMX_BACKEND_UART = 1,
-} dmx_backend_t;
+// Backends double-buffer: one frame on the wire, one queued behind it.
+#define DMX_MAX_INFLIGHT 2
 
 typedef struct {
-    dmx_backend_t backend;
+    const dmx_backend_ops_t *ops;   // bound backend, NULL until dmx_init
+    bool attached;                  // ops->init succeeded
     bool enabled;
     dmx_timing_t timing; // local cached timing
     bool in_failsafe;
     uint8_t snapshot[DMX_UNIVERSE_SIZE];
+
+    // Transmit bookkeeping: FIFO of submitted frames, pushed by the task
+    // before submitting and popped by dmx_core_frame_done(), which backends
+    // call from their completion callback (ISR or esp_timer context).
+    // Guarded by s_inflight_lock.
+    dmx_inflight_t inflight[DMX_MAX_INFLIGHT];
+    uint8_t inflight_head;
+    volatile uint8_t inflight_count;
+    volatile bool waiting;      // backend full at deadline; wake task on completion
+    // Newest data not yet submitted: set by the sys_mod update hook (MOD_PROTO
+    // context), taken by the task at submit. Guarded by s_inflight_lock.
+    int64_t rx_pending_us;      // oldest unsent merge, 0 if none
+    volatile bool data_ready;   // latency mode: deadline must be pulled in
+    uint8_t output_mode;        // dmx_output_mode_t, cached from config
+    uint32_t cfg_gen;           // config generation cached, 0 = reload next pass
+    uint16_t slots;             // channels in the next frame (slot_count resolved)
+    dmx_sched_port_t sched;
+    dmx_port_stats_t stats;
+    uint32_t fps_window_frames; // stats.frames_sent at start of window
+    int64_t fps_window_start_us;
 } dmx_port_ctx_t;
 
+#define DMX_FPS_WINDOW_US 1000000LL
+#define DMX_FRAME_STALL_US 100000LL // completion overdue -> assume lost
+#define DMX_MAX_SLEEP_MS 50         // upper bound on one scheduler sleep
+// Start lateness beyond one tick of wake-up rounding, charged to a flash
+// write if one ran since the previous pass
+#define DMX_FLASH_LATE_US ((uint32_t)portTICK_PERIOD_MS * 1000U)
+
 static dmx_port_ctx_t s_ports[DMX_PORT_COUNT];
 static TaskHandle_t s_task = NULL;
 static bool s_running = false;
+static portMUX_TYPE s_inflight_lock = portMUX_INITIALIZER_UNLOCKED;
+// Serializes backend (re)binding against the task's submit pass
+static SemaphoreHandle_t s_backend_mutex = NULL;
+
+/**
+ * @brief Completion hook for backends
+ *
+ * Called once per accepted frame, in submission order, when the last stop
+ * bit has left the transmitter. Safe to call from ISR context.
+ *
+ * @return true if a higher priority task was woken (ISR callers should yield)
+ */
+bool IRAM_ATTR dmx_core_frame_done(int port_idx)
+{
+    if (port_idx < 0 || port_idx >= DMX_PORT_COUNT) return false;
+    dmx_port_ctx_t *p = &s_ports[port_idx];
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL_SAFE(&s_inflight_lock);
+    if (p->inflight_count == 0) {
+        portEXIT_CRITICAL_SAFE(&s_inflight_lock);
+        return false;
+    }
+    dmx_inflight_t f = p->inflight[p->inflight_head];
+    p->inflight_head = (uint8_t)((p->inflight_head + 1) % DMX_MAX_INFLIGHT);
+    p->inflight_count--;
+    bool wake = p->waiting;
+    p->waiting = false;
+    portEXIT_CRITICAL_SAFE(&s_inflight_lock);
+
+    if (f.rx_us) {
+        // Break of this frame started one wire time before completion (or at
+        // submit, if the backend reports early)
+        int64_t wire_us = (int64_t)p->timing.break_us + p->timing.mab_us +
+                          ((int64_t)p->slots + 1) * DMX_SLOT_WIRE_US;
+        int64_t wire_start = now - wire_us;
+        if (wire_start < f.start_us) wire_start = f.start_us;
+        uint32_t lat = wire_start > f.rx_us ? (uint32_t)(wire_start - f.rx_us) : 0;
+        p->stats.latency_last_us = lat;
+        if (lat > p->stats.latency_max_us) p->stats.latency_max_us = lat;
+        p->stats.latency_avg_us = (uint32_t)((int32_t)p->stats.latency_avg_us +
+                                             ((int32_t)lat - (int32_t)p->stats.latency_avg_us) / 16);
+    }
+
+    bool met = now <= f.deadline_us;
+    p->stats.last_frame_us = (uint32_t)(now - f.start_us);
+    p->stats.last_deadline_met = met;
+    if (met) p->stats.deadline_met++;
+    else p->stats.deadline_missed++;
+    p->stats.frames_sent++;
+
+    // The scheduler is sleeping past this port's deadline: start the next frame now
+    BaseType_t woken = pdFALSE;
+    if (wake && s_task) {
+        if (xPortInIsrContext()) {
+            vTaskNotifyGiveFromISR(s_task, &woken);
+        } else {
+            xTaskNotifyGive(s_task);
+        }
+    }
+    return woken == pdTRUE;
+}
 
-static void IRAM_ATTR dmx_task_main(void *arg)
+/**
+ * @brief sys_mod update hook: a merge changed a port's buffer
+ *
+ * Records when the data arrived and, in latency mode, wakes the task so the
+ * frame starts without waiting for the next periodic deadline.
+ */
+static void dmx_on_data_update(int port_idx, int64_t timestamp_us)
 {
-    TickType_t last = xTaskGetTickCount();
-    const TickType_t period = pdMS_TO_TICKS(25); // default 40Hz
+    if (port_idx < 0 || port_idx >= DMX_PORT_COUNT) return;
+    dmx_port_ctx_t *p = &s_ports[port_idx];
+
+    portENTER_CRITICAL(&s_inflight_lock);
+    if (p->rx_pending_us == 0) p->rx_pending_us = timestamp_us;
+    portEXIT_CRITICAL(&s_inflight_lock);
+
+    if (p->output_mode == DMX_OUTPUT_LATENCY) {
+        p->data_ready = true;
+        if (s_task) xTaskNotifyGive(s_task);
+    }
+}
+
+// Push a frame and hand it the pending merge timestamp
+static void dmx_inflight_push(dmx_port_ctx_t *p, int64_t start_us, int64_t deadline_us)
+{
+    portENTER_CRITICAL(&s_inflight_lock);
+    uint8_t tail = (uint8_t)((p->inflight_head + p->inflight_count) % DMX_MAX_INFLIGHT);
+    p->inflight[tail].start_us = start_us;
+    p->inflight[tail].deadline_us = deadline_us;
+    p->inflight[tail].rx_us = p->rx_pending_us;
+    p->rx_pending_us = 0;
+    p->inflight_count++;
+    portEXIT_CRITICAL(&s_inflight_lock);
+}
+
+/**
+ * @brief Undo dmx_inflight_push() after the backend rejected the frame
+ *
+ * @param expected inflight_count right after the push
+ * @param wait     mark the port as waiting for a completion
+ * @return true if a completion raced with the rejection (a slot is free now
+ *         and no wake-up will follow), false otherwise
+ */
+static bool dmx_inflight_cancel(dmx_port_ctx_t *p, uint8_t expected, bool wait)
+{
+    portENTER_CRITICAL(&s_inflight_lock);
+    bool raced = p->inflight_count < expected;
+    uint8_t tail = (uint8_t)((p->inflight_head + p->inflight_count - 1) % DMX_MAX_INFLIGHT);
+    if (p->rx_pending_us == 0) p->rx_pending_us = p->inflight[tail].rx_us;
+    p->inflight_count--;
+    if (wait && !raced) p->waiting = true;
+    portEXIT_CRITICAL(&s_inflight_lock);
+    return raced;
+}
+
+/**
+ * @brief Mark the port as waiting if @p limit in-flight slots are still taken
+ *
+ * @return false if a completion freed a slot in the meantime
+ */
+static bool dmx_inflight_wait(dmx_port_ctx_t *p, uint8_t limit)
+{
+    portENTER_CRITICAL(&s_inflight_lock);
+    bool full = p->inflight_count >= limit;
+    if (full) p->waiting = true;
+    portEXIT_CRITICAL(&s_inflight_lock);
+    return full;
+}
 
+static void dmx_inflight_clear(dmx_port_ctx_t *p)
+{
+    portENTER_CRITICAL(&s_inflight_lock);
+    p->inflight_head = 0;
+    p->inflight_count = 0;
+    p->waiting = false;
+    portEXIT_CRITICAL(&s_inflight_lock);
+}
+
+/**
+ * @brief Channels to transmit for a port's configured slot_count
+ *
+ * Auto mode follows the highest channel any source has written (full
+ * frames until the first packet arrives).
+ */
+static uint16_t dmx_resolve_slots(int port, uint16_t slot_count)
+{
+    if (slot_count == DMX_SLOTS_AUTO) {
+        uint16_t extent = sys_get_slot_extent(port);
+        return extent ? extent : DMX_UNIVERSE_SIZE;
+    }
+    if (slot_count == 0 || slot_count > DMX_UNIVERSE_SIZE) return DMX_UNIVERSE_SIZE;
+    return slot_count;
+}
+
+static void dmx_update_fps(dmx_port_ctx_t *p, int64_t now)
+{
+    int64_t elapsed = now - p->fps_window_start_us;
+    if (elapsed < DMX_FPS_WINDOW_US) return;
+
+    uint32_t frames = p->stats.frames_sent - p->fps_window_frames;
+    p->stats.fps = (uint16_t)((frames * 1000000LL + elapsed / 2) / elapsed);
+    p->fps_window_frames = p->stats.frames_sent;
+    p->fps_window_start_us = now;
+}
+
+static void dmx_task_main(void *arg)
+{
     ESP_LOGI(TAG, "DMX task started on core %d", xPortGetCoreID());
 
-    while (s_running) {
-        int64_t now = esp_timer_get_time();
+    int64_t start = esp_timer_get_time();
+    const sys_config_t* cfg = sys_get_config();
+    for (int i = 0; i < DMX_PORT_COUNT; ++i) {
+        // Same start time for every port so equal rates share deadlines
+        dmx_sched_port_init(&s_ports[i].sched, cfg->ports[i].timing.refresh_rate, start);
+        s_ports[i].waiting = false;
+        s_ports[i].output_mode = DMX_OUTPUT_PERIODIC;
+        s_ports[i].slots = 0;   // resolved on the first pass
+    }
 
-        const sys_config_t* cfg = sys_get_config();
+    uint32_t flash_seen = sys_flash_write_count();
 
+    while (s_running) {
+        int64_t now = esp_timer_get_time();
+        bool retry = false;
+
+        // Flash writes stop this task (the other core is held in IRAM while
+        // the cache is off), so a write since the last pass explains a late
+        // start. Frames already handed to the backends keep going: their
+        // ISRs and buffers are in IRAM/DRAM.
+        uint32_t flash_writes = sys_flash_write_count();
+        bool flash_hit = flash_writes != flash_seen || sys_flash_write_active();
+        flash_seen = flash_writes;
+
+        cfg = sys_get_config();
+        xSemaphoreTake(s_backend_mutex, portMAX_DELAY);
+
+        // Every port that is due is started back-to-back; the backends return
+        // immediately and report completion via dmx_core_frame_done(), so RMT
+        // and UART frames are on the wire in parallel.
         for (int i = 0; i < DMX_PORT_COUNT; ++i) {
-            if (!s_ports[i].enabled) continue;
+            if (!s_ports[i].enabled || !s_ports[i].attached) continue;
+
+            // Update timing and mode from global config (hot-swap); only a
+            // newly published config can change them
+            bool timing_changed = false;
+            uint32_t gen = sys_config_generation(cfg);
+            if (gen != s_ports[i].cfg_gen) {
+                s_ports[i].cfg_gen = gen;
+                dmx_timing_t cfg_t = cfg->ports[i].timing;
+                timing_changed = memcmp(&cfg_t, &s_ports[i].timing, sizeof(dmx_timing_t)) != 0;
+                if (timing_changed) {
+                    s_ports[i].timing = cfg_t;
+                    dmx_sched_set_rate(&s_ports[i].sched, cfg_t.refresh_rate);
+                }
+            }
+            // Auto slot count follows the data, not the config
+            uint16_t slots = dmx_resolve_slots(i, cfg->ports[i].slot_count);
+            if (timing_changed || slots != s_ports[i].slots) {
+                s_ports[i].slots = slots;
+                dmx_sched_set_min_period(&s_ports[i].sched,
+                                         dmx_sched_frame_us(s_ports[i].timing.break_us, s_ports[i].timing.mab_us, slots));
+            }
+            if (cfg->ports[i].output_mode != s_ports[i].output_mode) {
+                s_ports[i].output_mode = cfg->ports[i].output_mode;
+                bool latency = s_ports[i].output_mode == DMX_OUTPUT_LATENCY;
+                dmx_sched_set_latency(&s_ports[i].sched,
+                                      (int64_t)CONFIG_MODDMX_LATENCY_MIN_INTERVAL_US,
+                                      latency ? (int64_t)CONFIG_MODDMX_LATENCY_KEEPALIVE_MS * 1000 : 0);
+                s_ports[i].data_ready = latency;
+            }
+            bool latency = s_ports[i].output_mode == DMX_OUTPUT_LATENCY;
+            if (latency && s_ports[i].data_ready) {
+                s_ports[i].data_ready = false;
+                dmx_sched_data_ready(&s_ports[i].sched, now);
+            }
+
+            if (!dmx_sched_due(&s_ports[i].sched, now)) continue;
 
-            // Update timing from global config (hot-swap)
-            dmx_timing_t cfg_t = cfg->ports[i].timing;
-            if (memcmp(&cfg_t, &s_ports[i].timing, sizeof(dmx_timing_t)) != 0) {
-                s_ports[i].timing = cfg_t;
+            // Still waiting for a free backend slot; the completion wakes us
+            if (s_ports[i].waiting) {
+                uint8_t head = s_ports[i].inflight_head;
+                if ((now - s_ports[i].inflight[head].start_us) <= DMX_FRAME_STALL_US) {
+                    continue;
+                }
+                // Completion never arrived; count it as missed and move on
+                ESP_LOGW(TAG, "Port %d frame completion lost", i);
+                s_ports[i].stats.deadline_missed++;
+                s_ports[i].stats.last_deadline_met = false;
+                dmx_inflight_clear(&s_ports[i]);
             }
 
             // Failsafe handling (simple)
@@ -78,7 +369,7 @@ static void IRAM_ATTR dmx_task_main(void *arg)
                         break;
                     case FAILSAFE_HOLD:
                     default:
-                        data_ptr = sys_get_dmx_buffer(i);
+                        data_ptr = sys_dmx_acquire_frame(i, NULL);
                         break;
                 }
             } else {
@@ -86,39 +377,141 @@ static void IRAM_ATTR dmx_task_main(void *arg)
                     ESP_LOGI(TAG, "Port %d back to normal", i);
                     s_ports[i].in_failsafe = false;
                 }
-                data_ptr = sys_get_dmx_buffer(i);
+                // Whole frames only: MOD_PROTO may be merging the next one
+                data_ptr = sys_dmx_acquire_frame(i, NULL);
             }
 
-            // Send frame
-            if (s_ports[i].backend == DMX_BACKEND_RMT) {
-                dmx_rmt_send_frame(i, data_ptr, DMX_UNIVERSE_SIZE);
+            // Record the frame before submitting: the completion can fire
+            // before the backend call returns. It must finish by the
+            // following deadline. Latency mode never queues behind the
+            // frame on the wire: the next one is rendered from the newest
+            // data when that frame completes.
+            uint8_t limit = latency ? 1 : DMX_MAX_INFLIGHT;
+            uint8_t expected = (uint8_t)(s_ports[i].inflight_count + 1);
+            if (expected > limit) {
+                if (!latency) s_ports[i].stats.frames_skipped++;
+                if (!dmx_inflight_wait(&s_ports[i], limit)) retry = true;
+                continue;
+            }
+            int64_t deadline = latency ? now + s_ports[i].sched.keepalive_us
+                                       : s_ports[i].sched.next_deadline_us + s_ports[i].sched.period_us;
+            dmx_inflight_push(&s_ports[i], now, deadline);
+
+            // Send frame (non-blocking). A backend without a free staging
+            // slot returns ESP_ERR_INVALID_STATE: the previous frame has not
+            // finished, so count the skip and retry on its completion.
+            esp_err_t ret = s_ports[i].ops->submit(i, data_ptr, s_ports[i].slots, &s_ports[i].timing);
+            if (ret == ESP_OK) {
+                dmx_sched_mark_started(&s_ports[i].sched, now);
+                if (flash_hit && s_ports[i].sched.jitter_last_us > DMX_FLASH_LATE_US) {
+                    s_ports[i].stats.frames_flash_delayed++;
+                }
             } else {
-                dmx_uart_send_frame(i, data_ptr);
+                bool full = ret == ESP_ERR_INVALID_STATE;
+                if (full) s_ports[i].stats.frames_skipped++;
+                if (dmx_inflight_cancel(&s_ports[i], expected, full)) retry = true;
             }
         }
 
-        vTaskDelayUntil(&last, period);
+        xSemaphoreGive(s_backend_mutex);
+
+        // Sleep until the earliest deadline of a port that is not waiting on
+        // a completion; completions of waiting ports wake us early.
+        int64_t wake = now + (int64_t)DMX_MAX_SLEEP_MS * 1000;
+        for (int i = 0; i < DMX_PORT_COUNT; ++i) {
+            if (!s_ports[i].enabled || !s_ports[i].attached) continue;
+            dmx_update_fps(&s_ports[i], now);
+            if (s_ports[i].waiting) continue;
+            if (s_ports[i].sched.next_deadline_us < wake) wake = s_ports[i].sched.next_deadline_us;
+        }
+
+        int64_t wait_us = wake - esp_timer_get_time();
+        if (wait_us > 0 && !retry) {
+            // Round up: waking a little late is measured as jitter, waking
+            // early would spin
+            TickType_t ticks = (TickType_t)((wait_us + portTICK_PERIOD_MS * 1000 - 1) /
+                                            (portTICK_PERIOD_MS * 1000));
+            ulTaskNotifyTake(pdTRUE, ticks);
+        }
     }
 
     ESP_LOGI(TAG, "DMX task stopping");
     vTaskDelete(NULL);
 }
 
+static void dmx_register_builtin_backends(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    dmx_backend_register(&dmx_virtual_backend);
+#else
+    dmx_backend_register(&dmx_rmt_backend);
+    dmx_backend_register(&dmx_uart_backend);
+#if CONFIG_MODDMX_LCD_ENABLE
+    dmx_backend_register(&dmx_lcd_backend);
+#endif
+#endif
+}
+
+// Bind ops to a port and bring it up if enabled. Caller holds s_backend_mutex
+// (or the task is not running).
+static esp_err_t dmx_port_attach(int port, const dmx_backend_ops_t *ops)
+{
+    dmx_port_ctx_t *p = &s_ports[port];
+    p->ops = ops;
+    p->attached = false;
+    dmx_inflight_clear(p);
+
+    if (!p->enabled) {
+        ESP_LOGI(TAG, "Port %d disabled, backend %s not started", port, ops->name);
+        return ESP_OK;
+    }
+
+    dmx_backend_port_cfg_t cfg = s_default_map[port].cfg;
+    cfg.on_frame_done = dmx_core_frame_done;
+    esp_err_t ret = ops->init(port, &cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Port %d: %s init failed: %d", port, ops->name, ret);
+        return ret;
+    }
+    p->attached = true;
+    p->cfg_gen = 0;     // new backend: apply the config on the next pass
+    ESP_LOGI(TAG, "Port %d: backend %s", port, ops->name);
+    return ESP_OK;
+}
+
+static void dmx_port_detach(int port)
+{
+    dmx_port_ctx_t *p = &s_ports[port];
+    if (p->attached) {
+        p->ops->deinit(port);
+        p->attached = false;
+    }
+    dmx_inflight_clear(p);
+}
+
 esp_err_t dmx_init(void)
 {
     if (s_running || s_task) return ESP_OK;
 
-    // Setup default port mapping: A/B = RMT, C/D = UART
-    s_ports[DMX_PORT_A].backend = DMX_BACKEND_RMT;
-    s_ports[DMX_PORT_B].backend = DMX_BACKEND_RMT;
-    s_ports[DMX_PORT_C].backend = DMX_BACKEND_UART;
-    s_ports[DMX_PORT_D].backend = DMX_BACKEND_UART;
+    if (!s_backend_mutex) {
+        s_backend_mutex = xSemaphoreCreateMutex();
+        if (!s_backend_mutex) return ESP_ERR_NO_MEM;
+    }
+    dmx_register_builtin_backends();
 
     // Enabled flags from sys config
     const sys_config_t* cfg = sys_get_config();
     for (int i = 0; i < DMX_PORT_COUNT; ++i) {
         s_ports[i].enabled = cfg->ports[i].enabled;
         s_ports[i].timing = cfg->ports[i].timing;
+        s_ports[i].inflight_head = 0;
+        s_ports[i].inflight_count = 0;
+        s_ports[i].waiting = false;
+        s_ports[i].rx_pending_us = 0;
+        s_ports[i].data_ready = false;
+        memset(&s_ports[i].stats, 0, sizeof(s_ports[i].stats));
+        s_ports[i].fps_window_frames = 0;
+        s_ports[i].fps_window_start_us = esp_timer_get_time();
         if (cfg->failsafe.has_snapshot) {
             esp_err_t ret = sys_snapshot_restore(i, s_ports[i].snapshot);
             if (ret != ESP_OK) {
@@ -130,36 +523,20 @@ esp_err_t dmx_init(void)
         }
     }
 
-    // Init RMT ports only if enabled and configured for RMT
-    esp_err_t ret;
-    if (s_ports[DMX_PORT_A].enabled && s_ports[DMX_PORT_A].backend == DMX_BACKEND_RMT) {
-        ret = dmx_rmt_init(DMX_PORT_A, GPIO_PORT_A_TX);
-        if (ret != ESP_OK) { ESP_LOGE(TAG, "init port A failed: %d", ret); return ret; }
-    } else {
-        ESP_LOGI(TAG, "Skipping RMT init for Port A (enabled=%d backend=%d)", s_ports[DMX_PORT_A].enabled, s_ports[DMX_PORT_A].backend);
-    }
-
-    if (s_ports[DMX_PORT_B].enabled && s_ports[DMX_PORT_B].backend == DMX_BACKEND_RMT) {
-        ret = dmx_rmt_init(DMX_PORT_B, GPIO_PORT_B_TX);
-        if (ret != ESP_OK) { ESP_LOGE(TAG, "init port B failed: %d", ret); return ret; }
-    } else {
-        ESP_LOGI(TAG, "Skipping RMT init for Port B (enabled=%d backend=%d)", s_ports[DMX_PORT_B].enabled, s_ports[DMX_PORT_B].backend);
-    }
-
-    // Init UART ports only if enabled and configured for UART
-    if (s_ports[DMX_PORT_C].enabled && s_ports[DMX_PORT_C].backend == DMX_BACKEND_UART) {
-        ret = dmx_uart_init_port(DMX_PORT_C, UART_NUM_1, GPIO_PORT_C_TX, GPIO_PORT_C_DE);
-        if (ret != ESP_OK) { ESP_LOGE(TAG, "init port C failed: %d", ret); return ret; }
-    } else {
-        ESP_LOGI(TAG, "Skipping UART init for Port C (enabled=%d backend=%d)", s_ports[DMX_PORT_C].enabled, s_ports[DMX_PORT_C].backend);
+    // Bring up each port on its default backend (A/B = RMT, C/D = UART, then LCD lanes)
+    for (int i = 0; i < DMX_PORT_COUNT; ++i) {
+        const dmx_backend_ops_t *ops = s_ports[i].ops;
+        if (!ops) ops = dmx_backend_find(s_default_map[i].backend);
+        if (!ops) {
+            ESP_LOGE(TAG, "Port %d: backend %s not registered", i, s_default_map[i].backend);
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (s_ports[i].attached) continue;
+        esp_err_t ret = dmx_port_attach(i, ops);
+        if (ret != ESP_OK) return ret;
     }
 
-    if (s_ports[DMX_PORT_D].enabled && s_ports[DMX_PORT_D].backend == DMX_BACKEND_UART) {
-        ret = dmx_uart_init_port(DMX_PORT_D, UART_NUM_2, GPIO_PORT_D_TX, GPIO_PORT_D_DE);
-        if (ret != ESP_OK) { ESP_LOGE(TAG, "init port D failed: %d", ret); return ret; }
-    } else {
-        ESP_LOGI(TAG, "Skipping UART init for Port D (enabled=%d backend=%d)", s_ports[DMX_PORT_D].enabled, s_ports[DMX_PORT_D].backend);
-    }
+    sys_set_dmx_update_hook(dmx_on_data_update);
 
     ESP_LOGI(TAG, "DMX initialized");
     return ESP_OK;
@@ -224,4 +601,81 @@ esp_err_t dmx_driver_init(const sys_config_t* cfg)
     // so cfg parameter is accepted but not used directly.
     (void)cfg;
     return dmx_init();
-}
\ No newline at end of file
+}
+
+esp_err_t dmx_get_port_stats(int port, dmx_port_stats_t *out)
+{
+    if (port < 0 || port >= DMX_PORT_COUNT || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *out = s_ports[port].stats;
+    if (!s_ports[port].enabled) out->fps = 0;
+
+    const dmx_sched_port_t *sched = &s_ports[port].sched;
+    out->refresh_rate = sched->period_us > 0 ? (uint16_t)(1000000LL / sched->period_us) : 0;
+    out->jitter_last_us = sched->jitter_last_us;
+    out->jitter_avg_us = sched->jitter_avg_us;
+    out->jitter_max_us = sched->jitter_max_us;
+    out->output_mode = s_ports[port].output_mode;
+    out->slot_count = s_ports[port].slots;
+
+    const dmx_backend_ops_t *ops = s_ports[port].ops;
+    if (s_ports[port].attached && ops->stats) {
+        dmx_backend_stats_t bs = {0};
+        ops->stats(port, &bs);
+        out->tx_isr_last = bs.isr_last;
+        out->tx_isr_max = bs.isr_max;
+        out->tx_dma = bs.dma;
+    }
+    return ESP_OK;
+}
+
+esp_err_t dmx_reset_port_stats(int port)
+{
+    if (port < 0 || port >= DMX_PORT_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    dmx_port_ctx_t *p = &s_ports[port];
+    uint16_t fps = p->stats.fps;
+    memset(&p->stats, 0, sizeof(p->stats));
+    p->stats.fps = fps;
+    p->fps_window_frames = 0;
+    dmx_sched_reset_stats(&p->sched);
+    if (p->attached && p->ops->reset_stats) p->ops->reset_stats(port);
+    return ESP_OK;
+}
+
+esp_err_t dmx_set_port_backend(int port, const char *name)
+{
+    if (port < 0 || port >= DMX_PORT_COUNT || !name) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_backend_mutex) return ESP_ERR_INVALID_STATE;  // dmx_init not called
+
+    const dmx_backend_ops_t *ops = dmx_backend_find(name);
+    if (!ops) return ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(s_backend_mutex, portMAX_DELAY);
+    dmx_port_ctx_t *p = &s_ports[port];
+    const dmx_backend_ops_t *old = p->ops;
+    esp_err_t ret = ESP_OK;
+    if (old != ops || !p->attached) {
+        dmx_port_detach(port);
+        ret = dmx_port_attach(port, ops);
+        if (ret != ESP_OK && old && old != ops) {
+            // Keep the port alive on its previous backend
+            ESP_LOGW(TAG, "Port %d: reverting to %s", port, old->name);
+            dmx_port_attach(port, old);
+        }
+    }
+    xSemaphoreGive(s_backend_mutex);
+    return ret;
+}
+
+const char *dmx_get_port_backend(int port)
+{
+    if (port < 0 || port >= DMX_PORT_COUNT || !s_ports[port].ops) return NULL;
+    return s_ports[port].ops->name;
+}
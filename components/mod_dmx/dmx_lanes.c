@@ -0,0 +1,103 @@
+/**
+ * @file dmx_lanes.c
+ * @brief Bit-sliced multi-lane DMX frame renderer
+ */
+
+#include "dmx_lanes.h"
+#include <string.h>
+
+static uint32_t preamble_bits(const dmx_lane_t *lanes, int nlanes)
+{
+    uint32_t max = 0;
+    for (int l = 0; l < nlanes; ++l) {
+        if (!lanes[l].data) continue;
+        uint32_t n = (uint32_t)lanes[l].break_bits + lanes[l].mab_bits;
+        if (n > max) max = n;
+    }
+    return max;
+}
+
+size_t dmx_lanes_frame_samples(const dmx_lane_t *lanes, int nlanes)
+{
+    return preamble_bits(lanes, nlanes) + (size_t)DMX_LANES_SLOTS * DMX_LANES_SLOT_BITS;
+}
+
+static inline void put(void *out, int width, size_t i, uint32_t v)
+{
+    if (width == 8) ((uint8_t *)out)[i] = (uint8_t)v;
+    else ((uint16_t *)out)[i] = (uint16_t)v;
+}
+
+/* Gather byte `slot` of lanes [base, base+8) into one 64-bit row matrix;
+ * idle lanes read as 0xFF so they transpose to mark */
+static inline uint64_t gather8(const dmx_lane_t *lanes, int nlanes, int base,
+                               size_t slot, uint8_t start_code)
+{
+    uint64_t x = 0;
+    for (int r = 0; r < 8; ++r) {
+        int l = base + r;
+        uint8_t v = 0xFF;
+        if (l < nlanes && lanes[l].data) {
+            v = slot == 0 ? start_code : lanes[l].data[slot - 1];
+        }
+        x |= (uint64_t)v << (8 * r);
+    }
+    return x;
+}
+
+size_t dmx_lanes_render(const dmx_lane_t *lanes, int nlanes, int width, uint8_t start_code,
+                        void *out, size_t out_size)
+{
+    if (!lanes || !out || nlanes < 1) return 0;
+    if (width != 8 && width != 16) return 0;
+    if (nlanes > width) return 0;
+
+    size_t samples = dmx_lanes_frame_samples(lanes, nlanes);
+    size_t bytes = samples * (size_t)(width / 8);
+    if (out_size < bytes) return 0;
+
+    uint32_t all = (width == 8) ? 0xFFu : 0xFFFFu;
+    uint32_t active = 0;
+    for (int l = 0; l < nlanes; ++l) {
+        if (lanes[l].data) active |= 1u << l;
+    }
+
+    // Break/MAB: lane L is low for its break, ending mab_bits before the
+    // common data start T; everything else is mark
+    uint32_t T = preamble_bits(lanes, nlanes);
+    size_t n = 0;
+    for (uint32_t t = 0; t < T; ++t) {
+        uint32_t v = all;
+        for (int l = 0; l < nlanes; ++l) {
+            if (!(active & (1u << l))) continue;
+            uint32_t brk_end = T - lanes[l].mab_bits;
+            uint32_t brk_start = brk_end - lanes[l].break_bits;
+            if (t >= brk_start && t < brk_end) v &= ~(1u << l);
+        }
+        put(out, width, n++, v);
+    }
+
+    // Slots: start bit (active lanes low), 8 transposed data bits, 2 stops
+    uint32_t start_bit = all & ~active;
+    for (size_t s = 0; s < DMX_LANES_SLOTS; ++s) {
+        uint64_t lo = dmx_lanes_transpose8(gather8(lanes, nlanes, 0, s, start_code));
+        if (width == 8) {
+            uint8_t *o = (uint8_t *)out + n;
+            o[0] = (uint8_t)start_bit;
+            memcpy(&o[1], &lo, 8);          // byte b = bit b of every lane (LE)
+            o[9] = 0xFF;
+            o[10] = 0xFF;
+        } else {
+            uint64_t hi = dmx_lanes_transpose8(gather8(lanes, nlanes, 8, s, start_code));
+            uint16_t *o = (uint16_t *)out + n;
+            o[0] = (uint16_t)start_bit;
+            for (int b = 0; b < 8; ++b) {
+                o[1 + b] = (uint16_t)(((lo >> (8 * b)) & 0xFF) | (((hi >> (8 * b)) & 0xFF) << 8));
+            }
+            o[9] = 0xFFFF;
+            o[10] = 0xFFFF;
+        }
+        n += DMX_LANES_SLOT_BITS;
+    }
+    return bytes;
+}
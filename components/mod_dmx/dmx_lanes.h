@@ -0,0 +1,83 @@
+/**
+ * @file dmx_lanes.h
+ * @brief Bit-sliced multi-lane DMX frame renderer (MOD_DMX internal)
+ *
+ * Turns up to 16 universe buffers into one parallel sample stream: one
+ * sample per 4 us DMX bit, bit L of each sample is the line level of lane L.
+ * A parallel peripheral (LCD_CAM i80) clocks the stream out at 250 kHz so
+ * every lane transmits in lockstep.
+ *
+ * No driver calls: dmx_lcd.c hands the stream to the peripheral, and the
+ * tests check it sample by sample against a reference frame model.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DMX_LANES_MAX        16
+#define DMX_LANES_SLOTS      513     // start code + 512 channels
+#define DMX_LANES_SLOT_BITS  11
+#define DMX_LANES_BIT_US     4
+
+/**
+ * @brief Per-lane input for one frame
+ *
+ * A lane with data == NULL is idle: it stays at mark (high) for the whole
+ * frame, without a break.
+ */
+typedef struct {
+    const uint8_t *data;        // DMX_LANES_SLOTS - 1 channel bytes, or NULL
+    uint16_t break_bits;        // break length in 4 us bits
+    uint16_t mab_bits;          // MAB length in 4 us bits
+} dmx_lane_t;
+
+/**
+ * @brief Samples needed for a frame: longest break+MAB plus the slots
+ */
+size_t dmx_lanes_frame_samples(const dmx_lane_t *lanes, int nlanes);
+
+/**
+ * @brief Render a frame for 1-16 lanes
+ *
+ * Every lane's break and MAB end on the same sample, so the start codes of
+ * all lanes go out together. Slot bits are produced by an 8x8 bit-matrix
+ * transpose of the lanes' bytes.
+ *
+ * @param lanes     nlanes entries
+ * @param nlanes    1..8 for 8-bit samples, 1..16 for 16-bit samples
+ * @param width     Sample width in bits (8 or 16)
+ * @param start_code Slot 0 value for every active lane
+ * @param out       Sample buffer (uint8_t or uint16_t per sample)
+ * @param out_size  Capacity of out in bytes
+ * @return Bytes written, 0 on bad arguments or insufficient space
+ */
+size_t dmx_lanes_render(const dmx_lane_t *lanes, int nlanes, int width, uint8_t start_code,
+                        void *out, size_t out_size);
+
+/**
+ * @brief Transpose an 8x8 bit matrix
+ *
+ * Input byte i is row i; output byte j holds bit j of every row (bit i =
+ * row i). Exposed for tests.
+ */
+static inline uint64_t dmx_lanes_transpose8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+#ifdef __cplusplus
+}
+#endif
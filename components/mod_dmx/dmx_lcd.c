@@ -0,0 +1,301 @@
+/**
+ * @file dmx_lcd.c
+ * @brief Parallel LCD_CAM (i80) backend: up to 16 DMX lanes from one DMA buffer
+ *
+ * Port N drives lane N. Frames submitted for the attached lanes are grouped;
+ * once every attached lane has one pending, the group is rendered by
+ * dmx_lanes_render() into a DMA buffer and clocked out at 250 kHz (one
+ * sample per DMX bit) with a single esp_lcd_panel_io_tx_color() call, so all
+ * lanes transmit in lockstep and the CPU only pays for the transpose.
+ * Each lane keeps its own break/MAB; the breaks are right-aligned so all
+ * start codes leave together.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_MODDMX_LCD_ENABLE
+
+#include "mod_dmx.h"
+#include "dmx_backend.h"
+#include "dmx_lanes.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "DMX_LCD";
+
+#define DMX_LCD_WIDTH        CONFIG_MODDMX_LCD_BUS_WIDTH
+#define DMX_LCD_PCLK_HZ      250000      // one sample per 4 us DMX bit
+#define DMX_LCD_BUFS         2           // transfers in flight
+#define DMX_LCD_BIT_US       DMX_LANES_BIT_US
+/* Worst case: 500us break + 100us MAB, every slot */
+#define DMX_LCD_MAX_SAMPLES  ((500 + 100) / DMX_LCD_BIT_US + DMX_LANES_SLOTS * DMX_LANES_SLOT_BITS)
+#define DMX_LCD_BUF_BYTES    (DMX_LCD_MAX_SAMPLES * (DMX_LCD_WIDTH / 8))
+
+typedef struct {
+    esp_lcd_i80_bus_handle_t bus;
+    esp_lcd_panel_io_handle_t io;
+    dmx_frame_done_cb_t done_cb;
+    uint32_t attached_mask;
+    uint32_t pending_mask;
+    uint8_t lane_data[DMX_LCD_WIDTH][DMX_UNIVERSE_SIZE];
+    dmx_timing_t lane_timing[DMX_LCD_WIDTH];
+    uint8_t *dma_buf[DMX_LCD_BUFS];
+    uint32_t buf_lanes[DMX_LCD_BUFS];   // lanes carried by each transfer
+    uint8_t next;                       // buffer the next group renders into
+    uint8_t in_flight;                  // guarded by s_lock
+    uint16_t isr_count;                 // interrupts since the last retired group
+    uint16_t isr_last;                  // interrupts for the last group, shared by its lanes
+    uint16_t isr_max;
+} dmx_lcd_ctx_t;
+
+static dmx_lcd_ctx_t s_lcd;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint16_t us_to_bits(uint32_t us)
+{
+    return (uint16_t)((us + DMX_LCD_BIT_US - 1) / DMX_LCD_BIT_US);
+}
+
+/* Transfer complete (ISR): report every lane of the oldest transfer */
+static bool IRAM_ATTR dmx_lcd_on_trans_done(esp_lcd_panel_io_handle_t io,
+                                            esp_lcd_panel_io_event_data_t *edata,
+                                            void *user_ctx)
+{
+    (void)io;
+    (void)edata;
+    (void)user_ctx;
+
+    portENTER_CRITICAL_ISR(&s_lock);
+    uint8_t oldest = (uint8_t)((s_lcd.next + DMX_LCD_BUFS - s_lcd.in_flight) % DMX_LCD_BUFS);
+    uint32_t lanes = s_lcd.in_flight ? s_lcd.buf_lanes[oldest] : 0;
+    if (s_lcd.isr_count < 0xFFFF) s_lcd.isr_count++;
+    if (s_lcd.in_flight) {
+        /* A stray interrupt with nothing in flight is charged to the next group */
+        s_lcd.in_flight--;
+        s_lcd.isr_last = s_lcd.isr_count;
+        if (s_lcd.isr_last > s_lcd.isr_max) s_lcd.isr_max = s_lcd.isr_last;
+        s_lcd.isr_count = 0;
+    }
+    portEXIT_CRITICAL_ISR(&s_lock);
+
+    bool woken = false;
+    for (int l = 0; l < DMX_LCD_WIDTH && lanes; ++l) {
+        if (!(lanes & (1u << l))) continue;
+        lanes &= ~(1u << l);
+        if (s_lcd.done_cb && s_lcd.done_cb(l)) woken = true;
+    }
+    return woken;
+}
+
+/* Render and start the pending group if it is complete and a buffer is free.
+ * Task context only. */
+static void dmx_lcd_kick(void)
+{
+    if (!s_lcd.io || s_lcd.pending_mask == 0 || s_lcd.pending_mask != s_lcd.attached_mask) return;
+
+    portENTER_CRITICAL(&s_lock);
+    bool free_buf = s_lcd.in_flight < DMX_LCD_BUFS;
+    portEXIT_CRITICAL(&s_lock);
+    if (!free_buf) return;
+
+    dmx_lane_t lanes[DMX_LCD_WIDTH] = {0};
+    for (int l = 0; l < DMX_LCD_WIDTH; ++l) {
+        if (!(s_lcd.pending_mask & (1u << l))) continue;
+        lanes[l].data = s_lcd.lane_data[l];
+        lanes[l].break_bits = us_to_bits(s_lcd.lane_timing[l].break_us);
+        lanes[l].mab_bits = us_to_bits(s_lcd.lane_timing[l].mab_us);
+    }
+
+    uint8_t b = s_lcd.next;
+    size_t bytes = dmx_lanes_render(lanes, DMX_LCD_WIDTH, DMX_LCD_WIDTH, DMX_START_CODE,
+                                    s_lcd.dma_buf[b], DMX_LCD_BUF_BYTES);
+    if (bytes == 0) return;
+
+    portENTER_CRITICAL(&s_lock);
+    s_lcd.buf_lanes[b] = s_lcd.pending_mask;
+    s_lcd.next = (uint8_t)((b + 1) % DMX_LCD_BUFS);
+    s_lcd.in_flight++;
+    portEXIT_CRITICAL(&s_lock);
+    s_lcd.pending_mask = 0;
+
+    // lcd_cmd -1: no command phase, data only
+    esp_err_t ret = esp_lcd_panel_io_tx_color(s_lcd.io, -1, s_lcd.dma_buf[b], bytes);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "tx_color failed: %d", ret);
+        portENTER_CRITICAL(&s_lock);
+        s_lcd.in_flight--;
+        s_lcd.next = b;
+        portEXIT_CRITICAL(&s_lock);
+        s_lcd.pending_mask = s_lcd.buf_lanes[b];
+    }
+}
+
+static int parse_gpios(const char *list, int *out, int max)
+{
+    int n = 0;
+    const char *p = list;
+    while (*p && n < max) {
+        char *end = NULL;
+        long v = strtol(p, &end, 10);
+        if (end == p) break;
+        out[n++] = (int)v;
+        p = end;
+        while (*p == ',' || *p == ' ') p++;
+    }
+    return n;
+}
+
+static esp_err_t dmx_lcd_bus_init(void)
+{
+    esp_lcd_i80_bus_config_t bus_config = {
+        .clk_src = LCD_CLK_SRC_DEFAULT,
+        .dc_gpio_num = CONFIG_MODDMX_LCD_DC_GPIO,
+        .wr_gpio_num = CONFIG_MODDMX_LCD_WR_GPIO,
+        .bus_width = DMX_LCD_WIDTH,
+        .max_transfer_bytes = DMX_LCD_BUF_BYTES,
+        .sram_trans_align = 4,
+    };
+    if (parse_gpios(CONFIG_MODDMX_LCD_DATA_GPIOS, bus_config.data_gpio_nums, DMX_LCD_WIDTH) != DMX_LCD_WIDTH) {
+        ESP_LOGE(TAG, "CONFIG_MODDMX_LCD_DATA_GPIOS needs %d pins", DMX_LCD_WIDTH);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = esp_lcd_new_i80_bus(&bus_config, &s_lcd.bus);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create i80 bus: %d", ret);
+        return ret;
+    }
+
+    esp_lcd_panel_io_i80_config_t io_config = {
+        .cs_gpio_num = -1,
+        .pclk_hz = DMX_LCD_PCLK_HZ,
+        .trans_queue_depth = DMX_LCD_BUFS,
+        .on_color_trans_done = dmx_lcd_on_trans_done,
+        .user_ctx = NULL,
+        .lcd_cmd_bits = 8,
+        .lcd_param_bits = 8,
+        .dc_levels = { .dc_data_level = 1 },
+    };
+    ret = esp_lcd_new_panel_io_i80(s_lcd.bus, &io_config, &s_lcd.io);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create i80 panel IO: %d", ret);
+        esp_lcd_del_i80_bus(s_lcd.bus);
+        s_lcd.bus = NULL;
+        return ret;
+    }
+
+    for (int b = 0; b < DMX_LCD_BUFS; ++b) {
+        s_lcd.dma_buf[b] = heap_caps_malloc(DMX_LCD_BUF_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!s_lcd.dma_buf[b]) {
+            ESP_LOGE(TAG, "Failed to allocate DMA buffer");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "LCD_CAM bus up: %d lanes, %d bytes/frame max", DMX_LCD_WIDTH, DMX_LCD_BUF_BYTES);
+    return ESP_OK;
+}
+
+static void dmx_lcd_bus_deinit(void)
+{
+    if (s_lcd.io) esp_lcd_panel_io_del(s_lcd.io);
+    if (s_lcd.bus) esp_lcd_del_i80_bus(s_lcd.bus);
+    for (int b = 0; b < DMX_LCD_BUFS; ++b) {
+        free(s_lcd.dma_buf[b]);
+        s_lcd.dma_buf[b] = NULL;
+    }
+    s_lcd.io = NULL;
+    s_lcd.bus = NULL;
+    s_lcd.in_flight = 0;
+    s_lcd.isr_count = 0;
+    s_lcd.next = 0;
+}
+
+static esp_err_t dmx_lcd_init(int port, const dmx_backend_port_cfg_t *cfg)
+{
+    if (port < 0 || port >= DMX_LCD_WIDTH) return ESP_ERR_NOT_SUPPORTED;
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    if (s_lcd.attached_mask & (1u << port)) return ESP_ERR_INVALID_STATE;
+
+    if (!s_lcd.io) {
+        esp_err_t ret = dmx_lcd_bus_init();
+        if (ret != ESP_OK) {
+            dmx_lcd_bus_deinit();
+            return ret;
+        }
+    }
+    s_lcd.done_cb = cfg->on_frame_done;
+    s_lcd.attached_mask |= 1u << port;
+    return ESP_OK;
+}
+
+static esp_err_t dmx_lcd_deinit(int port)
+{
+    if (port < 0 || port >= DMX_LCD_WIDTH) return ESP_ERR_INVALID_ARG;
+    s_lcd.attached_mask &= ~(1u << port);
+    s_lcd.pending_mask &= ~(1u << port);
+    if (s_lcd.attached_mask == 0) {
+        dmx_lcd_bus_deinit();
+    } else {
+        dmx_lcd_kick();   // the remaining lanes may now form a full group
+    }
+    return ESP_OK;
+}
+
+static esp_err_t dmx_lcd_submit(int port, const uint8_t *data, uint16_t len, const dmx_timing_t *timing)
+{
+    if (port < 0 || port >= DMX_LCD_WIDTH || !data || !timing) return ESP_ERR_INVALID_ARG;
+    uint32_t bit = 1u << port;
+    if (!(s_lcd.attached_mask & bit)) return ESP_ERR_INVALID_STATE;
+
+    if (s_lcd.pending_mask & bit) {
+        // Previous frame of this lane still waiting for a free buffer
+        dmx_lcd_kick();
+        if (s_lcd.pending_mask & bit) return ESP_ERR_INVALID_STATE;
+    }
+
+    if (len > DMX_UNIVERSE_SIZE) len = DMX_UNIVERSE_SIZE;
+    memcpy(s_lcd.lane_data[port], data, len);
+    if (len < DMX_UNIVERSE_SIZE) memset(&s_lcd.lane_data[port][len], 0, DMX_UNIVERSE_SIZE - len);
+    s_lcd.lane_timing[port] = *timing;
+    s_lcd.pending_mask |= bit;
+
+    dmx_lcd_kick();
+    return ESP_OK;
+}
+
+/* All lanes of a group share one transfer, so every port reports the same counts */
+static void dmx_lcd_get_stats(int port, dmx_backend_stats_t *out)
+{
+    (void)port;
+    if (!out) return;
+    portENTER_CRITICAL(&s_lock);
+    out->isr_last = s_lcd.isr_last;
+    out->isr_max = s_lcd.isr_max;
+    portEXIT_CRITICAL(&s_lock);
+    out->dma = true;
+}
+
+static void dmx_lcd_reset_stats(int port)
+{
+    (void)port;
+    portENTER_CRITICAL(&s_lock);
+    s_lcd.isr_max = 0;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+const dmx_backend_ops_t dmx_lcd_backend = {
+    .name = "lcd",
+    .init = dmx_lcd_init,
+    .submit = dmx_lcd_submit,
+    .deinit = dmx_lcd_deinit,
+    .stats = dmx_lcd_get_stats,
+    .reset_stats = dmx_lcd_reset_stats,
+};
+
+#endif /* CONFIG_MODDMX_LCD_ENABLE */
@@ -8,230 +8,260 @@
 
 #include "sys_mod.h"
 #include "mod_dmx.h"
+#include "dmx_rmt_symbols.h"
+#include "dmx_backend.h"
 #include "driver/rmt_tx.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "esp_attr.h"
+#include "sdkconfig.h"
 #include <string.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #define TAG "DMX_RMT"
 
 /* DMX Timing Constants (us) */
-#define DMX_RMT_CLK_DIV      80    /* 80MHz / 80 = 1MHz (1us tick) */
-#define DMX_BREAK_US         176   /* Break duration */
-#define DMX_MAB_US           12    /* Mark After Break */
+#define DMX_RMT_RESOLUTION_HZ 1000000 /* 1MHz -> 1us ticks */
 #define DMX_BIT_US           4     /* 1 bit at 250kbps */
 
+#ifndef CONFIG_MODDMX_RMT_MEM_BLOCK_SYMBOLS
+#define CONFIG_MODDMX_RMT_MEM_BLOCK_SYMBOLS 96
+#endif
+
+_Static_assert(sizeof(dmx_symbol_t) == sizeof(rmt_symbol_word_t),
+               "dmx_symbol_t must match rmt_symbol_word_t");
 
 /* Module state (RMT TX API) */
 static rmt_channel_handle_t s_rmt_chan[2] = {NULL, NULL};
-static rmt_encoder_handle_t s_dmx_bytes_encoder[2] = {NULL, NULL};
 static rmt_encoder_handle_t s_dmx_copy_encoder[2] = {NULL, NULL};
 static rmt_encoder_handle_t s_dmx_encoder[2] = {NULL, NULL};
 static int s_gpio_pins[2] = {-1, -1};
+static bool s_dma[2] = {false, false};
+static dmx_frame_done_cb_t s_done_cb[2] = {NULL, NULL};
+
+/*
+ * Interrupt accounting. Every encode() call after the first of a frame runs
+ * from the RMT (or DMA EOF) ISR to refill channel memory, so encode calls
+ * plus the trans-done interrupt give the ISR load per frame.
+ */
+typedef struct {
+    volatile uint32_t encode_calls; /* since the last trans-done */
+    volatile uint16_t isr_last;
+    volatile uint16_t isr_max;
+} dmx_rmt_isr_stats_t;
+
+static dmx_rmt_isr_stats_t s_isr[2];
+
+/* Slot value -> symbols, shared by both ports (timing-independent) */
+static dmx_slot_symbols_t s_slot_table[256];
+static bool s_slot_table_ready = false;
+
+/*
+ * Per-port frame staging. Frames are rendered into symbol buffers that the
+ * copy encoder streams as-is. rmt_transmit() only queues the buffer pointer,
+ * so a buffer belongs to the driver until its on_trans_done fires. Two
+ * buffers per port let the next frame queue behind the one on the wire; the
+ * RMT completes transactions in order, so buffers are released FIFO.
+ */
+#define DMX_RMT_STAGE_COUNT  2
+
+typedef struct {
+    dmx_symbol_t *buf[DMX_RMT_STAGE_COUNT];
+    uint8_t next;               /* buffer the next frame is rendered into */
+    volatile uint8_t in_flight; /* buffers owned by the RMT driver */
+    dmx_timing_t timing;        /* timing the break symbol was built from */
+    dmx_symbol_t brk;           /* cached break/MAB symbol */
+} dmx_rmt_stage_t;
 
-/* Helper to map port to index */
-static int s_port_index(int port_idx)
+static dmx_rmt_stage_t s_stage[2];
+
+/* Helper to map port to index (also used from the trans-done ISR) */
+static int IRAM_ATTR s_port_index(int port_idx)
 {
     if (port_idx == DMX_PORT_A) return 0;
     if (port_idx == DMX_PORT_B) return 1;
     return -1;
 }
 
-/**
- * @brief Convert byte array to DMX RMT items
- */
-/* Composite DMX encoder implementation (use RMT TX encoders) */
+static void s_stage_free(int idx)
+{
+    for (int b = 0; b < DMX_RMT_STAGE_COUNT; ++b) {
+        free(s_stage[idx].buf[b]);
+        s_stage[idx].buf[b] = NULL;
+    }
+}
 
+/* Counting wrapper around the copy encoder */
 typedef struct {
     rmt_encoder_t base;
-    rmt_encoder_handle_t bytes_enc;
     rmt_encoder_handle_t copy_enc;
-    const uint8_t *data;
-    size_t data_len;
-    size_t byte_idx;
-    int substate; /* 0=send break, 1=start, 2=data, 3=stop1, 4=stop2 */
+    dmx_rmt_isr_stats_t *isr;
 } rmt_dmx_encoder_t;
 
-static size_t rmt_encode_dmx(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
-                              const void *primary_data, size_t data_size,
-                              rmt_encode_state_t *ret_state)
+static size_t IRAM_ATTR rmt_encode_dmx(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                                       const void *primary_data, size_t data_size,
+                                       rmt_encode_state_t *ret_state)
 {
     rmt_dmx_encoder_t *enc = __containerof(encoder, rmt_dmx_encoder_t, base);
-    rmt_encoder_handle_t bytes_enc = enc->bytes_enc;
-    rmt_encoder_handle_t copy_enc = enc->copy_enc;
-    rmt_encode_state_t session = RMT_ENCODING_RESET;
-    rmt_encode_state_t out_state = RMT_ENCODING_RESET;
-    size_t total_symbols = 0;
-
-    if (primary_data && data_size > 0 && enc->data == NULL) {
-        enc->data = primary_data;
-        enc->data_len = data_size;
-        enc->byte_idx = 0;
-        enc->substate = 0;
-    }
-
-    /* Local symbol placeholders */
-    rmt_symbol_word_t break_sym = { .level0 = 0, .duration0 = DMX_BREAK_US, .level1 = 1, .duration1 = DMX_MAB_US };
-    rmt_symbol_word_t start_sym = { .level0 = 0, .duration0 = DMX_BIT_US, .level1 = 0, .duration1 = 0 };
-    rmt_symbol_word_t stop_sym  = { .level0 = 1, .duration0 = DMX_BIT_US, .level1 = 1, .duration1 = 0 };
-
-    /* State machine to stream: break -> for each byte: start + data byte + stop1 + stop2 */
-    while (1) {
-        if (enc->substate == 0) {
-            /* send break+MAB as a single symbol */
-            size_t added = copy_enc->encode(copy_enc, channel, &break_sym, sizeof(break_sym), &session);
-            total_symbols += added;
-            if (session & RMT_ENCODING_MEM_FULL) { out_state |= RMT_ENCODING_MEM_FULL; break; }
-            if (session & RMT_ENCODING_COMPLETE) { enc->substate = 1; continue; }
-            break;
-        }
-
-        if (enc->byte_idx >= enc->data_len) {
-            out_state |= RMT_ENCODING_COMPLETE;
-            break; /* done */
-        }
-
-        /* start bit */
-        if (enc->substate == 1) {
-            size_t added = copy_enc->encode(copy_enc, channel, &start_sym, sizeof(start_sym), &session);
-            total_symbols += added;
-            if (session & RMT_ENCODING_MEM_FULL) { out_state |= RMT_ENCODING_MEM_FULL; break; }
-            if (session & RMT_ENCODING_COMPLETE) { enc->substate = 2; continue; }
-            break;
-        }
-
-        /* data byte via bytes encoder */
-        if (enc->substate == 2) {
-            const void *p = &enc->data[enc->byte_idx];
-            size_t added = bytes_enc->encode(bytes_enc, channel, p, 1, &session);
-            total_symbols += added;
-            if (session & RMT_ENCODING_MEM_FULL) { out_state |= RMT_ENCODING_MEM_FULL; break; }
-            if (session & RMT_ENCODING_COMPLETE) { enc->substate = 3; continue; }
-            break;
-        }
-
-        /* stop bits */
-        if (enc->substate == 3) {
-            size_t added = copy_enc->encode(copy_enc, channel, &stop_sym, sizeof(stop_sym), &session);
-            total_symbols += added;
-            if (session & RMT_ENCODING_MEM_FULL) { out_state |= RMT_ENCODING_MEM_FULL; break; }
-            if (session & RMT_ENCODING_COMPLETE) { enc->substate = 4; continue; }
-            break;
-        }
-
-        if (enc->substate == 4) {
-            /* second stop */
-            size_t added = copy_enc->encode(copy_enc, channel, &stop_sym, sizeof(stop_sym), &session);
-            total_symbols += added;
-            if (session & RMT_ENCODING_MEM_FULL) { out_state |= RMT_ENCODING_MEM_FULL; break; }
-            if (session & RMT_ENCODING_COMPLETE) {
-                enc->substate = 1;
-                enc->byte_idx++;
-                continue;
-            }
-            break;
-        }
-
-        break;
-    }
-
-    *ret_state = out_state;
-    return total_symbols;
+    enc->isr->encode_calls++;
+    return enc->copy_enc->encode(enc->copy_enc, channel, primary_data, data_size, ret_state);
 }
 
-static esp_err_t rmt_del_dmx_encoder(rmt_encoder_t *encoder)
+static esp_err_t rmt_dmx_encoder_reset(rmt_encoder_t *encoder)
 {
     rmt_dmx_encoder_t *enc = __containerof(encoder, rmt_dmx_encoder_t, base);
-    if (enc->bytes_enc) rmt_del_encoder(enc->bytes_enc);
-    if (enc->copy_enc) rmt_del_encoder(enc->copy_enc);
-    free(enc);
-    return ESP_OK;
+    return rmt_encoder_reset(enc->copy_enc);
 }
 
-static esp_err_t rmt_dmx_encoder_reset(rmt_encoder_t *encoder)
+static esp_err_t rmt_del_dmx_encoder(rmt_encoder_t *encoder)
 {
     rmt_dmx_encoder_t *enc = __containerof(encoder, rmt_dmx_encoder_t, base);
-    enc->byte_idx = 0;
-    enc->substate = 0;
-    enc->data = NULL;
-    enc->data_len = 0;
+    if (enc->copy_enc) rmt_del_encoder(enc->copy_enc);
+    free(enc);
     return ESP_OK;
 }
 
-static esp_err_t rmt_new_dmx_encoder(rmt_encoder_handle_t bytes_enc, rmt_encoder_handle_t copy_enc, rmt_encoder_handle_t *ret)
+static esp_err_t rmt_new_dmx_encoder(rmt_encoder_handle_t copy_enc, dmx_rmt_isr_stats_t *isr,
+                                     rmt_encoder_handle_t *ret)
 {
-    if (!bytes_enc || !copy_enc || !ret) return ESP_ERR_INVALID_ARG;
+    if (!copy_enc || !isr || !ret) return ESP_ERR_INVALID_ARG;
     rmt_dmx_encoder_t *enc = calloc(1, sizeof(*enc));
     if (!enc) return ESP_ERR_NO_MEM;
     enc->base.encode = rmt_encode_dmx;
     enc->base.del = rmt_del_dmx_encoder;
     enc->base.reset = rmt_dmx_encoder_reset;
-    enc->bytes_enc = bytes_enc;
     enc->copy_enc = copy_enc;
+    enc->isr = isr;
     *ret = &enc->base;
     return ESP_OK;
 }
 
-esp_err_t dmx_rmt_init(int port_idx, int gpio_num)
+/* Frame completion (ISR context): release the oldest staging buffer and
+ * hand off to the core scheduler */
+static bool IRAM_ATTR dmx_rmt_on_trans_done(rmt_channel_handle_t channel,
+                                            const rmt_tx_done_event_data_t *edata,
+                                            void *user_ctx)
 {
+    (void)channel;
+    (void)edata;
+    int port_idx = (int)(intptr_t)user_ctx;
     int idx = s_port_index(port_idx);
-    if (idx < 0) return ESP_ERR_INVALID_ARG;
+    if (idx >= 0) {
+        /* The first encode ran from rmt_transmit() when the channel was idle;
+         * this interrupt is counted instead */
+        dmx_rmt_isr_stats_t *isr = &s_isr[idx];
+        uint32_t n = isr->encode_calls;
+        isr->encode_calls = 0;
+        isr->isr_last = (uint16_t)(n > 0xFFFF ? 0xFFFF : n);
+        if (isr->isr_last > isr->isr_max) isr->isr_max = isr->isr_last;
+        if (s_stage[idx].in_flight > 0) {
+            __atomic_fetch_sub(&s_stage[idx].in_flight, 1, __ATOMIC_RELEASE);
+        }
+    }
+    return (idx >= 0 && s_done_cb[idx]) ? s_done_cb[idx](port_idx) : false;
+}
+
+static esp_err_t dmx_rmt_init(int port_idx, const dmx_backend_port_cfg_t *cfg)
+{
+    int idx = s_port_index(port_idx);
+    if (idx < 0) return ESP_ERR_NOT_SUPPORTED;
+    if (!cfg || cfg->gpio_tx < 0) return ESP_ERR_INVALID_ARG;
+    if (s_rmt_chan[idx]) return ESP_ERR_INVALID_STATE;
 
+    int gpio_num = cfg->gpio_tx;
     s_gpio_pins[idx] = gpio_num;
+    s_done_cb[idx] = cfg->on_frame_done;
+
+    if (!s_slot_table_ready) {
+        dmx_symbols_build_table(s_slot_table,
+                                (uint16_t)(DMX_BIT_US * (DMX_RMT_RESOLUTION_HZ / 1000000)));
+        s_slot_table_ready = true;
+    }
+
+    memset(&s_stage[idx], 0, sizeof(s_stage[idx]));
+    memset(&s_isr[idx], 0, sizeof(s_isr[idx]));
 
     rmt_tx_channel_config_t tx_chan_config = {
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .gpio_num = gpio_num,
-        .mem_block_symbols = 64,
-        .resolution_hz = 1000000, /* 1MHz -> 1us ticks */
+        .mem_block_symbols = CONFIG_MODDMX_RMT_MEM_BLOCK_SYMBOLS,
+        .resolution_hz = DMX_RMT_RESOLUTION_HZ,
         .trans_queue_depth = 4,
     };
 
-    esp_err_t ret = rmt_new_tx_channel(&tx_chan_config, &s_rmt_chan[idx]);
+    esp_err_t ret = ESP_FAIL;
+    s_dma[idx] = false;
+#if CONFIG_MODDMX_RMT_USE_DMA
+    /* Only one TX channel is DMA-capable; the second port falls back below */
+    rmt_tx_channel_config_t dma_config = tx_chan_config;
+    dma_config.mem_block_symbols = CONFIG_MODDMX_RMT_DMA_MEM_SYMBOLS;
+    dma_config.flags.with_dma = 1;
+    ret = rmt_new_tx_channel(&dma_config, &s_rmt_chan[idx]);
+    if (ret == ESP_OK) {
+        s_dma[idx] = true;
+    } else {
+        ESP_LOGW(TAG, "Port %d: no RMT DMA channel (%d), using %d-symbol channel memory",
+                 port_idx, ret, CONFIG_MODDMX_RMT_MEM_BLOCK_SYMBOLS);
+    }
+#endif
+    if (!s_dma[idx]) {
+        ret = rmt_new_tx_channel(&tx_chan_config, &s_rmt_chan[idx]);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create RMT TX channel: %d", ret);
         return ret;
     }
 
-    /* Create bytes encoder for DMX bits (LSB first). Each bit is two halves of 4us */
-    rmt_bytes_encoder_config_t bytes_cfg = {
-        .bit0 = { .level0 = 0, .duration0 = DMX_BIT_US, .level1 = 0, .duration1 = DMX_BIT_US },
-        .bit1 = { .level0 = 0, .duration0 = DMX_BIT_US, .level1 = 1, .duration1 = DMX_BIT_US },
-    };
-    bytes_cfg.flags.msb_first = 0; /* DMX is LSB-first */
+    /* Staging buffers come from DMA-capable internal RAM in DMA mode */
+    uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT | (s_dma[idx] ? MALLOC_CAP_DMA : 0);
+    for (int b = 0; b < DMX_RMT_STAGE_COUNT; ++b) {
+        s_stage[idx].buf[b] = heap_caps_malloc(DMX_SYMBOLS_FRAME_MAX * sizeof(dmx_symbol_t), caps);
+        if (!s_stage[idx].buf[b]) {
+            ESP_LOGE(TAG, "Failed to allocate symbol buffer");
+            s_stage_free(idx);
+            rmt_del_channel(s_rmt_chan[idx]);
+            s_rmt_chan[idx] = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
 
-    ret = rmt_new_bytes_encoder(&bytes_cfg, &s_dmx_bytes_encoder[idx]);
+    /* Frames are pre-rendered, the copy encoder only streams symbols */
+    rmt_copy_encoder_config_t copy_cfg = {0};
+    ret = rmt_new_copy_encoder(&copy_cfg, &s_dmx_copy_encoder[idx]);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create DMX bytes encoder: %d", ret);
+        ESP_LOGE(TAG, "Failed to create copy encoder: %d", ret);
         rmt_del_channel(s_rmt_chan[idx]);
         s_rmt_chan[idx] = NULL;
+        s_stage_free(idx);
         return ret;
     }
 
-    /* Create copy encoder for break/start/stop symbols */
-    rmt_copy_encoder_config_t copy_cfg = {0};
-    ret = rmt_new_copy_encoder(&copy_cfg, &s_dmx_copy_encoder[idx]);
+    /* Counting wrapper; deleting it also deletes the copy encoder */
+    ret = rmt_new_dmx_encoder(s_dmx_copy_encoder[idx], &s_isr[idx], &s_dmx_encoder[idx]);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create copy encoder: %d", ret);
-        rmt_del_encoder(s_dmx_bytes_encoder[idx]);
+        ESP_LOGE(TAG, "Failed to create DMX encoder: %d", ret);
+        rmt_del_encoder(s_dmx_copy_encoder[idx]);
         rmt_del_channel(s_rmt_chan[idx]);
-        s_dmx_bytes_encoder[idx] = NULL;
+        s_dmx_copy_encoder[idx] = NULL;
         s_rmt_chan[idx] = NULL;
+        s_stage_free(idx);
         return ret;
     }
 
-    /* Create composite DMX encoder */
-    ret = rmt_new_dmx_encoder(s_dmx_bytes_encoder[idx], s_dmx_copy_encoder[idx], &s_dmx_encoder[idx]);
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = dmx_rmt_on_trans_done,
+    };
+    ret = rmt_tx_register_event_callbacks(s_rmt_chan[idx], &cbs, (void *)(intptr_t)port_idx);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create DMX composite encoder: %d", ret);
-        rmt_del_encoder(s_dmx_copy_encoder[idx]);
-        rmt_del_encoder(s_dmx_bytes_encoder[idx]);
+        ESP_LOGE(TAG, "Failed to register RMT callbacks: %d", ret);
+        rmt_del_encoder(s_dmx_encoder[idx]);
         rmt_del_channel(s_rmt_chan[idx]);
+        s_dmx_encoder[idx] = NULL;
         s_dmx_copy_encoder[idx] = NULL;
-        s_dmx_bytes_encoder[idx] = NULL;
         s_rmt_chan[idx] = NULL;
+        s_stage_free(idx);
         return ret;
     }
 
@@ -239,66 +269,108 @@ esp_err_t dmx_rmt_init(int port_idx, int gpio_num)
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to enable RMT channel: %d", ret);
         rmt_del_encoder(s_dmx_encoder[idx]);
+        rmt_del_channel(s_rmt_chan[idx]);
         s_dmx_encoder[idx] = NULL;
+        s_dmx_copy_encoder[idx] = NULL;
+        s_rmt_chan[idx] = NULL;
+        s_stage_free(idx);
         return ret;
     }
 
-    ESP_LOGI(TAG, "RMT Port %d (GPIO %d) Init OK", port_idx, gpio_num);
+    ESP_LOGI(TAG, "RMT Port %d (GPIO %d) Init OK (%s)", port_idx, gpio_num, s_dma[idx] ? "DMA" : "no DMA");
     return ESP_OK;
 }
 
-esp_err_t dmx_rmt_deinit(int port_idx)
+static esp_err_t dmx_rmt_deinit(int port_idx)
 {
     int idx = s_port_index(port_idx);
     if (idx < 0) return ESP_ERR_INVALID_ARG;
 
-    if (s_dmx_encoder[idx]) {
-        /* deleting composite encoder will also delete child encoders */
-        rmt_del_encoder(s_dmx_encoder[idx]);
-        s_dmx_encoder[idx] = NULL;
-        s_dmx_copy_encoder[idx] = NULL;
-        s_dmx_bytes_encoder[idx] = NULL;
-    } else {
-        if (s_dmx_copy_encoder[idx]) {
-            rmt_del_encoder(s_dmx_copy_encoder[idx]);
-            s_dmx_copy_encoder[idx] = NULL;
-        }
-        if (s_dmx_bytes_encoder[idx]) {
-            rmt_del_encoder(s_dmx_bytes_encoder[idx]);
-            s_dmx_bytes_encoder[idx] = NULL;
-        }
-    }
-
     if (s_rmt_chan[idx]) {
         rmt_disable(s_rmt_chan[idx]);
         rmt_del_channel(s_rmt_chan[idx]);
         s_rmt_chan[idx] = NULL;
     }
 
+    if (s_dmx_encoder[idx]) {
+        /* deleting the wrapper also deletes the copy encoder */
+        rmt_del_encoder(s_dmx_encoder[idx]);
+        s_dmx_encoder[idx] = NULL;
+        s_dmx_copy_encoder[idx] = NULL;
+    } else if (s_dmx_copy_encoder[idx]) {
+        rmt_del_encoder(s_dmx_copy_encoder[idx]);
+        s_dmx_copy_encoder[idx] = NULL;
+    }
+
+    s_stage_free(idx);
     s_gpio_pins[idx] = -1;
+    s_dma[idx] = false;
+    s_done_cb[idx] = NULL;
     return ESP_OK;
 }
 
-esp_err_t dmx_rmt_send_frame(int port_idx, const uint8_t *data, uint16_t len)
+static void dmx_rmt_get_stats(int port_idx, dmx_backend_stats_t *out)
+{
+    int idx = s_port_index(port_idx);
+    if (idx < 0 || !out) return;
+    out->isr_last = s_isr[idx].isr_last;
+    out->isr_max = s_isr[idx].isr_max;
+    out->dma = s_dma[idx];
+}
+
+static void dmx_rmt_reset_stats(int port_idx)
+{
+    int idx = s_port_index(port_idx);
+    if (idx < 0) return;
+    s_isr[idx].isr_max = 0;
+}
+
+static esp_err_t dmx_rmt_send_frame(int port_idx, const uint8_t *data, uint16_t len, const dmx_timing_t *timing)
 {
     int idx = s_port_index(port_idx);
     if (idx < 0) return ESP_ERR_INVALID_ARG;
-    if (!s_rmt_chan[idx] || !s_dmx_encoder[idx]) return ESP_ERR_INVALID_STATE;
+    if (!s_rmt_chan[idx] || !s_dmx_encoder[idx] || !timing) return ESP_ERR_INVALID_STATE;
+
+    /* Both staging buffers still owned by the driver: previous frame not finished */
+    dmx_rmt_stage_t *st = &s_stage[idx];
+    if (__atomic_load_n(&st->in_flight, __ATOMIC_ACQUIRE) >= DMX_RMT_STAGE_COUNT) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Break/MAB follows the port's configured timing */
+    if (st->brk.val == 0 || st->timing.break_us != timing->break_us ||
+        st->timing.mab_us != timing->mab_us) {
+        st->timing = *timing;
+        st->brk = dmx_symbols_break(timing->break_us, timing->mab_us, DMX_RMT_RESOLUTION_HZ);
+    }
 
-    /* Build buffer with start code (0x00) first */
-    static uint8_t buf[DMX_UNIVERSE_SIZE + 1];
-    buf[0] = 0x00; /* start code */
+    /* Render break, start code (0x00) and slots */
     if (len > DMX_UNIVERSE_SIZE) len = DMX_UNIVERSE_SIZE;
-    memcpy(&buf[1], data, len);
+    dmx_symbol_t *buf = st->buf[st->next];
+    size_t nsym = dmx_symbols_render_frame(s_slot_table, st->brk, 0x00, data, len,
+                                           buf, DMX_SYMBOLS_FRAME_MAX);
+    if (nsym == 0) return ESP_ERR_INVALID_SIZE;
 
     rmt_transmit_config_t tx_cfg = { .loop_count = 0 };
-    /* Reset encoder state for fresh frame */
-    if (s_dmx_encoder[idx] && s_dmx_encoder[idx]->reset) s_dmx_encoder[idx]->reset(s_dmx_encoder[idx]);
 
-    /* Non-blocking transmit; the RMT TX API will schedule streaming of the frame */
-    esp_err_t ret = rmt_transmit(s_rmt_chan[idx], s_dmx_encoder[idx], buf, len + 1, &tx_cfg);
+    /* Non-blocking transmit; the buffer stays owned by the driver until on_trans_done */
+    __atomic_fetch_add(&st->in_flight, 1, __ATOMIC_ACQ_REL);
+    esp_err_t ret = rmt_transmit(s_rmt_chan[idx], s_dmx_encoder[idx], buf,
+                                 nsym * sizeof(dmx_symbol_t), &tx_cfg);
     if (ret != ESP_OK) {
+        __atomic_fetch_sub(&st->in_flight, 1, __ATOMIC_ACQ_REL);
         ESP_LOGW(TAG, "RMT transmit failed: %d", ret);
+        return ret;
     }
-    return ret;
+    st->next = (uint8_t)((st->next + 1) % DMX_RMT_STAGE_COUNT);
+    return ESP_OK;
 }
+
+const dmx_backend_ops_t dmx_rmt_backend = {
+    .name = "rmt",
+    .init = dmx_rmt_init,
+    .submit = dmx_rmt_send_frame,
+    .deinit = dmx_rmt_deinit,
+    .stats = dmx_rmt_get_stats,
+    .reset_stats = dmx_rmt_reset_stats,
+};
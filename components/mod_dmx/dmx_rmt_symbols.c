@@ -0,0 +1,86 @@
+/**
+ * @file dmx_rmt_symbols.c
+ * @brief Table-driven DMX512 -> RMT symbol generator
+ */
+
+#include "dmx_rmt_symbols.h"
+#include <string.h>
+
+static uint16_t clamp_ticks(uint64_t ticks)
+{
+    if (ticks == 0) return 1;
+    if (ticks > DMX_SYMBOLS_DURATION_MAX) return DMX_SYMBOLS_DURATION_MAX;
+    return (uint16_t)ticks;
+}
+
+void dmx_symbols_build_table(dmx_slot_symbols_t *table, uint16_t bit_ticks)
+{
+    for (int v = 0; v < 256; ++v) {
+        // Wire bits, LSB first: start (0), data, two stops (1)
+        uint16_t bits = (uint16_t)((v << 1) | (0x3u << 9));
+        uint16_t runs[DMX_SYMBOLS_SLOT_BITS];
+        int nruns = 0;
+        int level = 0;
+        int len = 0;
+
+        for (int b = 0; b < DMX_SYMBOLS_SLOT_BITS; ++b) {
+            int bit = (bits >> b) & 1;
+            if (bit != level) {
+                runs[nruns++] = (uint16_t)len;
+                level = bit;
+                len = 0;
+            }
+            len++;
+        }
+        runs[nruns++] = (uint16_t)len;
+
+        // Starts low and ends high, so nruns is even
+        dmx_slot_symbols_t *e = &table[v];
+        memset(e, 0, sizeof(*e));
+        e->count = (uint8_t)(nruns / 2);
+        for (int s = 0; s < e->count; ++s) {
+            e->sym[s].level0 = 0;
+            e->sym[s].duration0 = clamp_ticks((uint64_t)runs[2 * s] * bit_ticks);
+            e->sym[s].level1 = 1;
+            e->sym[s].duration1 = clamp_ticks((uint64_t)runs[2 * s + 1] * bit_ticks);
+        }
+    }
+}
+
+dmx_symbol_t dmx_symbols_break(uint32_t break_us, uint32_t mab_us, uint32_t resolution_hz)
+{
+    dmx_symbol_t s = { .val = 0 };
+    s.level0 = 0;
+    s.duration0 = clamp_ticks((uint64_t)break_us * resolution_hz / 1000000U);
+    s.level1 = 1;
+    s.duration1 = clamp_ticks((uint64_t)mab_us * resolution_hz / 1000000U);
+    return s;
+}
+
+size_t dmx_symbols_render_frame(const dmx_slot_symbols_t *table, dmx_symbol_t brk,
+                                uint8_t start_code, const uint8_t *data, size_t len,
+                                dmx_symbol_t *out, size_t max)
+{
+    if (len > DMX_SYMBOLS_MAX_SLOTS - 1) len = DMX_SYMBOLS_MAX_SLOTS - 1;
+    if (max < 1 + (len + 1) * DMX_SYMBOLS_SLOT_MAX) return 0;
+
+    size_t n = 0;
+    out[n++] = brk;
+
+    const dmx_slot_symbols_t *e = &table[start_code];
+    for (int s = 0; s < e->count; ++s) out[n++] = e->sym[s];
+
+    for (size_t i = 0; i < len; ++i) {
+        e = &table[data[i]];
+        // Unrolled copy of the 1..5 symbols; count is known per entry
+        switch (e->count) {
+            case 5: out[n + 4] = e->sym[4]; /* fallthrough */
+            case 4: out[n + 3] = e->sym[3]; /* fallthrough */
+            case 3: out[n + 2] = e->sym[2]; /* fallthrough */
+            case 2: out[n + 1] = e->sym[1]; /* fallthrough */
+            default: out[n] = e->sym[0]; break;
+        }
+        n += e->count;
+    }
+    return n;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file dmx_rmt_symbols.h
+ * @brief Table-driven DMX512 -> RMT symbol generator (MOD_DMX internal)
+ *
+ * Pure logic, no driver calls: frames are rendered into a plain symbol array
+ * that the RMT copy encoder streams as-is, so the generator can be tested
+ * and benchmarked off-target.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DMX_SYMBOLS_SLOT_BITS      11   // start + 8 data + 2 stop
+#define DMX_SYMBOLS_SLOT_MAX       5    // worst case (0x55): 10 level runs
+#define DMX_SYMBOLS_MAX_SLOTS      513  // start code + 512 channels
+#define DMX_SYMBOLS_DURATION_MAX   0x7FFF
+
+/** Worst-case symbols for one frame: break/MAB + every slot at its maximum */
+#define DMX_SYMBOLS_FRAME_MAX      (1 + DMX_SYMBOLS_MAX_SLOTS * DMX_SYMBOLS_SLOT_MAX)
+
+/**
+ * @brief One RMT symbol; bit-compatible with rmt_symbol_word_t
+ */
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} dmx_symbol_t;
+
+/**
+ * @brief Pre-rendered symbols for one slot value
+ *
+ * Every slot starts low (start bit) and ends high (stop bits), so its level
+ * runs always pair up into whole low/high symbols and consecutive slots can
+ * be concatenated without re-packing.
+ */
+typedef struct {
+    uint8_t count;
+    dmx_symbol_t sym[DMX_SYMBOLS_SLOT_MAX];
+} dmx_slot_symbols_t;
+
+/**
+ * @brief Fill the 256-entry slot table
+ *
+ * @param table     256 entries, indexed by slot value
+ * @param bit_ticks Duration of one 4 us bit in RMT ticks
+ */
+void dmx_symbols_build_table(dmx_slot_symbols_t *table, uint16_t bit_ticks);
+
+/**
+ * @brief Build the break/MAB symbol from port timing
+ *
+ * Durations are clamped to 1..DMX_SYMBOLS_DURATION_MAX ticks; a zero
+ * duration would terminate the RMT transaction.
+ */
+dmx_symbol_t dmx_symbols_break(uint32_t break_us, uint32_t mab_us, uint32_t resolution_hz);
+
+/**
+ * @brief Render a full frame (break/MAB, start code, data) into symbols
+ *
+ * @param table      Table from dmx_symbols_build_table()
+ * @param brk        Break/MAB symbol from dmx_symbols_break()
+ * @param start_code Slot 0 value
+ * @param data       Channel data (may be NULL when len is 0)
+ * @param len        Channel count, at most DMX_SYMBOLS_MAX_SLOTS - 1
+ * @param out        Output array
+ * @param max        Capacity of out in symbols
+ * @return Number of symbols written, 0 if out is too small
+ */
+size_t dmx_symbols_render_frame(const dmx_slot_symbols_t *table, dmx_symbol_t brk,
+                                uint8_t start_code, const uint8_t *data, size_t len,
+                                dmx_symbol_t *out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file dmx_sched.c
+ * @brief Deadline-based multi-rate output scheduler
+ */
+
+#include "dmx_sched.h"
+
+int64_t dmx_sched_period_us(uint16_t refresh_hz)
+{
+    if (refresh_hz < DMX_REFRESH_MIN_HZ) refresh_hz = DMX_REFRESH_MIN_HZ;
+    if (refresh_hz > DMX_REFRESH_MAX_HZ) refresh_hz = DMX_REFRESH_MAX_HZ;
+    return 1000000LL / refresh_hz;
+}
+
+int64_t dmx_sched_frame_us(uint16_t break_us, uint16_t mab_us, uint16_t slots)
+{
+    int64_t us = (int64_t)break_us + mab_us + ((int64_t)slots + 1) * DMX_SLOT_WIRE_US;
+    return us < DMX_MIN_BREAK_TO_BREAK_US ? DMX_MIN_BREAK_TO_BREAK_US : us;
+}
+
+// Recompute period_us; deadline keeps the phase of the last frame
+static void apply_period(dmx_sched_port_t *p)
+{
+    int64_t period = p->rate_period_us > p->min_period_us ? p->rate_period_us : p->min_period_us;
+    if (period == p->period_us) return;
+
+    p->period_us = period;
+    if (!dmx_sched_is_latency(p)) p->next_deadline_us = p->last_start_us + period;
+}
+
+void dmx_sched_port_init(dmx_sched_port_t *p, uint16_t refresh_hz, int64_t now_us)
+{
+    p->rate_period_us = dmx_sched_period_us(refresh_hz);
+    p->min_period_us = 0;
+    p->period_us = p->rate_period_us;
+    p->next_deadline_us = now_us;
+    p->last_start_us = now_us - p->period_us;
+    p->min_interval_us = 0;
+    p->keepalive_us = 0;
+    dmx_sched_reset_stats(p);
+}
+
+void dmx_sched_set_rate(dmx_sched_port_t *p, uint16_t refresh_hz)
+{
+    p->rate_period_us = dmx_sched_period_us(refresh_hz);
+    apply_period(p);
+}
+
+void dmx_sched_set_min_period(dmx_sched_port_t *p, int64_t min_period_us)
+{
+    p->min_period_us = min_period_us;
+    apply_period(p);
+}
+
+void dmx_sched_set_latency(dmx_sched_port_t *p, int64_t min_interval_us, int64_t keepalive_us)
+{
+    if (keepalive_us < 0) keepalive_us = 0;
+    if (min_interval_us < 0) min_interval_us = 0;
+    bool was = dmx_sched_is_latency(p);
+    p->min_interval_us = min_interval_us;
+    p->keepalive_us = keepalive_us;
+
+    if (keepalive_us > 0) {
+        int64_t keepalive = p->last_start_us + keepalive_us;
+        if (!was || p->next_deadline_us > keepalive) p->next_deadline_us = keepalive;
+    } else if (was) {
+        p->next_deadline_us = p->last_start_us + p->period_us;
+    }
+}
+
+void dmx_sched_data_ready(dmx_sched_port_t *p, int64_t now_us)
+{
+    if (!dmx_sched_is_latency(p)) return;
+
+    int64_t gap = p->min_interval_us > p->min_period_us ? p->min_interval_us : p->min_period_us;
+    int64_t t = p->last_start_us + gap;
+    if (t < now_us) t = now_us;
+    if (t < p->next_deadline_us) p->next_deadline_us = t;
+}
+
+void dmx_sched_mark_started(dmx_sched_port_t *p, int64_t now_us)
+{
+    int64_t late = now_us - p->next_deadline_us;
+    if (late < 0) late = 0;
+
+    uint32_t jitter = (uint32_t)late;
+    p->jitter_last_us = jitter;
+    if (jitter > p->jitter_max_us) p->jitter_max_us = jitter;
+    p->jitter_avg_us = (uint32_t)((int32_t)p->jitter_avg_us +
+                                  ((int32_t)jitter - (int32_t)p->jitter_avg_us) / 16);
+
+    p->last_start_us = now_us;
+    if (dmx_sched_is_latency(p)) {
+        p->next_deadline_us = now_us + p->keepalive_us;
+        return;
+    }
+    p->next_deadline_us += p->period_us;
+    if (p->next_deadline_us <= now_us) {
+        p->next_deadline_us = now_us + p->period_us;
+        p->resyncs++;
+    }
+}
+
+void dmx_sched_reset_stats(dmx_sched_port_t *p)
+{
+    p->jitter_last_us = 0;
+    p->jitter_avg_us = 0;
+    p->jitter_max_us = 0;
+    p->resyncs = 0;
+}
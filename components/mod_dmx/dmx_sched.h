@@ -0,0 +1,125 @@
+/**
+ * @file dmx_sched.h
+ * @brief Deadline-based multi-rate output scheduler (MOD_DMX internal)
+ *
+ * The scheduler never reads a clock: every function takes the current time
+ * in microseconds. dmx_core.c passes esp_timer_get_time(); the tests step
+ * synthetic time through deadlines, jitter and keepalives.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "dmx_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DMX_MIN_BREAK_TO_BREAK_US  1204   // DMX512 minimum packet spacing
+#define DMX_SLOT_WIRE_US           44     // 11 bits at 250 kbaud
+
+/**
+ * @brief Scheduling state for one output port
+ */
+typedef struct {
+    int64_t period_us;          // Frame period: max(rate_period_us, min_period_us)
+    int64_t rate_period_us;     // Period derived from refresh_rate
+    int64_t min_period_us;      // Wire time of one frame (dmx_sched_frame_us)
+    int64_t next_deadline_us;   // Time the next frame is due to start
+    int64_t last_start_us;      // Actual start time of the last frame
+    uint32_t jitter_last_us;    // Start lateness of the last frame
+    uint32_t jitter_avg_us;     // Running average (1/16 EWMA)
+    uint32_t jitter_max_us;     // Worst start lateness since last reset
+    uint32_t resyncs;           // Times the port fell a full period behind
+    // Latency mode (keepalive_us > 0): frames start on new data, at most
+    // every min_interval_us, and at least every keepalive_us
+    int64_t min_interval_us;
+    int64_t keepalive_us;
+} dmx_sched_port_t;
+
+/**
+ * @brief Convert a refresh rate to a frame period, clamped to
+ *        DMX_REFRESH_MIN_HZ-DMX_REFRESH_MAX_HZ
+ */
+int64_t dmx_sched_period_us(uint16_t refresh_hz);
+
+/**
+ * @brief Break-to-break time of a frame with @p slots channels
+ *
+ * Break + MAB + start code + slots at 44 us each, never less than the
+ * DMX512 minimum of 1204 us.
+ */
+int64_t dmx_sched_frame_us(uint16_t break_us, uint16_t mab_us, uint16_t slots);
+
+/**
+ * @brief Set the shortest period the port's frames allow, keeping the phase
+ *
+ * The refresh rate is honoured as long as it fits; a rate faster than the
+ * frame length allows runs at 1 / @p min_period_us instead.
+ */
+void dmx_sched_set_min_period(dmx_sched_port_t *p, int64_t min_period_us);
+
+/**
+ * @brief Initialize a port so its first frame is due at @p now_us
+ *
+ * Ports initialized with the same @p now_us and rate share deadlines.
+ */
+void dmx_sched_port_init(dmx_sched_port_t *p, uint16_t refresh_hz, int64_t now_us);
+
+/**
+ * @brief Change the refresh rate, keeping the phase of the last frame
+ */
+void dmx_sched_set_rate(dmx_sched_port_t *p, uint16_t refresh_hz);
+
+/**
+ * @brief Switch between periodic and latency mode
+ *
+ * @param min_interval_us Minimum start-to-start spacing in latency mode
+ * @param keepalive_us    Longest gap without a frame in latency mode;
+ *                        0 selects periodic mode
+ */
+void dmx_sched_set_latency(dmx_sched_port_t *p, int64_t min_interval_us, int64_t keepalive_us);
+
+static inline bool dmx_sched_is_latency(const dmx_sched_port_t *p)
+{
+    return p->keepalive_us > 0;
+}
+
+/**
+ * @brief New data is available (latency mode)
+ *
+ * Pulls the deadline forward to @p now_us, or to the end of the minimum
+ * interval (or frame time, if longer) after the last start if that is
+ * later. No effect in periodic mode.
+ */
+void dmx_sched_data_ready(dmx_sched_port_t *p, int64_t now_us);
+
+/**
+ * @brief True if the port's deadline has been reached
+ */
+static inline bool dmx_sched_due(const dmx_sched_port_t *p, int64_t now_us)
+{
+    return now_us >= p->next_deadline_us;
+}
+
+/**
+ * @brief Record that a frame started at @p now_us and advance the deadline
+ *
+ * Deadlines advance by whole periods from the previous deadline (not from
+ * @p now_us) so the average rate is preserved when wake-ups are late. If the
+ * port fell more than one period behind, it resynchronizes to @p now_us.
+ * In latency mode the next deadline is the keepalive after @p now_us.
+ */
+void dmx_sched_mark_started(dmx_sched_port_t *p, int64_t now_us);
+
+/**
+ * @brief Clear jitter statistics
+ */
+void dmx_sched_reset_stats(dmx_sched_port_t *p);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,37 +2,200 @@
 #include "dmx_types.h"
 #include "sys_mod.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_intr_alloc.h"
+#include "esp_err.h"
 #include "driver/uart.h"
 #include "driver/gpio.h"
-#include "esp_rom_sys.h"
-#include "esp_err.h"
+#include "hal/uart_ll.h"
+#include "hal/uhci_ll.h"
+#include "hal/dma_types.h"
+#include "soc/uart_periph.h"
+#include "esp_private/gdma.h"
+#include "esp_private/periph_ctrl.h"
+#include "freertos/FreeRTOS.h"
+#include "dmx_backend.h"
 #include <string.h>
 
-// Use public SYS_MOD accessors instead of direct globals
-// (sys_get_config/sys_get_last_activity/sys_get_dmx_buffer)
-;
-
 static const char *TAG = "DMX_UART";
 
+/* Bit time at 250 kbaud */
+#define DMX_UART_BIT_US         4
+/* tx_brk_num is 8 bits wide, tx_idle_num 10 bits (in bit times) */
+#define DMX_UART_BREAK_BITS_MAX 255
+#define DMX_UART_IDLE_BITS_MAX  1023
+/* FIFO refill threshold for the port without DMA: 96 slots (4 ms) of slack */
+#define DMX_UART_FIFO_EMPTY_THR 32
+
+/*
+ * Break and MAB are counted by the UART itself, in bit times:
+ *   submit (DMX task)      tx_idle_num = MAB, tx_brk_num = break, set
+ *                          txd_brk: the idle transmitter starts the break
+ *   TX_BRK_DONE (ISR)      clear txd_brk and start the slots; the
+ *                          transmitter holds mark for tx_idle_num bits
+ *                          before the start code goes out
+ *   TX_DONE (ISR)          last stop bit sent: report the frame done
+ * Neither edge depends on when a task or timer runs. The ISR only has to
+ * start the slots before the MAB ends; if it is late the MAB stretches,
+ * the break never does.
+ *
+ * The first port to claim it streams its slots through UHCI0 and a GDMA
+ * channel from one descriptor, so the CPU copies nothing per byte. The S3
+ * has a single UHCI, which serves one UART; the other port refills the TX
+ * FIFO from the same ISR (about five refills per full frame), with break
+ * and MAB still generated in hardware.
+ */
 typedef struct {
+    int port_idx;
     uart_port_t uart_num;
+    uart_dev_t *hw;
     int tx_pin;
     int de_pin;
+    intr_handle_t intr;
+    gdma_channel_handle_t dma;      // NULL: FIFO refills from the ISR
+    dmx_frame_done_cb_t done_cb;
+    volatile bool busy;             // Frame between submit and TX_DONE
+    volatile bool sending;          // Break over, slots on their way
+    uint16_t frame_len;
+    uint16_t fifo_pos;              // Next byte for the FIFO (no DMA)
+    uint16_t isr_count;             // Interrupts for the frame in flight
+    volatile uint16_t isr_last;
+    volatile uint16_t isr_max;
+    dma_descriptor_t desc __attribute__((aligned(4)));
+    uint8_t frame[DMX_FRAME_SIZE] __attribute__((aligned(4)));
 } dmx_uart_ctx_t;
 
 static dmx_uart_ctx_t s_uart[2]; // ports C (idx 0) and D (idx 1)
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static int s_uhci_owner = -1;    // s_uart index streaming through UHCI0
+
+static uint32_t us_to_bits(uint32_t us, uint32_t min_bits, uint32_t max_bits)
+{
+    uint32_t bits = (us + DMX_UART_BIT_US - 1) / DMX_UART_BIT_US;
+    if (bits < min_bits) bits = min_bits;
+    if (bits > max_bits) bits = max_bits;
+    return bits;
+}
+
+static void IRAM_ATTR dmx_uart_fifo_fill(dmx_uart_ctx_t *u)
+{
+    uint32_t room = uart_ll_get_txfifo_len(u->hw);
+    uint32_t left = (uint32_t)(u->frame_len - u->fifo_pos);
+    uint32_t n = left < room ? left : room;
+    if (n) {
+        uart_ll_write_txfifo(u->hw, &u->frame[u->fifo_pos], n);
+        u->fifo_pos = (uint16_t)(u->fifo_pos + n);
+    }
+    if (u->fifo_pos >= u->frame_len) uart_ll_disable_intr_mask(u->hw, UART_INTR_TXFIFO_EMPTY);
+}
+
+static void IRAM_ATTR dmx_uart_isr(void *arg)
+{
+    dmx_uart_ctx_t *u = (dmx_uart_ctx_t *)arg;
+    uint32_t st = uart_ll_get_intsts_mask(u->hw);
+    bool sending = u->sending;      // a TX_DONE from the break itself is not the frame's
+    bool woken = false;
+
+    uart_ll_clr_intsts_mask(u->hw, st);
+    if (u->isr_count < 0xFFFF) u->isr_count++;
+
+    if ((st & UART_INTR_TX_BRK_DONE) && u->busy && !sending) {
+        // Break done: the transmitter now counts the MAB (tx_idle_num)
+        uart_ll_tx_break(u->hw, 0);
+        uart_ll_disable_intr_mask(u->hw, UART_INTR_TX_BRK_DONE);
+        u->sending = true;
+        uart_ll_clr_intsts_mask(u->hw, UART_INTR_TX_DONE);
+        if (u->dma) {
+            gdma_start(u->dma, (intptr_t)&u->desc);
+        } else {
+            u->fifo_pos = 0;
+            dmx_uart_fifo_fill(u);
+            if (u->fifo_pos < u->frame_len) {
+                uart_ll_clr_intsts_mask(u->hw, UART_INTR_TXFIFO_EMPTY);
+                uart_ll_ena_intr_mask(u->hw, UART_INTR_TXFIFO_EMPTY);
+            }
+        }
+        uart_ll_ena_intr_mask(u->hw, UART_INTR_TX_DONE);
+    } else if (st & UART_INTR_TXFIFO_EMPTY) {
+        dmx_uart_fifo_fill(u);
+    }
+
+    if ((st & UART_INTR_TX_DONE) && sending) {
+        uart_ll_disable_intr_mask(u->hw, UART_INTR_TX_DONE | UART_INTR_TXFIFO_EMPTY);
+        u->isr_last = u->isr_count;
+        if (u->isr_last > u->isr_max) u->isr_max = u->isr_last;
+        u->sending = false;
+        u->busy = false;
+        if (u->done_cb) woken = u->done_cb(u->port_idx);
+    }
+
+    if (woken) portYIELD_FROM_ISR();
+}
+
+static int s_port_index(int port_idx)
+{
+    if (port_idx == DMX_PORT_C) return 0;
+    if (port_idx == DMX_PORT_D) return 1;
+    return -1;
+}
+
+/* Route the UART's TX FIFO through UHCI0 and a GDMA TX channel */
+static esp_err_t dmx_uart_dma_attach(dmx_uart_ctx_t *u)
+{
+    gdma_channel_alloc_config_t dma_cfg = {
+        .direction = GDMA_CHANNEL_DIRECTION_TX,
+    };
+    esp_err_t ret = gdma_new_ahb_channel(&dma_cfg, &u->dma);
+    if (ret != ESP_OK) return ret;
+    ret = gdma_connect(u->dma, GDMA_MAKE_TRIGGER(GDMA_TRIG_PERIPH_UHCI, 0));
+    if (ret != ESP_OK) {
+        gdma_del_channel(u->dma);
+        u->dma = NULL;
+        return ret;
+    }
+
+    periph_module_enable(PERIPH_UHCI0_MODULE);
+    uhci_dev_t *uhci = UHCI_LL_GET_HW(0);
+    uhci_ll_init(uhci);             // no SLIP separators, header or CRC: bytes pass as-is
+    uhci_ll_attach_uart_port(uhci, u->uart_num);
+    return ESP_OK;
+}
 
-esp_err_t dmx_uart_init_port(int port_idx, uart_port_t uart_num, int tx_pin, int de_pin)
+static void dmx_uart_dma_detach(dmx_uart_ctx_t *u)
 {
-    int idx = -1;
-    if (port_idx == DMX_PORT_C) idx = 0;
-    else if (port_idx == DMX_PORT_D) idx = 1;
-    else return ESP_ERR_INVALID_ARG;
+    if (!u->dma) return;
+    gdma_stop(u->dma);
+    gdma_disconnect(u->dma);
+    gdma_del_channel(u->dma);
+    u->dma = NULL;
+    periph_module_disable(PERIPH_UHCI0_MODULE);
+}
 
-    s_uart[idx].uart_num = uart_num;
-    s_uart[idx].tx_pin = tx_pin;
-    s_uart[idx].de_pin = de_pin;
+static esp_err_t dmx_uart_init(int port_idx, const dmx_backend_port_cfg_t *cfg)
+{
+    int idx = s_port_index(port_idx);
+    if (idx < 0) return ESP_ERR_NOT_SUPPORTED;
+    if (!cfg || cfg->gpio_tx < 0 || cfg->gpio_de < 0 || cfg->hw_unit < 0) return ESP_ERR_INVALID_ARG;
+    if (uart_is_driver_installed((uart_port_t)cfg->hw_unit)) return ESP_ERR_INVALID_STATE;
+
+    dmx_uart_ctx_t *u = &s_uart[idx];
+    if (u->intr) return ESP_ERR_INVALID_STATE;
+    uart_port_t uart_num = (uart_port_t)cfg->hw_unit;
+
+    u->port_idx = port_idx;
+    u->done_cb = cfg->on_frame_done;
+    u->uart_num = uart_num;
+    u->hw = UART_LL_GET_HW(uart_num);
+    u->tx_pin = cfg->gpio_tx;
+    u->de_pin = cfg->gpio_de;
+    u->busy = false;
+    u->sending = false;
+    u->isr_count = 0;
+    u->isr_last = 0;
+    u->isr_max = 0;
 
+    // Line format only: the IDF driver is not installed, this backend owns
+    // the UART interrupt
     uart_config_t uart_cfg = {
         .baud_rate = 250000,
         .data_bits = UART_DATA_8_BITS,
@@ -41,68 +204,144 @@ esp_err_t dmx_uart_init_port(int port_idx, uart_port_t uart_num, int tx_pin, int
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
         .source_clk = UART_SCLK_APB,
     };
+    esp_err_t ret = uart_param_config(uart_num, &uart_cfg);
+    if (ret == ESP_OK) ret = uart_set_pin(uart_num, u->tx_pin, -1, -1, -1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "UART %d setup failed: %d", uart_num, ret);
+        return ret;
+    }
+
+    uart_ll_disable_intr_mask(u->hw, UART_LL_INTR_MASK);
+    uart_ll_clr_intsts_mask(u->hw, UART_LL_INTR_MASK);
+    uart_ll_txfifo_rst(u->hw);
+    uart_ll_set_txfifo_empty_thr(u->hw, DMX_UART_FIFO_EMPTY_THR);
+
+    u->dma = NULL;
+    if (s_uhci_owner < 0) {
+        ret = dmx_uart_dma_attach(u);
+        if (ret == ESP_OK) {
+            s_uhci_owner = idx;
+        } else {
+            ESP_LOGW(TAG, "UART %d: no GDMA channel (%d), refilling the FIFO", uart_num, ret);
+        }
+    }
 
-    ESP_ERROR_CHECK(uart_param_config(uart_num, &uart_cfg));
-    ESP_ERROR_CHECK(uart_set_pin(uart_num, tx_pin, -1, -1, -1));
-    /* RX buffer must be non-zero; DMX only uses TX but some UART drivers require RX buffer > 0 */
-    ESP_ERROR_CHECK(uart_driver_install(uart_num, 2048, 1024, 0, NULL, 0));
+    ret = esp_intr_alloc(uart_periph_signal[uart_num].irq, ESP_INTR_FLAG_IRAM,
+                         dmx_uart_isr, u, &u->intr);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "UART %d interrupt alloc failed: %d", uart_num, ret);
+        if (s_uhci_owner == idx) {
+            dmx_uart_dma_detach(u);
+            s_uhci_owner = -1;
+        }
+        u->intr = NULL;
+        return ret;
+    }
 
     // Configure DE pin for RS485
     gpio_config_t de_cfg = {
-        .pin_bit_mask = (1ULL << de_pin),
+        .pin_bit_mask = (1ULL << u->de_pin),
         .mode = GPIO_MODE_OUTPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
         .intr_type = GPIO_INTR_DISABLE,
     };
     gpio_config(&de_cfg);
-    gpio_set_level(de_pin, 0); // default to receive (DE low)
+    // Output-only port: the driver stays enabled so break and MAB are not
+    // cut short by DE switching
+    gpio_set_level(u->de_pin, 1);
 
-    ESP_LOGI(TAG, "UART port %d init: tx=%d de=%d", port_idx, tx_pin, de_pin);
+    ESP_LOGI(TAG, "UART port %d init: tx=%d de=%d %s", port_idx, u->tx_pin, u->de_pin,
+             u->dma ? "UHCI/GDMA" : "FIFO");
     return ESP_OK;
 }
 
-// IRAM-safe send function
-void IRAM_ATTR dmx_uart_send_frame(int port_idx, const uint8_t* data)
+static esp_err_t dmx_uart_deinit(int port_idx)
 {
-    int idx = -1;
-    if (port_idx == DMX_PORT_C) idx = 0;
-    else if (port_idx == DMX_PORT_D) idx = 1;
-    else return;
+    int idx = s_port_index(port_idx);
+    if (idx < 0) return ESP_ERR_INVALID_ARG;
 
-    uart_port_t uart = s_uart[idx].uart_num;
-    int de_pin = s_uart[idx].de_pin;
+    dmx_uart_ctx_t *u = &s_uart[idx];
+    if (u->intr) {
+        uart_ll_disable_intr_mask(u->hw, UART_LL_INTR_MASK);
+        uart_ll_tx_break(u->hw, 0);
+        esp_intr_free(u->intr);
+        u->intr = NULL;
+    }
+    if (s_uhci_owner == idx) {
+        dmx_uart_dma_detach(u);
+        s_uhci_owner = -1;
+    }
+    gpio_set_level(u->de_pin, 0);
 
-    // Set DE high to enable driver (TX)
-    gpio_set_level(de_pin, 1);
-
-    // Make sure UART TX FIFO is idle
-    uart_wait_tx_done(uart, pdMS_TO_TICKS(10));
+    u->done_cb = NULL;
+    u->busy = false;
+    u->sending = false;
+    return ESP_OK;
+}
 
-    // Generate BREAK: force TX low. Use line inverse to drive TX low for break
-    uart_set_line_inverse(uart, UART_SIGNAL_TXD_INV);
-    // The timing should come from system config (read via accessor)
-    const sys_config_t *cfg = sys_get_config();
-    uint32_t break_us = cfg->ports[port_idx].timing.break_us;
-    uint32_t mab_us = cfg->ports[port_idx].timing.mab_us;
+// Non-blocking: sets up the frame and starts the break; the ISR does the rest
+static esp_err_t dmx_uart_send_frame(int port_idx, const uint8_t* data, uint16_t len,
+                                     const dmx_timing_t* timing)
+{
+    int idx = s_port_index(port_idx);
+    if (idx < 0) return ESP_ERR_INVALID_ARG;
 
-    esp_rom_delay_us(break_us);
+    dmx_uart_ctx_t *u = &s_uart[idx];
+    if (!u->intr || !data || !timing) return ESP_ERR_INVALID_STATE;
+    if (u->busy) return ESP_ERR_INVALID_STATE;
 
-    // Release line (MAB)
-    uart_set_line_inverse(uart, 0);
-    esp_rom_delay_us(mab_us);
+    // Build frame (Start code + len slots; short frames end early)
+    if (len > DMX_UNIVERSE_SIZE) len = DMX_UNIVERSE_SIZE;
+    u->frame[0] = DMX_START_CODE;
+    memcpy(&u->frame[1], data, len);
+    u->frame_len = (uint16_t)(len + 1);
+    if (u->dma) {
+        u->desc.dw0.size = sizeof(u->frame);
+        u->desc.dw0.length = u->frame_len;
+        u->desc.dw0.suc_eof = 1;
+        u->desc.dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+        u->desc.buffer = u->frame;
+        u->desc.next = NULL;
+    }
 
-    // Build frame (Start code + 512)
-    uint8_t frame[DMX_FRAME_SIZE];
-    frame[0] = DMX_START_CODE;
-    memcpy(&frame[1], data, DMX_UNIVERSE_SIZE);
+    // DMX512: break >= 88 us, MAB >= 8 us
+    uint32_t break_bits = us_to_bits(timing->break_us, 88 / DMX_UART_BIT_US, DMX_UART_BREAK_BITS_MAX);
+    uint32_t mab_bits = us_to_bits(timing->mab_us, 8 / DMX_UART_BIT_US, DMX_UART_IDLE_BITS_MAX);
 
-    // Write bytes (quasi-blocking: copies into TX FIFO)
-    uart_write_bytes(uart, (const char*)frame, 513);
+    portENTER_CRITICAL(&s_lock);
+    u->busy = true;
+    u->sending = false;
+    u->isr_count = 0;
+    uart_ll_set_tx_idle_num(u->hw, mab_bits);
+    uart_ll_clr_intsts_mask(u->hw, UART_INTR_TX_BRK_DONE | UART_INTR_TX_DONE | UART_INTR_TXFIFO_EMPTY);
+    uart_ll_ena_intr_mask(u->hw, UART_INTR_TX_BRK_DONE);
+    uart_ll_tx_break(u->hw, break_bits);    // TX is idle: the break starts now
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
 
-    // Wait for TX to finish
-    uart_wait_tx_done(uart, pdMS_TO_TICKS(50));
+static void dmx_uart_get_stats(int port_idx, dmx_backend_stats_t *out)
+{
+    int idx = s_port_index(port_idx);
+    if (idx < 0 || !out) return;
+    out->isr_last = s_uart[idx].isr_last;
+    out->isr_max = s_uart[idx].isr_max;
+    out->dma = s_uart[idx].dma != NULL;
+}
 
-    // Disable transmitter
-    gpio_set_level(de_pin, 0);
+static void dmx_uart_reset_stats(int port_idx)
+{
+    int idx = s_port_index(port_idx);
+    if (idx < 0) return;
+    s_uart[idx].isr_max = 0;
 }
+
+const dmx_backend_ops_t dmx_uart_backend = {
+    .name = "uart",
+    .init = dmx_uart_init,
+    .submit = dmx_uart_send_frame,
+    .deinit = dmx_uart_deinit,
+    .stats = dmx_uart_get_stats,
+    .reset_stats = dmx_uart_reset_stats,
+};
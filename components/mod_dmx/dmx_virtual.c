@@ -0,0 +1,285 @@
+/**
+ * @file dmx_virtual.c
+ * @brief Virtual DMX output backend (Linux host builds)
+ *
+ * Writes every submitted frame as a timestamped record to a file or a UNIX
+ * datagram socket and reports completion once the modelled wire time
+ * (break + MAB + 11 bits per slot at 250 kbaud) has elapsed, so the output
+ * scheduler can be exercised and benchmarked without hardware.
+ *
+ * Target strings (dmx_backend_port_cfg_t.target):
+ *   "unix:/path/to/socket"  connected SOCK_DGRAM, one record per datagram,
+ *                           dropped (and counted) when nobody is reading
+ *   "/path/to/file"         records appended to the file
+ *   NULL                    $DMX_VIRTUAL_OUT, else DMX_VIRTUAL_DEFAULT_PATH
+ */
+
+#include "dmx_backend.h"
+#include "dmx_virtual.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DMX_VIRTUAL_PORTS        SYS_PORTS_LIMIT  // any port count
+#define DMX_VIRTUAL_QUEUE        2      // frames in flight per port
+#define DMX_VIRTUAL_SLOT_US      44     // 11 bits * 4us
+
+typedef struct {
+    bool active;
+    int fd;
+    bool is_socket;
+    dmx_frame_done_cb_t done_cb;
+    uint32_t seq;
+    uint64_t end_us[DMX_VIRTUAL_QUEUE]; // modelled completion times (FIFO)
+    uint8_t head;
+    uint8_t count;
+    dmx_virtual_stats_t stats;
+} dmx_virtual_port_t;
+
+static dmx_virtual_port_t s_vports[DMX_VIRTUAL_PORTS];
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond;
+static pthread_t s_worker;
+static bool s_worker_running = false;
+static int s_active_ports = 0;
+
+uint64_t dmx_virtual_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static struct timespec abs_deadline(uint64_t us)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t)(us / 1000000ULL),
+        .tv_nsec = (long)((us % 1000000ULL) * 1000ULL),
+    };
+    return ts;
+}
+
+/* Completion thread: fires done callbacks at the modelled end of each frame */
+static void *dmx_virtual_worker(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&s_lock);
+    while (s_worker_running) {
+        uint64_t now = dmx_virtual_now_us();
+        uint64_t next = 0;
+        int due = -1;
+
+        for (int p = 0; p < DMX_VIRTUAL_PORTS; ++p) {
+            dmx_virtual_port_t *v = &s_vports[p];
+            if (!v->active || v->count == 0) continue;
+            uint64_t end = v->end_us[v->head];
+            if (end <= now) { due = p; break; }
+            if (next == 0 || end < next) next = end;
+        }
+
+        if (due >= 0) {
+            dmx_virtual_port_t *v = &s_vports[due];
+            v->head = (uint8_t)((v->head + 1) % DMX_VIRTUAL_QUEUE);
+            v->count--;
+            v->stats.frames_done++;
+            dmx_frame_done_cb_t cb = v->done_cb;
+            // Callback may submit the next frame: call it unlocked
+            pthread_mutex_unlock(&s_lock);
+            if (cb) cb(due);
+            pthread_mutex_lock(&s_lock);
+            continue;
+        }
+
+        if (next) {
+            struct timespec ts = abs_deadline(next);
+            pthread_cond_timedwait(&s_cond, &s_lock, &ts);
+        } else {
+            pthread_cond_wait(&s_cond, &s_lock);
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return NULL;
+}
+
+static int open_target(const char *target, bool *is_socket)
+{
+    if (!target) target = getenv("DMX_VIRTUAL_OUT");
+    if (!target || !target[0]) target = DMX_VIRTUAL_DEFAULT_PATH;
+
+    *is_socket = false;
+    if (strncmp(target, "unix:", 5) == 0) {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        if (strlen(target + 5) >= sizeof(addr.sun_path)) return -1;
+        strcpy(addr.sun_path, target + 5);
+        int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (fd < 0) return -1;
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        *is_socket = true;
+        return fd;
+    }
+    return open(target, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+}
+
+static esp_err_t dmx_virtual_init(int port, const dmx_backend_port_cfg_t *cfg)
+{
+    if (port < 0 || port >= DMX_VIRTUAL_PORTS) return ESP_ERR_NOT_SUPPORTED;
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+
+    bool is_socket = false;
+    int fd = open_target(cfg->target, &is_socket);
+    if (fd < 0) return ESP_FAIL;
+
+    pthread_mutex_lock(&s_lock);
+    dmx_virtual_port_t *v = &s_vports[port];
+    if (v->active) {
+        pthread_mutex_unlock(&s_lock);
+        close(fd);
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(v, 0, sizeof(*v));
+    v->fd = fd;
+    v->is_socket = is_socket;
+    v->done_cb = cfg->on_frame_done;
+    v->active = true;
+    s_active_ports++;
+
+    esp_err_t ret = ESP_OK;
+    if (!s_worker_running) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&s_cond, &attr);
+        pthread_condattr_destroy(&attr);
+        s_worker_running = true;
+        if (pthread_create(&s_worker, NULL, dmx_virtual_worker, NULL) != 0) {
+            s_worker_running = false;
+            v->active = false;
+            s_active_ports--;
+            close(fd);
+            ret = ESP_FAIL;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ret;
+}
+
+static esp_err_t dmx_virtual_deinit(int port)
+{
+    if (port < 0 || port >= DMX_VIRTUAL_PORTS) return ESP_ERR_INVALID_ARG;
+
+    bool stop = false;
+    pthread_mutex_lock(&s_lock);
+    dmx_virtual_port_t *v = &s_vports[port];
+    if (!v->active) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    v->active = false;
+    v->count = 0;
+    close(v->fd);
+    v->fd = -1;
+    if (--s_active_ports == 0 && s_worker_running) {
+        s_worker_running = false;
+        stop = true;
+    }
+    pthread_cond_signal(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+
+    if (stop && !pthread_equal(pthread_self(), s_worker)) {
+        pthread_join(s_worker, NULL);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t dmx_virtual_submit(int port, const uint8_t *data, uint16_t len,
+                                    const dmx_timing_t *timing)
+{
+    if (port < 0 || port >= DMX_VIRTUAL_PORTS || !data || !timing) return ESP_ERR_INVALID_ARG;
+    if (len > DMX_UNIVERSE_SIZE) len = DMX_UNIVERSE_SIZE;
+
+    uint64_t now = dmx_virtual_now_us();
+    uint64_t wire_us = (uint64_t)timing->break_us + timing->mab_us +
+                       (uint64_t)(len + 1) * DMX_VIRTUAL_SLOT_US;
+
+    pthread_mutex_lock(&s_lock);
+    dmx_virtual_port_t *v = &s_vports[port];
+    if (!v->active) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (v->count >= DMX_VIRTUAL_QUEUE) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Queued frames start on the wire when the previous one ends
+    uint64_t start = now;
+    if (v->count > 0) {
+        uint64_t prev = v->end_us[(v->head + v->count - 1) % DMX_VIRTUAL_QUEUE];
+        if (prev > start) start = prev;
+    }
+    uint64_t end = start + wire_us;
+    v->end_us[(v->head + v->count) % DMX_VIRTUAL_QUEUE] = end;
+    v->count++;
+
+    dmx_virtual_record_t rec = {
+        .magic = DMX_VIRTUAL_MAGIC,
+        .port = (uint8_t)port,
+        .start_code = 0x00,
+        .len = len,
+        .seq = v->seq++,
+        .submit_us = now,
+        .wire_start_us = start,
+        .wire_end_us = end,
+        .break_us = timing->break_us,
+        .mab_us = timing->mab_us,
+    };
+    struct iovec iov[2] = {
+        { .iov_base = &rec, .iov_len = sizeof(rec) },
+        { .iov_base = (void *)data, .iov_len = len },
+    };
+    ssize_t n;
+    if (v->is_socket) {
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
+        n = sendmsg(v->fd, &msg, MSG_DONTWAIT);
+    } else {
+        n = writev(v->fd, iov, 2);
+    }
+    if (n == (ssize_t)(sizeof(rec) + len)) {
+        v->stats.records_written++;
+    } else {
+        v->stats.records_dropped++;
+    }
+    v->stats.frames_submitted++;
+
+    pthread_cond_signal(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t dmx_virtual_get_stats(int port, dmx_virtual_stats_t *out)
+{
+    if (port < 0 || port >= DMX_VIRTUAL_PORTS || !out) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_lock);
+    *out = s_vports[port].stats;
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+const dmx_backend_ops_t dmx_virtual_backend = {
+    .name = "virtual",
+    .init = dmx_virtual_init,
+    .submit = dmx_virtual_submit,
+    .deinit = dmx_virtual_deinit,
+    .stats = NULL,
+    .reset_stats = NULL,
+};
@@ -0,0 +1,53 @@
+/**
+ * @file dmx_virtual.h
+ * @brief Virtual DMX output backend, record format and host helpers
+ *
+ * Linux host builds only; see dmx_virtual.c.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DMX_VIRTUAL_MAGIC         0x56584D44u   // "DMXV" little-endian
+#define DMX_VIRTUAL_DEFAULT_PATH  "/tmp/dmx_virtual.bin"
+
+/**
+ * @brief Record header, followed by `len` channel bytes
+ *
+ * Times are CLOCK_MONOTONIC microseconds. wire_start/end are modelled: a
+ * frame starts when submitted or when the previous frame of the port ends.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t port;
+    uint8_t start_code;
+    uint16_t len;
+    uint32_t seq;
+    uint64_t submit_us;
+    uint64_t wire_start_us;
+    uint64_t wire_end_us;
+    uint16_t break_us;
+    uint16_t mab_us;
+} dmx_virtual_record_t;
+
+typedef struct {
+    uint32_t frames_submitted;
+    uint32_t frames_done;
+    uint32_t records_written;
+    uint32_t records_dropped;   // socket without reader, short write
+} dmx_virtual_stats_t;
+
+esp_err_t dmx_virtual_get_stats(int port, dmx_virtual_stats_t *out);
+
+/** @brief Clock used for record timestamps (CLOCK_MONOTONIC, us) */
+uint64_t dmx_virtual_now_us(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -36,6 +36,71 @@ void dmx_apply_new_timing(int port, const dmx_timing_t* timing);
  */
 esp_err_t dmx_driver_init(const sys_config_t* cfg);
 
+/**
+ * @brief Per-port transmit statistics
+ *
+ * Updated from backend completion callbacks; a snapshot is returned by
+ * dmx_get_port_stats(). Counters wrap at 2^32.
+ */
+typedef struct {
+    uint32_t frames_sent;       // Frames that completed on the wire
+    uint32_t deadline_met;      // Frames that finished before their deadline
+    uint32_t deadline_missed;   // Frames that finished after their deadline
+    uint32_t frames_skipped;    // Ticks skipped because the previous frame was still on the wire
+    uint32_t frames_flash_delayed; // Frames started late because a flash (NVS) write held the task
+    uint32_t last_frame_us;     // Submit-to-completion time of the last frame
+    uint16_t fps;               // Achieved frame rate over the last second
+    uint16_t refresh_rate;      // Target rate the scheduler is running (Hz)
+    uint32_t jitter_last_us;    // Start lateness of the last frame vs. its deadline
+    uint32_t jitter_avg_us;     // Running average start lateness
+    uint32_t jitter_max_us;     // Worst start lateness since last reset
+    uint16_t tx_isr_last;       // Backend interrupts for the last frame (refills + done)
+    uint16_t tx_isr_max;        // Worst interrupts per frame since last reset
+    uint32_t latency_last_us;   // Packet-to-wire: merge to break start of the frame carrying it
+    uint32_t latency_avg_us;    // Running average (1/16 EWMA)
+    uint32_t latency_max_us;    // Worst packet-to-wire latency since last reset
+    uint16_t slot_count;        // Channels per frame the port is sending
+    uint8_t output_mode;        // dmx_output_mode_t the port is running
+    bool tx_dma;                // Backend streams frames via DMA
+    bool last_deadline_met;     // Whether the most recent frame met its deadline
+} dmx_port_stats_t;
+
+/**
+ * @brief Get transmit statistics for a port
+ *
+ * @param port Port index (0-3)
+ * @param out Destination for the statistics snapshot
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on bad port or NULL out
+ */
+esp_err_t dmx_get_port_stats(int port, dmx_port_stats_t *out);
+
+/**
+ * @brief Clear counters and jitter statistics for a port
+ *
+ * @param port Port index (0-3)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on bad port
+ */
+esp_err_t dmx_reset_port_stats(int port);
+
+/**
+ * @brief Move a port to another registered output backend
+ *
+ * Built-in backends: "rmt" (ports A/B), "uart" (ports C/D) and, on Linux
+ * host builds, "virtual". Frames in flight on the old backend are dropped.
+ * If the new backend fails to start, the port stays on the old one.
+ *
+ * @param port Port index (0-3)
+ * @param name Backend name
+ * @return ESP_OK, ESP_ERR_NOT_FOUND for an unknown backend, ESP_ERR_NOT_SUPPORTED
+ *         if the backend cannot drive this port, or the backend's init error
+ */
+esp_err_t dmx_set_port_backend(int port, const char *name);
+
+/**
+ * @brief Name of the backend bound to a port, NULL before dmx_init()
+ */
+const char *dmx_get_port_backend(int port);
+
 // Pin mapping
 #define GPIO_PORT_A_TX  12
 #define GPIO_PORT_B_TX  13
@@ -49,7 +114,7 @@ esp_err_t dmx_driver_init(const sys_config_t* cfg);
 #define DMX_PORT_B 1
 #define DMX_PORT_C 2
 #define DMX_PORT_D 3
-#define DMX_PORT_COUNT 4
+#define DMX_PORT_COUNT SYS_MAX_PORTS   // A-D, then one per LCD_CAM lane (CONFIG_MODDMX_LCD_PORTS)
 
 // DMX constants
 #define DMX_START_CODE 0x00
@@ -0,0 +1,558 @@
+#include "unity.h"
+#include "test_bench.h"
+#include "dmx_rmt_symbols.h"
+#include "dmx_lanes.h"
+#include "dmx_sched.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+/* Virtual backend and scheduler benchmark need a Linux host */
+#if !defined(ESP_PLATFORM) || CONFIG_IDF_TARGET_LINUX
+#define DMX_TEST_VIRTUAL 1
+#include "dmx_backend.h"
+#include "dmx_virtual.h"
+#include "mod_dmx.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+/* Host-side tests for MOD_DMX pure logic (symbol generator, scheduler,
+ * virtual backend), and dmx_core driving every port on the virtual backend */
+
+#define BIT_TICKS   4        /* 1 MHz resolution, 4 us per bit */
+#define RES_HZ      1000000
+
+static dmx_slot_symbols_t s_table[256];
+static dmx_symbol_t s_out[DMX_SYMBOLS_FRAME_MAX];
+static uint8_t s_levels[2][500 + 100 + DMX_SYMBOLS_MAX_SLOTS * DMX_SYMBOLS_SLOT_BITS * BIT_TICKS];
+
+void setUp(void)
+{
+    dmx_symbols_build_table(s_table, BIT_TICKS);
+}
+
+void tearDown(void) {}
+
+/* Reference DMX512 model: line level for every 1 us tick of a frame */
+static size_t ref_frame_levels(uint32_t break_us, uint32_t mab_us, uint8_t start_code,
+                               const uint8_t *data, size_t len, uint8_t *lv)
+{
+    size_t n = 0;
+    for (uint32_t t = 0; t < break_us; ++t) lv[n++] = 0;
+    for (uint32_t t = 0; t < mab_us; ++t) lv[n++] = 1;
+    for (size_t s = 0; s <= len; ++s) {
+        uint8_t v = (s == 0) ? start_code : data[s - 1];
+        for (int t = 0; t < 4; ++t) lv[n++] = 0;                      /* start */
+        for (int b = 0; b < 8; ++b)
+            for (int t = 0; t < 4; ++t) lv[n++] = (uint8_t)((v >> b) & 1); /* LSB first */
+        for (int t = 0; t < 8; ++t) lv[n++] = 1;                      /* 2 stops */
+    }
+    return n;
+}
+
+/* Expand rendered symbols back into 1 us ticks */
+static size_t symbols_to_levels(const dmx_symbol_t *sym, size_t count, uint8_t *lv)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        TEST_ASSERT_NOT_EQUAL(0, sym[i].duration0);
+        TEST_ASSERT_NOT_EQUAL(0, sym[i].duration1);
+        for (int t = 0; t < sym[i].duration0; ++t) lv[n++] = (uint8_t)sym[i].level0;
+        for (int t = 0; t < sym[i].duration1; ++t) lv[n++] = (uint8_t)sym[i].level1;
+    }
+    return n;
+}
+
+static void check_frame(uint32_t break_us, uint32_t mab_us, const uint8_t *data, size_t len)
+{
+    dmx_symbol_t brk = dmx_symbols_break(break_us, mab_us, RES_HZ);
+    size_t nsym = dmx_symbols_render_frame(s_table, brk, 0x00, data, len, s_out, DMX_SYMBOLS_FRAME_MAX);
+    TEST_ASSERT_GREATER_THAN(0, nsym);
+
+    size_t nref = ref_frame_levels(break_us, mab_us, 0x00, data, len, s_levels[0]);
+    size_t ngot = symbols_to_levels(s_out, nsym, s_levels[1]);
+    TEST_ASSERT_EQUAL_UINT32(nref, ngot);
+    TEST_ASSERT_EQUAL_MEMORY(s_levels[0], s_levels[1], nref);
+}
+
+void test_symbols_every_slot_value(void)
+{
+    uint8_t data[256];
+    for (int i = 0; i < 256; ++i) data[i] = (uint8_t)i;
+    check_frame(176, 12, data, sizeof(data));
+}
+
+void test_symbols_slot_sizes(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(1, s_table[0x00].count);
+    TEST_ASSERT_EQUAL_UINT8(1, s_table[0xFF].count);
+    TEST_ASSERT_EQUAL_UINT8(5, s_table[0x55].count);
+    for (int v = 0; v < 256; ++v) {
+        uint32_t ticks = 0;
+        for (int s = 0; s < s_table[v].count; ++s) {
+            ticks += s_table[v].sym[s].duration0 + s_table[v].sym[s].duration1;
+        }
+        TEST_ASSERT_EQUAL_UINT32(DMX_SYMBOLS_SLOT_BITS * BIT_TICKS, ticks);
+    }
+}
+
+void test_symbols_port_timing(void)
+{
+    uint8_t data[DMX_SYMBOLS_MAX_SLOTS - 1];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = (uint8_t)(i * 37 + 11);
+    check_frame(88, 8, data, sizeof(data));
+    check_frame(500, 100, data, sizeof(data));
+    check_frame(176, 12, data, 24);
+
+    /* Zero durations would end the RMT transaction early */
+    dmx_symbol_t brk = dmx_symbols_break(0, 0, RES_HZ);
+    TEST_ASSERT_EQUAL_UINT16(1, brk.duration0);
+    TEST_ASSERT_EQUAL_UINT16(1, brk.duration1);
+}
+
+void test_symbols_output_too_small(void)
+{
+    uint8_t data[512] = {0};
+    dmx_symbol_t brk = dmx_symbols_break(176, 12, RES_HZ);
+    TEST_ASSERT_EQUAL_UINT32(0, dmx_symbols_render_frame(s_table, brk, 0, data, 512, s_out, 100));
+}
+
+void test_symbols_render_benchmark(void)
+{
+    uint8_t data[DMX_SYMBOLS_MAX_SLOTS - 1];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = (uint8_t)(i ^ (i >> 3));
+    dmx_symbol_t brk = dmx_symbols_break(176, 12, RES_HZ);
+
+    const int iterations = 2000;
+    size_t total = 0;
+    uint64_t t0 = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        data[i % sizeof(data)]++;
+        total += dmx_symbols_render_frame(s_table, brk, 0, data, sizeof(data), s_out, DMX_SYMBOLS_FRAME_MAX);
+    }
+    uint64_t elapsed = bench_now() - t0;
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "render: %llu " BENCH_UNIT "/frame, %u symbols/frame",
+             (unsigned long long)(elapsed / iterations), (unsigned)(total / iterations));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN(0, total);
+}
+
+static uint8_t s_lane_data[DMX_LANES_MAX][DMX_LANES_SLOTS - 1];
+static uint16_t s_lane_out[DMX_LANES_SLOTS * DMX_LANES_SLOT_BITS + 256];
+
+void test_lanes_transpose8(void)
+{
+    uint64_t x = 0x0123456789ABCDEFULL;
+    for (int iter = 0; iter < 1000; ++iter) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t y = dmx_lanes_transpose8(x);
+        for (int r = 0; r < 8; ++r) {
+            for (int c = 0; c < 8; ++c) {
+                TEST_ASSERT_EQUAL((x >> (8 * r + c)) & 1, (y >> (8 * c + r)) & 1);
+            }
+        }
+    }
+}
+
+/* Decode lane `l` of a rendered stream and compare it with the reference
+ * model: mark until the lane's break, then break, MAB and slots */
+static void check_lane(const void *out, int width, size_t samples, const dmx_lane_t *lane, int l,
+                       uint32_t preamble)
+{
+    if (!lane->data) {
+        for (size_t i = 0; i < samples; ++i) {
+            uint32_t v = width == 8 ? ((const uint8_t *)out)[i] : ((const uint16_t *)out)[i];
+            TEST_ASSERT_EQUAL(1, (v >> l) & 1);
+        }
+        return;
+    }
+    size_t lead = preamble - lane->break_bits - lane->mab_bits;
+    size_t nref = ref_frame_levels(lane->break_bits * 4u, lane->mab_bits * 4u, 0x00,
+                                   lane->data, DMX_LANES_SLOTS - 1, s_levels[0]);
+    TEST_ASSERT_EQUAL_UINT32(samples, lead + nref / 4);
+    for (size_t i = 0; i < samples; ++i) {
+        uint32_t v = width == 8 ? ((const uint8_t *)out)[i] : ((const uint16_t *)out)[i];
+        int expect = i < lead ? 1 : s_levels[0][(i - lead) * 4];
+        TEST_ASSERT_EQUAL(expect, (v >> l) & 1);
+    }
+}
+
+static void fill_lanes(dmx_lane_t *lanes, int n)
+{
+    for (int l = 0; l < n; ++l) {
+        for (int i = 0; i < DMX_LANES_SLOTS - 1; ++i) {
+            s_lane_data[l][i] = (uint8_t)(i * (l + 3) + l * 17);
+        }
+        lanes[l].data = s_lane_data[l];
+        lanes[l].break_bits = (uint16_t)(22 + l * 3);   /* 88 us and up */
+        lanes[l].mab_bits = (uint16_t)(2 + (l % 4));    /* 8-20 us */
+    }
+}
+
+void test_lanes_render_16(void)
+{
+    dmx_lane_t lanes[16];
+    fill_lanes(lanes, 16);
+    lanes[5].data = NULL;                               /* idle lane */
+
+    size_t samples = dmx_lanes_frame_samples(lanes, 16);
+    size_t bytes = dmx_lanes_render(lanes, 16, 16, 0x00, s_lane_out, sizeof(s_lane_out));
+    TEST_ASSERT_EQUAL_UINT32(samples * 2, bytes);
+
+    uint32_t preamble = (uint32_t)(samples - DMX_LANES_SLOTS * DMX_LANES_SLOT_BITS);
+    for (int l = 0; l < 16; ++l) check_lane(s_lane_out, 16, samples, &lanes[l], l, preamble);
+}
+
+void test_lanes_render_8(void)
+{
+    dmx_lane_t lanes[4];
+    fill_lanes(lanes, 4);
+
+    size_t samples = dmx_lanes_frame_samples(lanes, 4);
+    size_t bytes = dmx_lanes_render(lanes, 4, 8, 0x00, s_lane_out, sizeof(s_lane_out));
+    TEST_ASSERT_EQUAL_UINT32(samples, bytes);
+
+    uint32_t preamble = (uint32_t)(samples - DMX_LANES_SLOTS * DMX_LANES_SLOT_BITS);
+    for (int l = 0; l < 8; ++l) {
+        dmx_lane_t idle = { 0 };
+        check_lane(s_lane_out, 8, samples, l < 4 ? &lanes[l] : &idle, l, preamble);
+    }
+
+    /* More lanes than sample bits, or no room */
+    TEST_ASSERT_EQUAL_UINT32(0, dmx_lanes_render(lanes, 4, 8, 0, s_lane_out, 100));
+    dmx_lane_t many[9];
+    fill_lanes(many, 9);
+    TEST_ASSERT_EQUAL_UINT32(0, dmx_lanes_render(many, 9, 8, 0, s_lane_out, sizeof(s_lane_out)));
+}
+
+void test_lanes_render_benchmark(void)
+{
+    dmx_lane_t lanes[16];
+    fill_lanes(lanes, 16);
+
+    const int iterations = 500;
+    size_t total = 0;
+    uint64_t t0 = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        s_lane_data[i % 16][i % (DMX_LANES_SLOTS - 1)]++;
+        total += dmx_lanes_render(lanes, 16, 16, 0x00, s_lane_out, sizeof(s_lane_out));
+    }
+    uint64_t elapsed = bench_now() - t0;
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "16-lane render: %llu " BENCH_UNIT "/frame, %u bytes/frame",
+             (unsigned long long)(elapsed / iterations), (unsigned)(total / iterations));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN(0, total);
+}
+
+/* Latency mode: data pulls the deadline in, bounded by min interval and keepalive */
+static void test_sched_latency_mode(void)
+{
+    dmx_sched_port_t p;
+    dmx_sched_port_init(&p, 40, 0);
+    dmx_sched_set_latency(&p, 1204, 100000);
+    TEST_ASSERT_TRUE(dmx_sched_is_latency(&p));
+
+    dmx_sched_mark_started(&p, 0);
+    TEST_ASSERT_EQUAL_INT64(100000, p.next_deadline_us);    // keepalive
+
+    dmx_sched_data_ready(&p, 500);                          // inside min interval
+    TEST_ASSERT_EQUAL_INT64(1204, p.next_deadline_us);
+    dmx_sched_mark_started(&p, 1204);
+
+    dmx_sched_data_ready(&p, 30000);
+    TEST_ASSERT_TRUE(dmx_sched_due(&p, 30000));
+    dmx_sched_mark_started(&p, 30000);
+    TEST_ASSERT_EQUAL_INT64(130000, p.next_deadline_us);
+
+    // Back to periodic: next frame one period after the last start
+    dmx_sched_set_latency(&p, 1204, 0);
+    TEST_ASSERT_FALSE(dmx_sched_is_latency(&p));
+    TEST_ASSERT_EQUAL_INT64(55000, p.next_deadline_us);
+    dmx_sched_data_ready(&p, 31000);
+    TEST_ASSERT_EQUAL_INT64(55000, p.next_deadline_us);
+}
+
+/* Short frames: rate ceiling follows the frame length and 1204 us minimum */
+static void test_sched_slot_count(void)
+{
+    TEST_ASSERT_EQUAL_INT64(176 + 12 + 513 * 44, dmx_sched_frame_us(176, 12, 512));
+    TEST_ASSERT_EQUAL_INT64(176 + 12 + 101 * 44, dmx_sched_frame_us(176, 12, 100));
+    TEST_ASSERT_EQUAL_INT64(DMX_MIN_BREAK_TO_BREAK_US, dmx_sched_frame_us(88, 8, 1));
+
+    dmx_sched_port_t p;
+    dmx_sched_port_init(&p, 500, 0);
+    dmx_sched_set_min_period(&p, dmx_sched_frame_us(176, 12, 512));
+    TEST_ASSERT_EQUAL_INT64(176 + 12 + 513 * 44, p.period_us);      // 512 slots: ~44 Hz
+
+    dmx_sched_set_min_period(&p, dmx_sched_frame_us(176, 12, 24));
+    TEST_ASSERT_EQUAL_INT64(2000, p.period_us);                     // 24 slots: 500 Hz fits
+
+    dmx_sched_set_rate(&p, 2000);                                   // clamped to 830 Hz
+    TEST_ASSERT_EQUAL_INT64(176 + 12 + 25 * 44, p.period_us);       // frame-bound
+    dmx_sched_set_min_period(&p, dmx_sched_frame_us(88, 8, 1));
+    TEST_ASSERT_EQUAL_INT64(DMX_MIN_BREAK_TO_BREAK_US, p.period_us);
+
+    dmx_sched_mark_started(&p, p.next_deadline_us);
+    TEST_ASSERT_EQUAL_INT64(DMX_MIN_BREAK_TO_BREAK_US, p.next_deadline_us - p.last_start_us);
+}
+
+/* Modelled packet-to-wire latency (merge -> break start) for both modes:
+ * 44 Hz input against a 40 Hz port, full 512-slot frames */
+static uint32_t sim_latency_avg(bool latency)
+{
+    const int64_t wire_us = 176 + 12 + 513 * 44;
+    const int64_t step = 50, end = 10000000;
+    dmx_sched_port_t p;
+    dmx_sched_port_init(&p, 40, 0);
+    if (latency) dmx_sched_set_latency(&p, 1204, 100000);
+
+    int64_t busy_until = 0, rx = 0, next_pkt = 7000;
+    uint64_t sum = 0, n = 0;
+    for (int64_t t = 0; t < end; t += step) {
+        if (t >= next_pkt) {
+            if (!rx) rx = t;
+            dmx_sched_data_ready(&p, t);
+            next_pkt += 22727;
+        }
+        if (!dmx_sched_due(&p, t)) continue;
+        if (latency && t < busy_until) continue;   // never queue behind the wire
+        int64_t start = t > busy_until ? t : busy_until;
+        if (rx) {
+            sum += (uint64_t)(start - rx);
+            n++;
+            rx = 0;
+        }
+        busy_until = start + wire_us;
+        dmx_sched_mark_started(&p, t);
+    }
+    return n ? (uint32_t)(sum / n) : 0;
+}
+
+static void test_sched_latency_model(void)
+{
+    uint32_t periodic = sim_latency_avg(false);
+    uint32_t latency = sim_latency_avg(true);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "packet-to-wire avg: periodic %u us, latency %u us",
+             (unsigned)periodic, (unsigned)latency);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN(0, periodic);
+    TEST_ASSERT_LESS_THAN(periodic, latency);
+}
+
+#if DMX_TEST_VIRTUAL
+#define VPORTS 4
+static atomic_uint s_vdone[VPORTS];
+
+static bool vport_done(int port)
+{
+    atomic_fetch_add(&s_vdone[port], 1);
+    return false;
+}
+
+static void test_path(char *out, size_t n)
+{
+    snprintf(out, n, "/tmp/dmx_virtual_test_%d.bin", (int)getpid());
+}
+
+void test_virtual_backend_records(void)
+{
+    char path[64];
+    test_path(path, sizeof(path));
+    unlink(path);
+
+    TEST_ASSERT_EQUAL(ESP_OK, dmx_backend_register(&dmx_virtual_backend));
+    const dmx_backend_ops_t *ops = dmx_backend_find("virtual");
+    TEST_ASSERT_NOT_NULL(ops);
+
+    dmx_backend_port_cfg_t cfg = { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1,
+                                   .target = path, .on_frame_done = vport_done };
+    atomic_store(&s_vdone[0], 0);
+    TEST_ASSERT_EQUAL(ESP_OK, ops->init(0, &cfg));
+
+    uint8_t data[DMX_UNIVERSE_SIZE];
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i) data[i] = (uint8_t)i;
+    dmx_timing_t t = { .break_us = 176, .mab_us = 12, .refresh_rate = 40 };
+
+    /* Two frames queue, the third is rejected until one completes */
+    TEST_ASSERT_EQUAL(ESP_OK, ops->submit(0, data, DMX_UNIVERSE_SIZE, &t));
+    TEST_ASSERT_EQUAL(ESP_OK, ops->submit(0, data, DMX_UNIVERSE_SIZE, &t));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, ops->submit(0, data, DMX_UNIVERSE_SIZE, &t));
+
+    usleep(60000);  /* 2 x 22.76 ms wire time */
+    TEST_ASSERT_EQUAL_UINT32(2, atomic_load(&s_vdone[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, ops->deinit(0));
+
+    FILE *f = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(f);
+    dmx_virtual_record_t rec[2];
+    uint8_t payload[DMX_UNIVERSE_SIZE];
+    for (int r = 0; r < 2; ++r) {
+        TEST_ASSERT_EQUAL(1, fread(&rec[r], sizeof(rec[r]), 1, f));
+        TEST_ASSERT_EQUAL_HEX32(DMX_VIRTUAL_MAGIC, rec[r].magic);
+        TEST_ASSERT_EQUAL_UINT32(r, rec[r].seq);
+        TEST_ASSERT_EQUAL_UINT16(DMX_UNIVERSE_SIZE, rec[r].len);
+        TEST_ASSERT_EQUAL(1, fread(payload, rec[r].len, 1, f));
+        TEST_ASSERT_EQUAL_MEMORY(data, payload, DMX_UNIVERSE_SIZE);
+        TEST_ASSERT_EQUAL_UINT64(176 + 12 + 513 * 44, rec[r].wire_end_us - rec[r].wire_start_us);
+    }
+    /* Second frame starts on the wire when the first ends */
+    TEST_ASSERT_EQUAL_UINT64(rec[0].wire_end_us, rec[1].wire_start_us);
+    fclose(f);
+    unlink(path);
+}
+
+/* Drive four virtual ports at different rates through dmx_sched for one
+ * second, the way dmx_task_main does, and report achieved rate and jitter */
+void test_virtual_scheduler_benchmark(void)
+{
+    static const uint16_t rates[VPORTS] = { 44, 40, 30, 25 };
+    char path[64];
+    test_path(path, sizeof(path));
+    unlink(path);
+
+    dmx_backend_register(&dmx_virtual_backend);
+    const dmx_backend_ops_t *ops = dmx_backend_find("virtual");
+    TEST_ASSERT_NOT_NULL(ops);
+
+    dmx_backend_port_cfg_t cfg = { .gpio_tx = -1, .gpio_de = -1, .hw_unit = -1,
+                                   .target = path, .on_frame_done = vport_done };
+    dmx_sched_port_t sched[VPORTS];
+    uint32_t submitted[VPORTS] = {0};
+    uint8_t data[DMX_UNIVERSE_SIZE] = {0};
+    dmx_timing_t t = { .break_us = 176, .mab_us = 12 };
+
+    int64_t start = (int64_t)dmx_virtual_now_us();
+    for (int p = 0; p < VPORTS; ++p) {
+        atomic_store(&s_vdone[p], 0);
+        TEST_ASSERT_EQUAL(ESP_OK, ops->init(p, &cfg));
+        dmx_sched_port_init(&sched[p], rates[p], start);
+    }
+
+    const int64_t run_us = 1000000;
+    uint64_t loop_ns = 0, loops = 0;
+    for (;;) {
+        int64_t now = (int64_t)dmx_virtual_now_us();
+        if (now - start >= run_us) break;
+
+        uint64_t t0 = bench_now();
+        int64_t wake = now + 50000;
+        for (int p = 0; p < VPORTS; ++p) {
+            if (dmx_sched_due(&sched[p], now)) {
+                data[0] = (uint8_t)submitted[p];
+                if (ops->submit(p, data, DMX_UNIVERSE_SIZE, &t) == ESP_OK) {
+                    dmx_sched_mark_started(&sched[p], now);
+                    submitted[p]++;
+                }
+            }
+            if (sched[p].next_deadline_us < wake) wake = sched[p].next_deadline_us;
+        }
+        loop_ns += bench_now() - t0;
+        loops++;
+
+        int64_t wait = wake - (int64_t)dmx_virtual_now_us();
+        if (wait > 0) usleep((useconds_t)wait);
+    }
+    usleep(60000);  /* let the last frames complete */
+
+    for (int p = 0; p < VPORTS; ++p) {
+        char msg[128];
+        snprintf(msg, sizeof(msg),
+                 "port %d @%u Hz: %u frames, %u done, jitter avg %u us max %u us",
+                 p, rates[p], (unsigned)submitted[p], (unsigned)atomic_load(&s_vdone[p]),
+                 (unsigned)sched[p].jitter_avg_us, (unsigned)sched[p].jitter_max_us);
+        TEST_MESSAGE(msg);
+        /* One second at the target rate, +-2 frames for start/stop edges */
+        TEST_ASSERT_UINT32_WITHIN(2, rates[p], submitted[p]);
+        TEST_ASSERT_EQUAL_UINT32(submitted[p], atomic_load(&s_vdone[p]));
+
+        dmx_virtual_stats_t vs;
+        TEST_ASSERT_EQUAL(ESP_OK, dmx_virtual_get_stats(p, &vs));
+        TEST_ASSERT_EQUAL_UINT32(0, vs.records_dropped);
+        TEST_ASSERT_EQUAL(ESP_OK, ops->deinit(p));
+    }
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "scheduler pass: %llu " BENCH_UNIT " avg over %llu passes",
+             (unsigned long long)(loops ? loop_ns / loops : 0), (unsigned long long)loops);
+    TEST_MESSAGE(msg);
+    unlink(path);
+}
+
+/* Every port, A-D and the lane ports after them, through dmx_core: config
+ * from sys_mod, default backend binding, dmx_task_main scheduling and the
+ * completion path, for one second at a different rate per port */
+void test_core_drives_all_ports(void)
+{
+    TEST_ASSERT_GREATER_THAN(4, DMX_PORT_COUNT);
+    char path[64];
+    test_path(path, sizeof(path));
+    unlink(path);
+    setenv("DMX_VIRTUAL_OUT", path, 1);     /* default map has no target */
+    TEST_ASSERT_EQUAL(ESP_OK, sys_mod_init());
+
+    for (int p = 0; p < DMX_PORT_COUNT; ++p) {
+        dmx_port_cfg_t cfg = sys_get_config()->ports[p];
+        cfg.enabled = true;
+        cfg.universe = (uint16_t)(100 + p);
+        cfg.timing.refresh_rate = (uint16_t)(25 + 2 * p);
+        TEST_ASSERT_EQUAL(ESP_OK, sys_update_port_cfg(p, &cfg));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, dmx_init());
+    TEST_ASSERT_EQUAL(ESP_OK, dmx_start());
+    usleep(1000000);
+    TEST_ASSERT_EQUAL(ESP_OK, dmx_stop());
+    usleep(60000);  /* let the last frames complete */
+
+    for (int p = 0; p < DMX_PORT_COUNT; ++p) {
+        dmx_port_stats_t st;
+        dmx_virtual_stats_t vs;
+        TEST_ASSERT_EQUAL_STRING("virtual", dmx_get_port_backend(p));
+        TEST_ASSERT_EQUAL(ESP_OK, dmx_get_port_stats(p, &st));
+        TEST_ASSERT_EQUAL(ESP_OK, dmx_virtual_get_stats(p, &vs));
+
+        char msg[96];
+        snprintf(msg, sizeof(msg), "port %d @%u Hz: %u frames, jitter max %u us",
+                 p, (unsigned)st.refresh_rate, (unsigned)st.frames_sent, (unsigned)st.jitter_max_us);
+        TEST_MESSAGE(msg);
+        TEST_ASSERT_EQUAL_UINT16(25 + 2 * p, st.refresh_rate);
+        /* One second at the target rate, with slack for start/stop edges */
+        TEST_ASSERT_UINT32_WITHIN(4, 25 + 2 * p, st.frames_sent);
+        TEST_ASSERT_EQUAL_UINT32(vs.frames_done, st.frames_sent);
+        TEST_ASSERT_EQUAL_UINT32(0, vs.records_dropped);
+    }
+    unlink(path);
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_symbols_every_slot_value);
+    RUN_TEST(test_symbols_slot_sizes);
+    RUN_TEST(test_symbols_port_timing);
+    RUN_TEST(test_symbols_output_too_small);
+    RUN_TEST(test_symbols_render_benchmark);
+    RUN_TEST(test_lanes_transpose8);
+    RUN_TEST(test_lanes_render_16);
+    RUN_TEST(test_lanes_render_8);
+    RUN_TEST(test_lanes_render_benchmark);
+    RUN_TEST(test_sched_latency_mode);
+    RUN_TEST(test_sched_slot_count);
+    RUN_TEST(test_sched_latency_model);
+#if DMX_TEST_VIRTUAL
+    RUN_TEST(test_virtual_backend_records);
+    RUN_TEST(test_virtual_scheduler_benchmark);
+    RUN_TEST(test_core_drives_all_ports);
+#endif
+    return UNITY_END();
+}
@@ -80,8 +80,10 @@ esp_err_t net_get_last_failure(char* buf, size_t buf_len) {
 void net_record_failure_internal(const char* json_log) {
     nvs_handle_t nvs;
     if (nvs_open("err_log", NVS_READWRITE, &nvs) == ESP_OK) {
+        sys_flash_write_begin();
         nvs_set_str(nvs, "net_fail", json_log);
         nvs_commit(nvs);
+        sys_flash_write_end();
         nvs_close(nvs);
     }
 }
@@ -182,6 +184,7 @@ esp_err_t net_init(const net_config_t* cfg) {
 
     // --- STEP 3: WIFI AP (Fallback cuối cùng) ---
     ESP_LOGW(TAG, "Starting WiFi AP Mode...");
+    sys_cfg = sys_get_config();  // config snapshot may have been replaced while waiting
     net_wifi_start_ap(sys_cfg->net.ap_ssid, sys_cfg->net.ap_pass);
     g_net_status.current_mode = NET_MODE_WIFI_AP;
 
@@ -3,6 +3,7 @@
 #include "sdkconfig.h"
 #include "esp_log.h"
 #include "mod_proto.h" // metrics API
+#include "proto_types.h"
 
 static const char *TAG = "mod_proto.artnet";
 
@@ -43,3 +44,29 @@ int parse_artnet_packet(const uint8_t *buf, _ssize_t buflen, uint16_t *out_unive
     *out_len = length;
     return 1;
 }
+
+/*
+ * Header-only check for the receive pre-filter: needs ARTNET_PEEK_LEN bytes.
+ * Returns 1 with the universe for ArtDmx, 0 for anything else (other
+ * opcodes and short or foreign datagrams go to the full parser).
+ */
+int artnet_peek_universe(const uint8_t *hdr, size_t len, uint16_t *out_universe)
+{
+    if (len < ARTNET_PEEK_LEN) return 0;
+    if (memcmp(hdr, "Art-Net", 7) != 0) return 0;
+    if (hdr[8] != 0x00 || hdr[9] != 0x50) return 0;
+    *out_universe = ((uint16_t)hdr[15] << 8) | hdr[14];
+    return 1;
+}
+
+/* Physical input port (offset 13) of an ArtDmx packet the parser accepted */
+uint8_t artnet_physical_port(const uint8_t *pkt)
+{
+    return pkt[13];
+}
+
+/* Sequence (offset 12): 1..255 then wraps to 1; 0 disables reordering checks */
+uint8_t artnet_sequence(const uint8_t *pkt)
+{
+    return pkt[12];
+}
@@ -0,0 +1,49 @@
+/**
+ * @file merge_kernel.h
+ * @brief HTP merge kernels (per-channel unsigned max of two universes)
+ *
+ * merge_kernel_htp() picks the fastest kernel for the build: 128-bit PIE on
+ * the ESP32-S3 (CONFIG_MODPROTO_MERGE_PIE, 16-byte aligned buffers), 32-bit
+ * SWAR elsewhere. The SWAR and scalar kernels are exported for tests and
+ * benchmarks. merge_kernel_prio() (per-channel priority) is SWAR on all
+ * targets. No RTOS calls.
+ */
+
+#ifndef _MERGE_KERNEL_H_
+#define _MERGE_KERNEL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define MERGE_KERNEL_ALIGN 16   /* alignment the PIE kernel needs for full speed */
+
+/** out[i] = max(a[i], b[i]) for i < len; buffers may alias out */
+void merge_kernel_htp(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len);
+
+/** Portable 32-bit SWAR kernel (four channels per word) */
+void merge_kernel_htp_swar(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len);
+
+/** Byte loop reference */
+void merge_kernel_htp_scalar(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len);
+
+/**
+ * @brief Fold one source into a per-channel priority merge (sACN 0xDD)
+ *
+ * For each channel, a source priority above best[i] takes the channel; an
+ * equal one is merged HTP (or takes it, if @p ltp). best[] tracks the
+ * winning priority. Start with out[] and best[] zeroed and fold LTP
+ * sources oldest first.
+ *
+ * @param prio    Per-channel priorities, 0 = no data for that channel;
+ *                NULL: every channel has priority @p uniform
+ * @param uniform Priority used when @p prio is NULL
+ */
+void merge_kernel_prio(uint8_t *out, uint8_t *best, const uint8_t *data,
+                       const uint8_t *prio, uint8_t uniform, bool ltp, size_t len);
+
+/** Byte loop reference for merge_kernel_prio() */
+void merge_kernel_prio_scalar(uint8_t *out, uint8_t *best, const uint8_t *data,
+                              const uint8_t *prio, uint8_t uniform, bool ltp, size_t len);
+
+#endif /* _MERGE_KERNEL_H_ */
@@ -2,6 +2,8 @@
 #define _MOD_PROTO_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 /* Timeout for streams (ms) per ANSI E1.31 */
@@ -30,7 +32,7 @@ esp_err_t proto_start(void);
  * @brief Reload configuration (universe mappings)
  * 
  * According to API Contract: Leave/Join Multicast group based on new universe mapping.
- * Since routing is done dynamically via sys_route_find_port(), this function
+ * Since routing is done dynamically via sys_route_find_ports(), this function
  * mainly handles sACN multicast group management.
  */
 void proto_reload_config(void);
@@ -54,16 +56,99 @@ typedef struct {
     uint32_t malformed_sacn_packets;
     uint32_t socket_errors;
     uint32_t igmp_failures;
+    uint32_t rx_accepted;       // Datagrams passed by the header pre-filter
+    uint32_t rx_filtered;       // Dropped from the header: universe not routed
+    uint32_t sources_rejected;  // Packets from a new source while the source table was full
+    uint32_t seq_lost;          // Packets missing from sequence gaps, all ports
+    uint32_t seq_reordered;     // Dropped: sequence 1..19 behind the last accepted
+    uint32_t seq_duplicate;     // Dropped: sequence repeated
 } mod_proto_metrics_t;
 
 /** Populate metrics (atomic-safe snapshot). */
 void mod_proto_get_metrics(mod_proto_metrics_t *out);
 
+/* Sequence anomalies per output port, i.e. per received universe. A packet
+ * that arrives late counts as lost when the gap is seen and as reordered
+ * when it is dropped. */
+typedef struct {
+    uint32_t lost;
+    uint32_t reordered;
+    uint32_t duplicate;
+} mod_proto_seq_stats_t;
+
+void mod_proto_get_port_seq_stats(int port_idx, mod_proto_seq_stats_t *out);
+
+/* Receive loop histograms, one sample per proto_task wakeup. Bucket i of
+ * batch[] counts wakeups that processed [2^(i-1), 2^i) datagrams (bucket 0:
+ * none); bucket i of proc_us[] counts wakeups that took [50us * 2^(i-1),
+ * 50us * 2^i) (bucket 0: under 50us). The last bucket is open-ended. */
+#define PROTO_HIST_BUCKETS 8
+#define PROTO_HIST_PROC_BASE_US 50
+
+typedef struct {
+    uint32_t batch[PROTO_HIST_BUCKETS];
+    uint32_t proc_us[PROTO_HIST_BUCKETS];
+    uint32_t wakeups;
+    uint32_t packets;
+    uint32_t batch_max;         // Most datagrams drained in one wakeup
+    uint32_t proc_max_us;       // Longest wakeup processing time
+    uint32_t budget_hits;       // Wakeups that stopped at the batch budget
+} mod_proto_rx_hist_t;
+
+/** Snapshot of the receive loop histograms. */
+void mod_proto_get_rx_hist(mod_proto_rx_hist_t *out);
+void mod_proto_reset_rx_hist(void);
+
+/* Raw UDP ingest (CONFIG_MODPROTO_RAW_UDP). Per-packet CPU on the tcpip
+ * thread is cb_us_total / packets; the merge side is in mod_proto_rx_hist_t
+ * (proc_us per wakeup), which covers the socket path too. Counters are
+ * written by the tcpip thread; a snapshot may be slightly torn. */
+typedef struct {
+    bool enabled;               // Raw path compiled in and running
+    uint32_t packets;           // Datagrams parsed and queued
+    uint32_t drops_full;        // Queue full, datagram dropped
+    uint32_t chained;           // Datagrams copied out of chained pbufs
+    uint32_t cb_us_total;       // Time spent in the receive callback
+    uint32_t cb_max_us;
+    uint32_t queued;            // Packets waiting for proto_task
+} mod_proto_raw_stats_t;
+
+void mod_proto_get_raw_stats(mod_proto_raw_stats_t *out);
+
+/* Live sources (sACN by CID, Art-Net by IP + physical port). Sources
+ * idle for PROTO_STREAM_TIMEOUT_MS leave the list. */
+typedef struct {
+    uint8_t protocol;           // PROTOCOL_ARTNET / PROTOCOL_SACN
+    uint8_t cid[16];            // sACN component identifier, zero for Art-Net
+    char name[64];              // sACN source name, empty for Art-Net
+    uint32_t ip;                // Last sender address, network byte order
+    uint8_t physical;           // Art-Net physical input port
+    uint16_t universe;          // Last universe received
+    uint32_t packets;
+    uint32_t rate_pps;          // Packets per second over the last second
+    uint32_t age_ms;            // Since first packet
+    uint32_t idle_ms;           // Since last packet
+    mod_proto_seq_stats_t seq;  // Summed over the universes it sends
+} mod_proto_source_info_t;
+
+#define MOD_PROTO_MAX_SOURCES 24    // Live entries the source table holds
+
+/** Copy up to max live sources; returns the number copied */
+size_t mod_proto_get_sources(mod_proto_source_info_t *out, size_t max);
+
+/** Record one wakeup of the receive loop (proto_task only) */
+void mod_proto_metrics_record_wakeup(uint32_t packets, uint32_t proc_us, bool budget_hit);
+
 /** Increment counters (used internally by parsers/sockets) */
 void mod_proto_metrics_inc_malformed_artnet(void);
 void mod_proto_metrics_inc_malformed_sacn(void);
 void mod_proto_metrics_inc_socket_error(void);
 void mod_proto_metrics_inc_igmp_failure(void);
+void mod_proto_metrics_inc_rx_accepted(void);
+void mod_proto_metrics_inc_rx_filtered(void);
+void mod_proto_metrics_inc_source_rejected(void);
+/** Sequence anomalies of one packet, for every port in the bitmask */
+void mod_proto_metrics_add_seq(uint32_t ports, uint32_t lost, uint32_t reordered, uint32_t duplicate);
 
 #ifdef __cplusplus
 }
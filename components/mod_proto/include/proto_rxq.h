@@ -0,0 +1,100 @@
+/**
+ * @file proto_rxq.h
+ * @brief Lock-free single-producer/single-consumer queue of parsed packets
+ *
+ * Producer: lwIP tcpip thread (raw UDP receive callback).
+ * Consumer: proto_task (merge stage).
+ * Each cell holds a copy of the packet (headers and slots), so the
+ * producer frees the pbuf at once and driver RX buffers are never held
+ * while packets wait. Cells are filled and read in place
+ * (reserve/commit, front/release); push/pop copy whole items.
+ * Pure C11 atomics, no RTOS calls.
+ */
+
+#ifndef _PROTO_RXQ_H_
+#define _PROTO_RXQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PROTO_RXQ_SIZE 32       /* power of two */
+#define PROTO_RX_PKT_MAX 640    /* Full sACN data packet: 126-byte header + 512 slots */
+
+typedef struct {
+    uint16_t pkt_len;       /* bytes of pkt in use */
+    uint16_t data_off;      /* DMX slot 1 at pkt + data_off */
+    uint16_t len;
+    uint16_t universe;
+    uint8_t priority;       /* sACN priority or 0 for Art-Net */
+    uint8_t protocol;       /* PROTOCOL_ARTNET / PROTOCOL_SACN */
+    uint8_t start_code;     /* sACN: 0x00 levels, 0xDD per-channel priority */
+    uint32_t src_ip;        /* network byte order */
+    uint8_t pkt[PROTO_RX_PKT_MAX];  /* packet from offset 0 up to the last slot */
+} proto_rx_item_t;
+
+typedef struct {
+    proto_rx_item_t items[PROTO_RXQ_SIZE];
+    uint32_t head;          /* next to pop, written by consumer */
+    uint32_t tail;          /* next to push, written by producer */
+} proto_rxq_t;
+
+static inline void proto_rxq_init(proto_rxq_t *q)
+{
+    __atomic_store_n(&q->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->tail, 0, __ATOMIC_RELAXED);
+}
+
+/** Producer side: free cell to fill, NULL when full. Visible after commit. */
+static inline proto_rx_item_t *proto_rxq_reserve(proto_rxq_t *q)
+{
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    if (tail - head >= PROTO_RXQ_SIZE) return NULL;
+    return &q->items[tail & (PROTO_RXQ_SIZE - 1)];
+}
+
+static inline void proto_rxq_commit(proto_rxq_t *q)
+{
+    __atomic_store_n(&q->tail, __atomic_load_n(&q->tail, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+/** Consumer side: oldest cell, NULL when empty. Stays valid until release. */
+static inline const proto_rx_item_t *proto_rxq_front(proto_rxq_t *q)
+{
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return NULL;
+    return &q->items[head & (PROTO_RXQ_SIZE - 1)];
+}
+
+static inline void proto_rxq_release(proto_rxq_t *q)
+{
+    __atomic_store_n(&q->head, __atomic_load_n(&q->head, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+/** Producer side. Returns false when full. */
+static inline bool proto_rxq_push(proto_rxq_t *q, const proto_rx_item_t *item)
+{
+    proto_rx_item_t *cell = proto_rxq_reserve(q);
+    if (!cell) return false;
+    *cell = *item;
+    proto_rxq_commit(q);
+    return true;
+}
+
+/** Consumer side. Returns false when empty. */
+static inline bool proto_rxq_pop(proto_rxq_t *q, proto_rx_item_t *out)
+{
+    const proto_rx_item_t *cell = proto_rxq_front(q);
+    if (!cell) return false;
+    *out = *cell;
+    proto_rxq_release(q);
+    return true;
+}
+
+static inline uint32_t proto_rxq_count(proto_rxq_t *q)
+{
+    return __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+}
+
+#endif /* _PROTO_RXQ_H_ */
@@ -0,0 +1,79 @@
+/**
+ * @file proto_srctab.h
+ * @brief Live source table: open-addressing hash of sACN CIDs and Art-Net
+ *        (IP, physical port) pairs
+ *
+ * Each source gets a 32-bit id that is never reused; the merge engine keys
+ * its per-universe sources by that id, so one IP sending several CIDs, or
+ * one CID reached over two interfaces, is identified correctly.
+ *
+ * Single writer (proto_task). Readers on other tasks copy the table with
+ * proto_srctab_snapshot(), which detects concurrent inserts and removals;
+ * per-packet counters may be read slightly torn. No RTOS calls.
+ */
+
+#ifndef _PROTO_SRCTAB_H_
+#define _PROTO_SRCTAB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define PROTO_SRCTAB_SLOTS    32    /* power of two */
+#define PROTO_SRCTAB_MAX_LIVE 24    /* 3/4 load keeps probe chains short */
+#define PROTO_SRC_KEY_LEN     16    /* sACN CID length */
+#define PROTO_SRC_NAME_LEN    64    /* sACN source name, NUL-terminated */
+
+typedef struct {
+    uint32_t sid;                   /* 0: empty slot */
+    uint8_t  key[PROTO_SRC_KEY_LEN]; /* CID, or IP + physical port for Art-Net */
+    uint8_t  protocol;              /* PROTOCOL_ARTNET / PROTOCOL_SACN */
+    uint16_t universe;              /* last universe received */
+    uint32_t src_ip;                /* network byte order, last seen */
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;
+    uint32_t packets;
+    uint32_t rate_pps;              /* packets per second over the last window */
+    uint32_t window_packets;        /* packets at window start */
+    uint32_t window_start_ms;
+    uint32_t seq_lost;              /* sequence gaps, summed over universes */
+    uint32_t seq_reordered;         /* dropped: 1..19 behind */
+    uint32_t seq_duplicate;         /* dropped: same sequence again */
+    char     name[PROTO_SRC_NAME_LEN];
+} proto_src_entry_t;
+
+typedef struct {
+    proto_src_entry_t slots[PROTO_SRCTAB_SLOTS];
+    uint32_t next_sid;
+    uint32_t seq;                   /* odd while entries are added or removed */
+    uint16_t count;
+} proto_srctab_t;
+
+void proto_srctab_init(proto_srctab_t *t);
+
+/**
+ * @brief Find or add a source and count one packet from it
+ *
+ * @param key  PROTO_SRC_KEY_LEN bytes
+ * @param name Source name (may be NULL); read up to PROTO_SRC_NAME_LEN bytes
+ *             and only when the source is added
+ * @return Source id, or 0 when the table is full
+ */
+uint32_t proto_srctab_touch(proto_srctab_t *t, uint8_t protocol, const uint8_t *key, uint32_t src_ip,
+                            uint16_t universe, const char *name, uint32_t now_ms);
+
+/** Add sequence anomalies to source @p sid (rare: a scan, not a lookup) */
+void proto_srctab_note_seq(proto_srctab_t *t, uint32_t sid, uint32_t lost, uint32_t reordered, uint32_t duplicate);
+
+/** Drop sources idle longer than @p idle_ms and update packet rates */
+void proto_srctab_sweep(proto_srctab_t *t, uint32_t now_ms, uint32_t idle_ms);
+
+/**
+ * @brief Copy up to @p max live entries
+ *
+ * @return false if the writer added or removed a source meanwhile; the
+ *         caller should yield and retry (spinning could starve the writer)
+ */
+bool proto_srctab_snapshot(const proto_srctab_t *t, proto_src_entry_t *out, size_t max, size_t *out_n);
+
+#endif /* _PROTO_SRCTAB_H_ */
@@ -3,22 +3,86 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
 #include "sys_mod.h" /* for SYS_MAX_PORTS, DMX_UNIVERSE_SIZE */
 
+/* Source table sizes (Kconfig): sources per universe, and the shared pool
+ * their buffers come from */
+#define MERGE_MAX_SOURCES CONFIG_MODPROTO_MERGE_MAX_SOURCES
+#define MERGE_POOL_SIZE   CONFIG_MODPROTO_MERGE_POOL_SIZE
+/* Per-channel priority planes (sACN start code 0xDD), also pooled */
+#define MERGE_PRIO_POOL_SIZE CONFIG_MODPROTO_MERGE_PRIO_POOL_SIZE
+
+#define MERGE_SEQ_NONE (-1)   /* packet carries no sequence number */
+
+#define SACN_START_CODE_DMX      0x00
+#define SACN_START_CODE_PRIORITY 0xDD
+
+/* Framing layer Options bits */
+#define SACN_OPT_PREVIEW    0x80    /* Preview_Data: not for live output */
+#define SACN_OPT_TERMINATED 0x40    /* Stream_Terminated: source is going away */
+
 typedef struct {
-    bool active;
     uint64_t last_pkt_ts_ms; /* esp_timer_get_time() / 1000 */
+    uint32_t src_id;      /* proto_srctab id (merge_source_id) */
+    uint16_t len;         /* channels carried by the last packet */
     uint8_t priority;     /* sACN priority or 0 for Art-Net */
-    uint8_t data[DMX_UNIVERSE_SIZE];
-    uint32_t src_ip;
+    int16_t last_seq;     /* last accepted sequence number, MERGE_SEQ_NONE */
+    uint8_t port;         /* owning merge context */
+    uint8_t heap_idx;     /* entry in the loss deadline heap */
+    uint16_t chan_prio_len;      /* channels carried by the last 0xDD packet */
+    uint64_t chan_prio_ts_ms;    /* last 0xDD packet */
+    uint8_t *chan_prio;          /* per-channel priorities (0 = no data), NULL: none */
+    uint8_t data[DMX_UNIVERSE_SIZE] __attribute__((aligned(16)));  /* merge kernel */
 } proto_source_t;
 
+/* Sources at top_priority are the winners: HTP/LTP applies across them
+ * only, lower priorities are tracked but never merged. Once any source sends
+ * per-channel priorities the winner is picked per channel instead. */
 typedef struct {
     uint16_t universe;
     uint8_t  merge_mode;    /* runtime only: MERGE_MODE_* */
-    proto_source_t source_a;
-    proto_source_t source_b;
-    uint8_t final_data[DMX_UNIVERSE_SIZE];
+    uint8_t  source_count;  /* entries used in sources[] */
+    uint8_t  top_priority;  /* highest priority among the sources */
+    uint8_t  top_count;     /* sources at top_priority */
+    uint8_t  chan_prio_count; /* sources with a priority plane: per-channel merge */
+    proto_source_t *sources[MERGE_MAX_SOURCES];  /* from the source pool */
+    uint8_t final_data[DMX_UNIVERSE_SIZE] __attribute__((aligned(16)));
 } merge_context_t;
 
+/* Bytes a header peek needs to find the universe (receive pre-filter) */
+#define ARTNET_PEEK_LEN 16   /* ID, OpCode, ProtVer, Sequence, Physical, SubUni, Net */
+#define SACN_PEEK_LEN   115  /* through the framing layer universe */
+
+int artnet_peek_universe(const uint8_t *hdr, size_t len, uint16_t *out_universe);
+int sacn_peek_universe(const uint8_t *hdr, size_t len, uint16_t *out_universe);
+
+/* false: the header names a universe no port outputs, drop the datagram */
+bool merge_prefilter(uint8_t protocol, const uint8_t *hdr, size_t len);
+
+/* Source identity of a packet the parser accepted: sACN root-layer CID and
+ * framing-layer source name, Art-Net physical input port */
+void sacn_source_info(const uint8_t *pkt, uint8_t *out_cid, const char **out_name);
+uint8_t artnet_physical_port(const uint8_t *pkt);
+
+/* Framing-layer / ArtDmx sequence number (Art-Net: 0 = not sequenced) */
+uint8_t sacn_sequence(const uint8_t *pkt);
+uint8_t artnet_sequence(const uint8_t *pkt);
+uint8_t sacn_options(const uint8_t *pkt);     /* SACN_OPT_* */
+
+/* One parsed sACN packet, from either ingest path: options, source id,
+ * sequence and start code are handled here */
+void merge_input_sacn(const uint8_t *pkt, uint16_t universe, uint8_t start_code, const uint8_t *data,
+                      uint16_t len, uint8_t priority, uint32_t src_ip);
+
+/* Loss timeouts: merge_check_timeout_ms() is cheap until the earliest
+ * deadline (UINT64_MAX: no sources); merge_sweep_sources() ages the source
+ * table and its packet rates, every PROTO_TIMEOUT_SCAN_MS is enough */
+uint64_t merge_next_deadline_ms(void);
+void merge_sweep_sources(uint64_t now_ms);
+
+/* Source table id for merge_input(); 0 when the source table is full */
+uint32_t merge_source_id(uint8_t protocol, const uint8_t *pkt, uint16_t universe, uint32_t src_ip);
+
 #endif /* _PROTO_TYPES_H_ */
@@ -1,10 +1,15 @@
 #include "proto_types.h"
 #include "mod_proto.h"
+#include "merge_kernel.h"
+#include "proto_srctab.h"
 
 #include "sdkconfig.h"
 #include <string.h>
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "sys_mod.h"
 
 // TAG not used in this file - logging done in proto_mgr.c
@@ -12,15 +17,137 @@
 
 merge_context_t g_merge_ctx[SYS_MAX_PORTS];
 
+/* Source buffers for all ports; only proto_task touches them */
+static proto_source_t s_source_pool[MERGE_POOL_SIZE];
+static proto_source_t *s_source_free[MERGE_POOL_SIZE];
+static int s_source_free_count;
+
+/* Per-channel priority planes, taken on a source's first 0xDD packet */
+static uint8_t s_prio_pool[MERGE_PRIO_POOL_SIZE][DMX_UNIVERSE_SIZE] __attribute__((aligned(16)));
+static uint8_t *s_prio_free[MERGE_PRIO_POOL_SIZE];
+static int s_prio_free_count;
+static uint8_t s_best_prio[DMX_UNIVERSE_SIZE] __attribute__((aligned(16)));  /* recompute scratch */
+
+/* Loss deadlines: min-heap with one entry per pooled source. A packet only
+ * stamps its source; an entry that comes due early is re-keyed from the
+ * source's timestamps, so the timeout check costs O(1) until something can
+ * actually expire. */
+typedef struct {
+    uint64_t deadline_ms;
+    proto_source_t *src;
+} merge_deadline_t;
+
+static merge_deadline_t s_deadlines[MERGE_POOL_SIZE];
+static int s_deadline_count;
+
+/* Who is sending: CID for sACN, IP + physical port for Art-Net */
+static proto_srctab_t s_srctab;
+_Static_assert(PROTO_SRCTAB_MAX_LIVE == MOD_PROTO_MAX_SOURCES, "mod_proto.h source count");
+
+/* Serialises mod_proto_get_sources() callers around its shared snapshot */
+static SemaphoreHandle_t s_sources_lock;
+static StaticSemaphore_t s_sources_lock_buf;
+
 void merge_init(void)
 {
     for (int i = 0; i < SYS_MAX_PORTS; ++i) {
         g_merge_ctx[i].universe = 0xFFFF;
         g_merge_ctx[i].merge_mode = MERGE_MODE_HTP;
+        g_merge_ctx[i].source_count = 0;
+        g_merge_ctx[i].top_priority = 0;
+        g_merge_ctx[i].top_count = 0;
+        g_merge_ctx[i].chan_prio_count = 0;
         memset(g_merge_ctx[i].final_data, 0, sizeof(g_merge_ctx[i].final_data));
-        g_merge_ctx[i].source_a.active = false;
-        g_merge_ctx[i].source_b.active = false;
     }
+    for (int i = 0; i < MERGE_POOL_SIZE; ++i) s_source_free[i] = &s_source_pool[i];
+    s_source_free_count = MERGE_POOL_SIZE;
+    for (int i = 0; i < MERGE_PRIO_POOL_SIZE; ++i) s_prio_free[i] = s_prio_pool[i];
+    s_prio_free_count = MERGE_PRIO_POOL_SIZE;
+    s_deadline_count = 0;
+    proto_srctab_init(&s_srctab);
+    /* Created once, before proto_task or any API caller exists */
+    if (!s_sources_lock) s_sources_lock = xSemaphoreCreateMutexStatic(&s_sources_lock_buf);
+}
+
+static uint32_t port_loss_timeout_ms(int port)
+{
+    uint16_t t = sys_get_config()->ports[port].loss_timeout_ms;
+    return t ? t : PROTO_STREAM_TIMEOUT_MS;
+}
+
+/* First moment (ms) the source, or its priority plane, counts as lost */
+static uint64_t source_deadline_ms(const proto_source_t *src)
+{
+    uint64_t due = src->last_pkt_ts_ms + port_loss_timeout_ms(src->port) + 1;
+    if (src->chan_prio) {
+        uint64_t prio_due = src->chan_prio_ts_ms + PROTO_STREAM_TIMEOUT_MS + 1;
+        if (prio_due < due) due = prio_due;
+    }
+    return due;
+}
+
+static void deadline_set(int i, merge_deadline_t e)
+{
+    s_deadlines[i] = e;
+    e.src->heap_idx = (uint8_t)i;
+}
+
+static void deadline_sift_up(int i)
+{
+    merge_deadline_t e = s_deadlines[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (s_deadlines[parent].deadline_ms <= e.deadline_ms) break;
+        deadline_set(i, s_deadlines[parent]);
+        i = parent;
+    }
+    deadline_set(i, e);
+}
+
+static void deadline_sift_down(int i)
+{
+    merge_deadline_t e = s_deadlines[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= s_deadline_count) break;
+        if (child + 1 < s_deadline_count && s_deadlines[child + 1].deadline_ms < s_deadlines[child].deadline_ms) child++;
+        if (e.deadline_ms <= s_deadlines[child].deadline_ms) break;
+        deadline_set(i, s_deadlines[child]);
+        i = child;
+    }
+    deadline_set(i, e);
+}
+
+static void deadline_push(proto_source_t *src)
+{
+    int i = s_deadline_count++;
+    s_deadlines[i] = (merge_deadline_t){ .deadline_ms = source_deadline_ms(src), .src = src };
+    deadline_sift_up(i);
+}
+
+static void deadline_remove(proto_source_t *src)
+{
+    int i = src->heap_idx;
+    merge_deadline_t last = s_deadlines[--s_deadline_count];
+    if (i == s_deadline_count) return;
+    deadline_set(i, last);
+    deadline_sift_up(i);
+    deadline_sift_down(last.src->heap_idx);
+}
+
+/* Entries may run early, never late: pull one forward when its source's
+ * deadline moves up (a priority plane on a port with a long loss timeout) */
+static void deadline_advance(proto_source_t *src)
+{
+    uint64_t due = source_deadline_ms(src);
+    if (due >= s_deadlines[src->heap_idx].deadline_ms) return;
+    s_deadlines[src->heap_idx].deadline_ms = due;
+    deadline_sift_up(src->heap_idx);
+}
+
+uint64_t merge_next_deadline_ms(void)
+{
+    return s_deadline_count ? s_deadlines[0].deadline_ms : UINT64_MAX;
 }
 
 static void write_output_if_changed(int port_idx, const uint8_t *data)
@@ -30,110 +157,443 @@ static void write_output_if_changed(int port_idx, const uint8_t *data)
 
     if (memcmp(out, data, DMX_UNIVERSE_SIZE) != 0) {
         memcpy(out, data, DMX_UNIVERSE_SIZE);
+        sys_dmx_commit(port_idx);   /* before the update hook wakes MOD_DMX */
         sys_notify_activity(port_idx);
     }
 }
 
-/* Helper to decide which source wins for LTP */
-static proto_source_t* newer_source(proto_source_t *a, proto_source_t *b)
+static void source_drop_chan_prio(merge_context_t *ctx, proto_source_t *src)
 {
-    if (!a->active) return b->active ? b : NULL;
-    if (!b->active) return a->active ? a : NULL;
-    return (a->last_pkt_ts_ms >= b->last_pkt_ts_ms) ? a : b;
+    s_prio_free[s_prio_free_count++] = src->chan_prio;
+    src->chan_prio = NULL;
+    ctx->chan_prio_count--;
 }
 
-int merge_input_by_universe(uint16_t universe, const uint8_t *data, size_t len, uint8_t priority, uint32_t src_ip)
+static void source_remove(merge_context_t *ctx, int idx)
 {
-    (void)len; // assume 512 or less
+    if (ctx->sources[idx]->chan_prio) source_drop_chan_prio(ctx, ctx->sources[idx]);
+    deadline_remove(ctx->sources[idx]);
+    s_source_free[s_source_free_count++] = ctx->sources[idx];
+    ctx->sources[idx] = ctx->sources[--ctx->source_count];
+}
 
-    /* Look up configured port for sACN then Art-Net */
-    int8_t port = sys_route_find_port(PROTOCOL_SACN, universe);
-    if (port < 0) port = sys_route_find_port(PROTOCOL_ARTNET, universe);
-    if (port < 0) return -1; // no mapping
+/* Per-channel winners (some source sent 0xDD): fold every source through
+   the priority kernel; sources without a plane use their universe priority
+   on every channel. LTP folds oldest first so the newest wins ties. */
+static void merge_recompute_per_channel(merge_context_t *ctx)
+{
+    proto_source_t *order[MERGE_MAX_SOURCES];
+    int n = ctx->source_count;
+    memcpy(order, ctx->sources, n * sizeof(order[0]));
+    bool ltp = ctx->merge_mode == MERGE_MODE_LTP;
+    if (ltp) {
+        for (int i = 1; i < n; ++i) {
+            proto_source_t *s = order[i];
+            int j = i - 1;
+            while (j >= 0 && order[j]->last_pkt_ts_ms > s->last_pkt_ts_ms) { order[j + 1] = order[j]; --j; }
+            order[j + 1] = s;
+        }
+    }
 
-    merge_context_t *ctx = &g_merge_ctx[port];
+    memset(ctx->final_data, 0, DMX_UNIVERSE_SIZE);
+    memset(s_best_prio, 0, DMX_UNIVERSE_SIZE);
+    for (int i = 0; i < n; ++i) {
+        merge_kernel_prio(ctx->final_data, s_best_prio, order[i]->data, order[i]->chan_prio,
+                          order[i]->priority, ltp, DMX_UNIVERSE_SIZE);
+    }
+}
+
+/* Recompute final_data from all sources.
+   Priority rule (E1.31): only the sources sharing the highest priority take
+   part; HTP or LTP is applied across those. Art-Net sources have priority 0. */
+static void merge_recompute(merge_context_t *ctx)
+{
+    uint8_t top = 0;
+    uint8_t count = 0;
+    for (int i = 0; i < ctx->source_count; ++i) {
+        uint8_t p = ctx->sources[i]->priority;
+        if (count == 0 || p > top) { top = p; count = 1; }
+        else if (p == top) count++;
+    }
+    ctx->top_priority = top;
+    ctx->top_count = count;
 
-    /* Update source B if active else A (simple: track by IP) */
-    proto_source_t *target = NULL;
-    if (ctx->source_a.src_ip == src_ip || !ctx->source_a.active) target = &ctx->source_a;
-    else if (ctx->source_b.src_ip == src_ip || !ctx->source_b.active) target = &ctx->source_b;
-    else {
-        /* Overwrite oldest source */
-        uint64_t a_ts = ctx->source_a.active ? ctx->source_a.last_pkt_ts_ms : 0;
-        uint64_t b_ts = ctx->source_b.active ? ctx->source_b.last_pkt_ts_ms : 0;
-        target = (a_ts <= b_ts) ? &ctx->source_a : &ctx->source_b;
-    }
-
-    target->active = true;
-    target->last_pkt_ts_ms = esp_timer_get_time() / 1000ULL;
-    target->priority = priority;
-    target->src_ip = src_ip;
-    /* Copy up to DMX_UNIVERSE_SIZE bytes */
-    memcpy(target->data, data, DMX_UNIVERSE_SIZE);
-
-    /* Recompute final_data based on merge_mode and sACN priority rules
-       Priority rule: if both sources are active and have different sACN priority
-       values, the source with the higher priority wins the entire universe. If
-       priorities are equal (or one source inactive), fall back to existing HTP/LTP rules. */
-    if (ctx->source_a.active && ctx->source_b.active && ctx->source_a.priority != ctx->source_b.priority) {
-        proto_source_t *higher = (ctx->source_a.priority > ctx->source_b.priority) ? &ctx->source_a : &ctx->source_b;
-        memcpy(ctx->final_data, higher->data, DMX_UNIVERSE_SIZE);
+    if (ctx->chan_prio_count > 0) {
+        merge_recompute_per_channel(ctx);
+    } else if (count == 0) {
+        memset(ctx->final_data, 0, DMX_UNIVERSE_SIZE);
     } else if (ctx->merge_mode == MERGE_MODE_HTP) {
-        for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i) {
-            uint8_t a = ctx->source_a.active ? ctx->source_a.data[i] : 0;
-            uint8_t b = ctx->source_b.active ? ctx->source_b.data[i] : 0;
-            ctx->final_data[i] = (a >= b) ? a : b;
+        /* Fold the winners pairwise through the merge kernel */
+        const uint8_t *first = NULL;
+        bool folded = false;
+        for (int i = 0; i < ctx->source_count; ++i) {
+            const proto_source_t *src = ctx->sources[i];
+            if (src->priority != top) continue;
+            if (!first) {
+                first = src->data;
+            } else if (!folded) {
+                merge_kernel_htp(ctx->final_data, first, src->data, DMX_UNIVERSE_SIZE);
+                folded = true;
+            } else {
+                merge_kernel_htp(ctx->final_data, ctx->final_data, src->data, DMX_UNIVERSE_SIZE);
+            }
         }
+        if (!folded) memcpy(ctx->final_data, first, DMX_UNIVERSE_SIZE);
     } else {
-        /* LTP: choose newest source entirely */
-        proto_source_t *newer = newer_source(&ctx->source_a, &ctx->source_b);
-        if (newer) {
-            memcpy(ctx->final_data, newer->data, DMX_UNIVERSE_SIZE);
+        /* LTP: the newest winner takes the whole universe */
+        const proto_source_t *newer = NULL;
+        for (int i = 0; i < ctx->source_count; ++i) {
+            const proto_source_t *src = ctx->sources[i];
+            if (src->priority == top && (!newer || src->last_pkt_ts_ms >= newer->last_pkt_ts_ms)) newer = src;
+        }
+        memcpy(ctx->final_data, newer->data, DMX_UNIVERSE_SIZE);
+    }
+}
+
+static proto_source_t *ctx_find_source(merge_context_t *ctx, uint32_t src_id)
+{
+    for (int i = 0; i < ctx->source_count; ++i) {
+        if (ctx->sources[i]->src_id == src_id) return ctx->sources[i];
+    }
+    return NULL;
+}
+
+/* Signed distance from the last accepted sequence number. Art-Net counts
+ * 1..255 (0 means sequencing is off), sACN 0..255. */
+static int seq_delta(uint8_t protocol, uint8_t last, uint8_t seq)
+{
+    if (protocol == PROTOCOL_ARTNET) {
+        int d = ((int)seq - (int)last + 255) % 255;
+        return d > 127 ? d - 255 : d;
+    }
+    return (int8_t)(uint8_t)(seq - last);
+}
+
+/* E1.31 6.7.2: drop a packet whose sequence number is 0..19 behind the last
+ * accepted one; anything further back is a restarted source. Every port
+ * that outputs the universe sees the same packets, so the first one holding
+ * the source decides for all of them. */
+static bool merge_seq_accept(uint8_t protocol, uint32_t ports, uint32_t src_id, int seq)
+{
+    if (seq == MERGE_SEQ_NONE) return true;
+
+    const proto_source_t *src = NULL;
+    for (uint32_t m = ports; m && !src; m &= m - 1) {
+        int port = __builtin_ctz(m);
+        if (port >= SYS_MAX_PORTS) break;
+        src = ctx_find_source(&g_merge_ctx[port], src_id);
+    }
+    if (!src || src->last_seq == MERGE_SEQ_NONE) return true;
+
+    int d = seq_delta(protocol, (uint8_t)src->last_seq, (uint8_t)seq);
+    uint32_t lost = 0, reordered = 0, duplicate = 0;
+    if (d == 0) duplicate = 1;
+    else if (d < 0 && d > -20) reordered = 1;
+    else if (d > 1) lost = (uint32_t)(d - 1);   /* a late arrival is also counted as reordered */
+    if (!(lost | reordered | duplicate)) return true;
+
+    mod_proto_metrics_add_seq(ports, lost, reordered, duplicate);
+    proto_srctab_note_seq(&s_srctab, src_id, lost, reordered, duplicate);
+    return !(reordered | duplicate);
+}
+
+static void merge_into_port(int port, uint16_t universe, const uint8_t *data, size_t len,
+                            uint8_t priority, uint32_t src_id, int seq, uint64_t now_ms)
+{
+    merge_context_t *ctx = &g_merge_ctx[port];
+    ctx->universe = universe;
+
+    /* Sources are tracked by source table id; a full table refuses newcomers
+     * rather than evicting a live source */
+    proto_source_t *src = ctx_find_source(ctx, src_id);
+    bool is_new = (src == NULL);
+    if (is_new) {
+        if (ctx->source_count >= MERGE_MAX_SOURCES || s_source_free_count == 0) {
+            mod_proto_metrics_inc_source_rejected();
+            return;
+        }
+        src = s_source_free[--s_source_free_count];
+        ctx->sources[ctx->source_count++] = src;
+        src->src_id = src_id;
+        src->len = DMX_UNIVERSE_SIZE;   /* zero the whole tail below */
+        src->chan_prio = NULL;
+        src->last_seq = MERGE_SEQ_NONE;
+        src->port = (uint8_t)port;
+    }
+
+    bool was_top = !is_new && src->priority == ctx->top_priority;
+    bool changed = is_new || len != src->len || memcmp(src->data, data, len) != 0;
+    bool reprioritized = is_new || src->priority != priority;
+
+    src->last_pkt_ts_ms = now_ms;
+    src->last_seq = (int16_t)seq;
+    src->priority = priority;
+    if (is_new) deadline_push(src);
+    if (changed) {
+        /* Copy the channels carried by the packet; the rest of the source is 0 */
+        memcpy(src->data, data, len);
+        if (len < src->len) memset(src->data + len, 0, src->len - len);
+        src->len = (uint16_t)len;
+    }
+
+    /* Recompute only what this packet can affect */
+    bool recomputed = false;
+    if (ctx->chan_prio_count > 0) {
+        /* Per-channel winners: any source may own some channel */
+        if (changed || reprioritized || ctx->merge_mode == MERGE_MODE_LTP) {
+            merge_recompute(ctx);
+            recomputed = true;
         }
+    } else if (reprioritized) {
+        if (was_top || ctx->top_count == 0 || priority >= ctx->top_priority) {
+            merge_recompute(ctx);
+            recomputed = true;
+        }
+        /* else: a source below the winners stays below them */
+    } else if (was_top && ctx->merge_mode == MERGE_MODE_LTP) {
+        /* Newest winner wins, and this one is now the newest */
+        memcpy(ctx->final_data, src->data, DMX_UNIVERSE_SIZE);
+        recomputed = true;
+    } else if (was_top && changed) {
+        if (ctx->top_count == 1) memcpy(ctx->final_data, src->data, DMX_UNIVERSE_SIZE);
+        else merge_recompute(ctx);
+        recomputed = true;
     }
 
+    /* Channel extent for auto slot count, before the output hook can fire */
+    sys_note_slot_extent(port, (uint16_t)len);
+
     /* Write to sys output if changed */
-    write_output_if_changed(port, ctx->final_data);
+    if (recomputed) write_output_if_changed(port, ctx->final_data);
+}
+
+uint32_t merge_source_id(uint8_t protocol, const uint8_t *pkt, uint16_t universe, uint32_t src_ip)
+{
+    uint8_t key[PROTO_SRC_KEY_LEN] = {0};
+    const char *name = NULL;
+    if (protocol == PROTOCOL_SACN) {
+        sacn_source_info(pkt, key, &name);
+    } else {
+        memcpy(key, &src_ip, sizeof(src_ip));
+        key[sizeof(src_ip)] = artnet_physical_port(pkt);
+    }
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
+    uint32_t sid = proto_srctab_touch(&s_srctab, protocol, key, src_ip, universe, name, now_ms);
+    if (sid == 0) mod_proto_metrics_inc_source_rejected();
+    return sid;
+}
+
+int merge_input(uint8_t protocol, uint16_t universe, const uint8_t *data, size_t len, uint8_t priority,
+                uint32_t src_id, int seq)
+{
+    uint32_t ports = sys_route_find_ports(protocol, universe);
+    if (!ports) return -1; // no mapping
+    if (len > DMX_UNIVERSE_SIZE) len = DMX_UNIVERSE_SIZE;
+    if (protocol == PROTOCOL_ARTNET && seq == 0) seq = MERGE_SEQ_NONE;   /* sender does not sequence */
+    if (!merge_seq_accept(protocol, ports, src_id, seq)) return 0;
+
+    uint64_t now_ms = esp_timer_get_time() / 1000ULL;
+    while (ports) {
+        int port = __builtin_ctz(ports);
+        ports &= ports - 1;
+        if (port >= SYS_MAX_PORTS) break;
+        merge_into_port(port, universe, data, len, priority, src_id, seq, now_ms);
+    }
     return 0;
 }
 
+bool merge_prefilter(uint8_t protocol, const uint8_t *hdr, size_t len)
+{
+    uint16_t universe;
+    int known = (protocol == PROTOCOL_SACN) ? sacn_peek_universe(hdr, len, &universe)
+                                            : artnet_peek_universe(hdr, len, &universe);
+    if (known && !sys_route_universe_used(universe)) {
+        mod_proto_metrics_inc_rx_filtered();
+        return false;
+    }
+    mod_proto_metrics_inc_rx_accepted();
+    return true;
+}
+
+static void merge_priority_into_port(int port, const uint8_t *prio, size_t len,
+                                     uint32_t src_id, int seq, uint64_t now_ms)
+{
+    merge_context_t *ctx = &g_merge_ctx[port];
+
+    /* Priorities alone carry no levels: wait for the source's 0x00 data */
+    proto_source_t *src = ctx_find_source(ctx, src_id);
+    if (!src) return;
+    src->last_seq = (int16_t)seq;   /* one sequence per universe, all start codes */
+
+    bool changed;
+    if (!src->chan_prio) {
+        /* No plane left: the source keeps merging at its universe priority */
+        if (s_prio_free_count == 0) return;
+        src->chan_prio = s_prio_free[--s_prio_free_count];
+        src->chan_prio_len = DMX_UNIVERSE_SIZE;
+        ctx->chan_prio_count++;
+        src->chan_prio_ts_ms = now_ms;
+        deadline_advance(src);
+        changed = true;
+    } else {
+        changed = len != src->chan_prio_len || memcmp(src->chan_prio, prio, len) != 0;
+        src->chan_prio_ts_ms = now_ms;
+    }
+
+    if (changed) {
+        /* Channels beyond the packet have no data from this source */
+        memcpy(src->chan_prio, prio, len);
+        if (len < src->chan_prio_len) memset(src->chan_prio + len, 0, src->chan_prio_len - len);
+        src->chan_prio_len = (uint16_t)len;
+        merge_recompute(ctx);
+        write_output_if_changed(port, ctx->final_data);
+    }
+}
+
+int merge_input_priority(uint16_t universe, const uint8_t *prio, size_t len, uint32_t src_id, int seq)
+{
+    uint32_t ports = sys_route_find_ports(PROTOCOL_SACN, universe);
+    if (!ports) return -1; // no mapping
+    if (len > DMX_UNIVERSE_SIZE) len = DMX_UNIVERSE_SIZE;
+    if (!merge_seq_accept(PROTOCOL_SACN, ports, src_id, seq)) return 0;
+
+    uint64_t now_ms = esp_timer_get_time() / 1000ULL;
+    while (ports) {
+        int port = __builtin_ctz(ports);
+        ports &= ports - 1;
+        if (port >= SYS_MAX_PORTS) break;
+        merge_priority_into_port(port, prio, len, src_id, seq, now_ms);
+    }
+    return 0;
+}
+
+int merge_input_by_universe(uint16_t universe, const uint8_t *data, size_t len, uint8_t priority, uint32_t src_id)
+{
+    /* Protocol unknown: prefer sACN ports, then Art-Net. No sequence number. */
+    if (merge_input(PROTOCOL_SACN, universe, data, len, priority, src_id, MERGE_SEQ_NONE) == 0) return 0;
+    return merge_input(PROTOCOL_ARTNET, universe, data, len, priority, src_id, MERGE_SEQ_NONE);
+}
+
+static int ctx_source_index(const merge_context_t *ctx, const proto_source_t *src)
+{
+    for (int i = 0; i < ctx->source_count; ++i) {
+        if (ctx->sources[i] == src) return i;
+    }
+    return -1;
+}
+
 void merge_check_timeout_ms(uint64_t now_ms)
 {
-    for (int port = 0; port < SYS_MAX_PORTS; ++port) {
-        merge_context_t *ctx = &g_merge_ctx[port];
-        bool changed = false;
-        if (ctx->source_a.active && (now_ms - ctx->source_a.last_pkt_ts_ms) > PROTO_STREAM_TIMEOUT_MS) {
-            ctx->source_a.active = false;
-            memset(ctx->source_a.data, 0, sizeof(ctx->source_a.data));
-            changed = true;
-            /* Source A timed out on this port */
+    uint32_t lost_ports = 0;
+    while (s_deadline_count > 0 && s_deadlines[0].deadline_ms <= now_ms) {
+        proto_source_t *src = s_deadlines[0].src;
+        uint64_t due = source_deadline_ms(src);
+        if (due > now_ms) {
+            /* Refreshed by later packets: re-key and look again */
+            s_deadlines[0].deadline_ms = due;
+            deadline_sift_down(0);
+            continue;
         }
-        if (ctx->source_b.active && (now_ms - ctx->source_b.last_pkt_ts_ms) > PROTO_STREAM_TIMEOUT_MS) {
-            ctx->source_b.active = false;
-            memset(ctx->source_b.data, 0, sizeof(ctx->source_b.data));
-            changed = true;
-            /* Source B timed out on this port */
-        }
-        if (changed) {
-            /* Recompute final and write, honoring sACN priority as above */
-            if (ctx->source_a.active && ctx->source_b.active && ctx->source_a.priority != ctx->source_b.priority) {
-                proto_source_t *higher = (ctx->source_a.priority > ctx->source_b.priority) ? &ctx->source_a : &ctx->source_b;
-                memcpy(ctx->final_data, higher->data, DMX_UNIVERSE_SIZE);
-            } else if (ctx->merge_mode == MERGE_MODE_HTP) {
-                for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i) {
-                    uint8_t a = ctx->source_a.active ? ctx->source_a.data[i] : 0;
-                    uint8_t b = ctx->source_b.active ? ctx->source_b.data[i] : 0;
-                    ctx->final_data[i] = (a >= b) ? a : b;
-                }
-            } else {
-                proto_source_t *newer = newer_source(&ctx->source_a, &ctx->source_b);
-                if (newer) memcpy(ctx->final_data, newer->data, DMX_UNIVERSE_SIZE);
-                else memset(ctx->final_data, 0, DMX_UNIVERSE_SIZE);
-            }
 
-            int8_t port_idx = sys_route_find_port(PROTOCOL_SACN, ctx->universe);
-            if (port_idx < 0) port_idx = sys_route_find_port(PROTOCOL_ARTNET, ctx->universe);
-            if (port_idx >= 0) write_output_if_changed(port_idx, ctx->final_data);
+        merge_context_t *ctx = &g_merge_ctx[src->port];
+        if (now_ms - src->last_pkt_ts_ms > port_loss_timeout_ms(src->port)) {
+            if (src->priority == ctx->top_priority || src->chan_prio) lost_ports |= 1u << src->port;
+            source_remove(ctx, ctx_source_index(ctx, src));
+        } else {
+            /* 0xDD stopped: back to the universe priority */
+            source_drop_chan_prio(ctx, src);
+            lost_ports |= 1u << src->port;
+            s_deadlines[0].deadline_ms = source_deadline_ms(src);
+            deadline_sift_down(0);
         }
     }
+
+    while (lost_ports) {
+        /* Contexts are per port: recompute and write this port directly */
+        int port = __builtin_ctz(lost_ports);
+        lost_ports &= lost_ports - 1;
+        merge_recompute(&g_merge_ctx[port]);
+        write_output_if_changed(port, g_merge_ctx[port].final_data);
+    }
+}
+
+void merge_sweep_sources(uint64_t now_ms)
+{
+    /* Idle longer than any port's loss timeout: a source leaves the table
+     * no earlier than its merge buffers */
+    proto_srctab_sweep(&s_srctab, (uint32_t)now_ms, DMX_LOSS_TIMEOUT_MAX_MS);
+}
+
+/* Stream_Terminated: release the source on every port now instead of after
+ * the loss timeout, so a backup takes over at once */
+static void merge_terminate(uint16_t universe, uint32_t src_id)
+{
+    uint32_t ports = sys_route_find_ports(PROTOCOL_SACN, universe);
+    while (ports) {
+        int port = __builtin_ctz(ports);
+        ports &= ports - 1;
+        if (port >= SYS_MAX_PORTS) break;
+        merge_context_t *ctx = &g_merge_ctx[port];
+        proto_source_t *src = ctx_find_source(ctx, src_id);
+        if (!src) continue;     /* E1.31 senders repeat the terminating packet */
+        source_remove(ctx, ctx_source_index(ctx, src));
+        merge_recompute(ctx);
+        write_output_if_changed(port, ctx->final_data);
+    }
+}
+
+void merge_input_sacn(const uint8_t *pkt, uint16_t universe, uint8_t start_code, const uint8_t *data,
+                      uint16_t len, uint8_t priority, uint32_t src_ip)
+{
+    uint8_t options = sacn_options(pkt);
+    if (options & SACN_OPT_PREVIEW) return;     /* for visualisers, not for output */
+    if (start_code != SACN_START_CODE_DMX && start_code != SACN_START_CODE_PRIORITY) return;
+
+    uint32_t sid = merge_source_id(PROTOCOL_SACN, pkt, universe, src_ip);
+    if (!sid) return;
+    if (options & SACN_OPT_TERMINATED) {
+        merge_terminate(universe, sid);     /* the packet's data is ignored */
+    } else if (start_code == SACN_START_CODE_DMX) {
+        merge_input(PROTOCOL_SACN, universe, data, len, priority, sid, sacn_sequence(pkt));
+    } else {
+        merge_input_priority(universe, data, len, sid, sacn_sequence(pkt));
+    }
+}
+
+size_t mod_proto_get_sources(mod_proto_source_info_t *out, size_t max)
+{
+    static proto_src_entry_t snap[PROTO_SRCTAB_MAX_LIVE];   /* too large for an httpd stack */
+    if (!out || !s_sources_lock) return 0;
+
+    xSemaphoreTake(s_sources_lock, portMAX_DELAY);
+    size_t n = 0;
+    /* Sources come and go at most every few ms: a few retries are enough */
+    for (int tries = 0; tries < 10 && !proto_srctab_snapshot(&s_srctab, snap, PROTO_SRCTAB_MAX_LIVE, &n); ++tries) {
+        n = 0;
+        vTaskDelay(1);
+    }
+    if (n > max) n = max;
+
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
+    for (size_t i = 0; i < n; ++i) {
+        const proto_src_entry_t *e = &snap[i];
+        mod_proto_source_info_t *o = &out[i];
+        o->protocol = e->protocol;
+        o->universe = e->universe;
+        o->ip = e->src_ip;
+        o->packets = e->packets;
+        o->rate_pps = e->rate_pps;
+        o->age_ms = now_ms - e->first_seen_ms;
+        o->idle_ms = now_ms - e->last_seen_ms;
+        memset(o->cid, 0, sizeof(o->cid));
+        o->physical = 0;
+        if (e->protocol == PROTOCOL_SACN) memcpy(o->cid, e->key, sizeof(o->cid));
+        else o->physical = e->key[4];
+        memcpy(o->name, e->name, sizeof(o->name));
+        o->seq.lost = e->seq_lost;
+        o->seq.reordered = e->seq_reordered;
+        o->seq.duplicate = e->seq_duplicate;
+    }
+    xSemaphoreGive(s_sources_lock);
+    return n;
 }
@@ -0,0 +1,152 @@
+#include "merge_kernel.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+/*
+ * HTP merge kernels.
+ * - Scalar: reference byte loop
+ * - SWAR: per-byte unsigned compare in 32-bit words, branch-free
+ * - PIE (ESP32-S3): EE.VMAX.S8 over 16 bytes; inputs are biased by 0x80 so
+ *   the signed max orders them as unsigned, and the result is unbiased
+ * - Per-channel priority: SWAR compare-and-select, four channels per word
+ */
+
+void merge_kernel_htp_scalar(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        out[i] = (a[i] >= b[i]) ? a[i] : b[i];
+    }
+}
+
+#define SWAR_H 0x80808080u
+
+/* 0xFF in every byte whose top bit is set in h */
+static inline uint32_t swar_bytemask(uint32_t h)
+{
+    return (h >> 7) * 0xFFu;
+}
+
+/* Per-byte x < y (unsigned), as a byte mask */
+static inline uint32_t swar_lt_u8(uint32_t x, uint32_t y)
+{
+    /* Per-byte x - y with no borrow between bytes */
+    uint32_t d = ((x | SWAR_H) - (y & ~SWAR_H)) ^ ((x ^ ~y) & SWAR_H);
+    /* Borrow out of each byte's top bit: set where x < y */
+    return swar_bytemask(((~x & y) | (~(x ^ y) & d)) & SWAR_H);
+}
+
+/* Byte mask of the non-zero bytes of x */
+static inline uint32_t swar_nonzero(uint32_t x)
+{
+    return swar_bytemask((((x & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | x) & SWAR_H);
+}
+
+static inline uint32_t swar_max_u8(uint32_t x, uint32_t y)
+{
+    uint32_t mask = swar_lt_u8(x, y);
+    return (x & ~mask) | (y & mask);
+}
+
+void merge_kernel_htp_swar(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len)
+{
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t x, y, r;
+        memcpy(&x, a + i, 4);   /* compiles to a word load when aligned */
+        memcpy(&y, b + i, 4);
+        r = swar_max_u8(x, y);
+        memcpy(out + i, &r, 4);
+    }
+    merge_kernel_htp_scalar(out + i, a + i, b + i, len - i);
+}
+
+void merge_kernel_prio_scalar(uint8_t *out, uint8_t *best, const uint8_t *data,
+                              const uint8_t *prio, uint8_t uniform, bool ltp, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t p = prio ? prio[i] : uniform;
+        if (prio && p == 0) continue;
+        if (p > best[i] || (ltp && p == best[i])) {
+            best[i] = p;
+            out[i] = data[i];
+        } else if (p == best[i] && data[i] > out[i]) {
+            out[i] = data[i];
+        }
+    }
+}
+
+void merge_kernel_prio(uint8_t *out, uint8_t *best, const uint8_t *data,
+                       const uint8_t *prio, uint8_t uniform, bool ltp, size_t len)
+{
+    const uint32_t pu = uniform * 0x01010101u;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t p = pu, b, d, o;
+        if (prio) memcpy(&p, prio + i, 4);
+        memcpy(&b, best + i, 4);
+        memcpy(&d, data + i, 4);
+        memcpy(&o, out + i, 4);
+
+        uint32_t valid = prio ? swar_nonzero(p) : 0xFFFFFFFFu;
+        uint32_t gt = swar_lt_u8(b, p) & valid;
+        uint32_t eq = ~swar_nonzero(p ^ b) & valid;
+        uint32_t take = ltp ? (gt | eq) : gt;
+        uint32_t tie = ltp ? 0 : eq;
+
+        o = (o & ~take) | (d & take);
+        o = (o & ~tie) | (swar_max_u8(o, d) & tie);
+        b = (b & ~gt) | (p & gt);
+
+        memcpy(out + i, &o, 4);
+        memcpy(best + i, &b, 4);
+    }
+    merge_kernel_prio_scalar(out + i, best + i, data + i, prio ? prio + i : NULL, uniform, ltp, len - i);
+}
+
+#if CONFIG_MODPROTO_MERGE_PIE
+
+static const uint8_t s_bias[16] __attribute__((aligned(16))) = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+static void htp_pie(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t blocks)
+{
+    const uint8_t *bias = s_bias;
+    __asm__ volatile ("ee.vld.128.ip q7, %0, 0" : "+r"(bias) :: "memory");
+    for (size_t n = 0; n < blocks; ++n) {
+        __asm__ volatile (
+            "ee.vld.128.ip q0, %[a], 16\n"
+            "ee.vld.128.ip q1, %[b], 16\n"
+            "ee.xorq q0, q0, q7\n"
+            "ee.xorq q1, q1, q7\n"
+            "ee.vmax.s8 q2, q0, q1\n"
+            "ee.xorq q2, q2, q7\n"
+            "ee.vst.128.ip q2, %[out], 16\n"
+            : [a] "+r"(a), [b] "+r"(b), [out] "+r"(out)
+            :
+            : "memory");
+    }
+}
+
+void merge_kernel_htp(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len)
+{
+    /* EE.VLD/VST ignore the low address bits: only aligned buffers qualify */
+    if ((((uintptr_t)out | (uintptr_t)a | (uintptr_t)b) & (MERGE_KERNEL_ALIGN - 1)) == 0) {
+        size_t blocks = len / 16;
+        htp_pie(out, a, b, blocks);
+        size_t done = blocks * 16;
+        merge_kernel_htp_scalar(out + done, a + done, b + done, len - done);
+        return;
+    }
+    merge_kernel_htp_swar(out, a, b, len);
+}
+
+#else
+
+void merge_kernel_htp(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t len)
+{
+    merge_kernel_htp_swar(out, a, b, len);
+}
+
+#endif /* CONFIG_MODPROTO_MERGE_PIE */
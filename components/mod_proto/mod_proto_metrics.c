@@ -1,6 +1,8 @@
 #include "mod_proto.h"
 #include <stdint.h>
+#include <string.h>
 #include "esp_log.h"
+#include "sys_mod.h" /* SYS_MAX_PORTS */
 
 static const char *TAG = "MOD_PROTO_METRICS";
 
@@ -9,6 +11,14 @@ static uint32_t s_malformed_artnet = 0;
 static uint32_t s_malformed_sacn = 0;
 static uint32_t s_socket_errors = 0;
 static uint32_t s_igmp_failures = 0;
+static uint32_t s_rx_accepted = 0;
+static uint32_t s_rx_filtered = 0;
+static uint32_t s_sources_rejected = 0;
+static mod_proto_seq_stats_t s_seq_total;
+static mod_proto_seq_stats_t s_seq_port[SYS_MAX_PORTS];
+
+/* Receive loop histograms: written by proto_task only */
+static mod_proto_rx_hist_t s_rx_hist;
 
 void mod_proto_metrics_inc_malformed_artnet(void)
 {
@@ -30,6 +40,47 @@ void mod_proto_metrics_inc_igmp_failure(void)
     __atomic_add_fetch(&s_igmp_failures, 1, __ATOMIC_SEQ_CST);
 }
 
+void mod_proto_metrics_inc_rx_accepted(void)
+{
+    __atomic_add_fetch(&s_rx_accepted, 1, __ATOMIC_RELAXED);
+}
+
+void mod_proto_metrics_inc_rx_filtered(void)
+{
+    __atomic_add_fetch(&s_rx_filtered, 1, __ATOMIC_RELAXED);
+}
+
+void mod_proto_metrics_inc_source_rejected(void)
+{
+    __atomic_add_fetch(&s_sources_rejected, 1, __ATOMIC_RELAXED);
+}
+
+static void seq_add(mod_proto_seq_stats_t *s, uint32_t lost, uint32_t reordered, uint32_t duplicate)
+{
+    __atomic_add_fetch(&s->lost, lost, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s->reordered, reordered, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s->duplicate, duplicate, __ATOMIC_RELAXED);
+}
+
+void mod_proto_metrics_add_seq(uint32_t ports, uint32_t lost, uint32_t reordered, uint32_t duplicate)
+{
+    /* Totals count the packet once, however many ports output it */
+    seq_add(&s_seq_total, lost, reordered, duplicate);
+    for (int i = 0; i < SYS_MAX_PORTS; ++i) {
+        if (ports & (1u << i)) seq_add(&s_seq_port[i], lost, reordered, duplicate);
+    }
+}
+
+void mod_proto_get_port_seq_stats(int port_idx, mod_proto_seq_stats_t *out)
+{
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (port_idx < 0 || port_idx >= SYS_MAX_PORTS) return;
+    out->lost = __atomic_load_n(&s_seq_port[port_idx].lost, __ATOMIC_RELAXED);
+    out->reordered = __atomic_load_n(&s_seq_port[port_idx].reordered, __ATOMIC_RELAXED);
+    out->duplicate = __atomic_load_n(&s_seq_port[port_idx].duplicate, __ATOMIC_RELAXED);
+}
+
 void mod_proto_get_metrics(mod_proto_metrics_t *out)
 {
     if (!out) return;
@@ -37,4 +88,52 @@ void mod_proto_get_metrics(mod_proto_metrics_t *out)
     out->malformed_sacn_packets = __atomic_load_n(&s_malformed_sacn, __ATOMIC_SEQ_CST);
     out->socket_errors = __atomic_load_n(&s_socket_errors, __ATOMIC_SEQ_CST);
     out->igmp_failures = __atomic_load_n(&s_igmp_failures, __ATOMIC_SEQ_CST);
+    out->rx_accepted = __atomic_load_n(&s_rx_accepted, __ATOMIC_RELAXED);
+    out->rx_filtered = __atomic_load_n(&s_rx_filtered, __ATOMIC_RELAXED);
+    out->sources_rejected = __atomic_load_n(&s_sources_rejected, __ATOMIC_RELAXED);
+    out->seq_lost = __atomic_load_n(&s_seq_total.lost, __ATOMIC_RELAXED);
+    out->seq_reordered = __atomic_load_n(&s_seq_total.reordered, __ATOMIC_RELAXED);
+    out->seq_duplicate = __atomic_load_n(&s_seq_total.duplicate, __ATOMIC_RELAXED);
+}
+
+/* Bucket index for v against base: 0 below base, then one per doubling */
+static int hist_bucket(uint32_t v, uint32_t base)
+{
+    int b = 0;
+    while (v >= base && b < PROTO_HIST_BUCKETS - 1) {
+        base <<= 1;
+        b++;
+    }
+    return b;
+}
+
+void mod_proto_metrics_record_wakeup(uint32_t packets, uint32_t proc_us, bool budget_hit)
+{
+    __atomic_add_fetch(&s_rx_hist.batch[hist_bucket(packets, 1)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s_rx_hist.proc_us[hist_bucket(proc_us, PROTO_HIST_PROC_BASE_US)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s_rx_hist.wakeups, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s_rx_hist.packets, packets, __ATOMIC_RELAXED);
+    if (packets > s_rx_hist.batch_max) __atomic_store_n(&s_rx_hist.batch_max, packets, __ATOMIC_RELAXED);
+    if (proc_us > s_rx_hist.proc_max_us) __atomic_store_n(&s_rx_hist.proc_max_us, proc_us, __ATOMIC_RELAXED);
+    if (budget_hit) __atomic_add_fetch(&s_rx_hist.budget_hits, 1, __ATOMIC_RELAXED);
+}
+
+void mod_proto_get_rx_hist(mod_proto_rx_hist_t *out)
+{
+    if (!out) return;
+    for (int i = 0; i < PROTO_HIST_BUCKETS; ++i) {
+        out->batch[i] = __atomic_load_n(&s_rx_hist.batch[i], __ATOMIC_RELAXED);
+        out->proc_us[i] = __atomic_load_n(&s_rx_hist.proc_us[i], __ATOMIC_RELAXED);
+    }
+    out->wakeups = __atomic_load_n(&s_rx_hist.wakeups, __ATOMIC_RELAXED);
+    out->packets = __atomic_load_n(&s_rx_hist.packets, __ATOMIC_RELAXED);
+    out->batch_max = __atomic_load_n(&s_rx_hist.batch_max, __ATOMIC_RELAXED);
+    out->proc_max_us = __atomic_load_n(&s_rx_hist.proc_max_us, __ATOMIC_RELAXED);
+    out->budget_hits = __atomic_load_n(&s_rx_hist.budget_hits, __ATOMIC_RELAXED);
+}
+
+void mod_proto_reset_rx_hist(void)
+{
+    memset(&s_rx_hist, 0, sizeof(s_rx_hist));
+    ESP_LOGI(TAG, "rx histograms reset");
 }
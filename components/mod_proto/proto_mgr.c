@@ -24,15 +24,18 @@ static volatile bool s_task_stop = false;
 static void proto_sys_event_cb(const sys_evt_msg_t *evt, void *user_ctx);
 
 /* Forward declarations of merge/parsers in this component */
-int merge_input_by_universe(uint16_t universe, const uint8_t *data, size_t len, uint8_t priority, uint32_t src_ip);
+int merge_input(uint8_t protocol, uint16_t universe, const uint8_t *data, size_t len, uint8_t priority,
+                uint32_t src_id, int seq);
 void merge_check_timeout_ms(uint64_t now_ms);
 void merge_init(void);
 int parse_artnet_packet(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, const uint8_t **out_data, uint16_t *out_len);
-int parse_sacn_packet(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, const uint8_t **out_data, uint16_t *out_len, uint8_t *out_priority);
+int parse_sacn_frame(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, uint8_t *out_start_code,
+                     const uint8_t **out_data, uint16_t *out_len, uint8_t *out_priority);
 
 #define ARTNET_PORT 6454
 #define SACN_PORT 5568
 #define RX_BUFFER_SIZE 1536
+#define PROTO_TIMEOUT_SCAN_MS 100   // Longest sleep; merge_sweep_sources() interval
 
 static int make_udp_socket(const char *bind_addr, uint16_t port)
 {
@@ -64,9 +67,155 @@ static int make_udp_socket(const char *bind_addr, uint16_t port)
     return sock;
 }
 
-static void proto_task(void *arg)
+/* Sleep until the next packet, the earliest loss deadline, or the sweep
+ * interval, whichever comes first */
+static uint32_t proto_wait_ms(uint64_t now_ms)
+{
+    uint64_t next = merge_next_deadline_ms();
+    if (next <= now_ms) return 0;
+    return (next - now_ms < PROTO_TIMEOUT_SCAN_MS) ? (uint32_t)(next - now_ms) : PROTO_TIMEOUT_SCAN_MS;
+}
+
+#if CONFIG_MODPROTO_RAW_UDP
+esp_err_t proto_raw_start(TaskHandle_t consumer);
+uint32_t proto_raw_drain(uint32_t budget, bool *budget_hit);
+void proto_raw_stop(void);
+
+/* Raw ingest: the tcpip thread parses and queues, this task only merges */
+static void proto_rx_loop(void)
+{
+    /* Ephemeral socket only to own the sACN multicast memberships */
+    int igmp_sock = make_udp_socket(NULL, 0);
+    extern void sacn_apply_memberships_for_socket(int sock);
+    extern void sacn_clear_socket(void);
+    if (igmp_sock >= 0) sacn_apply_memberships_for_socket(igmp_sock);
+
+    bool running = proto_raw_start(xTaskGetCurrentTaskHandle()) == ESP_OK;
+    uint64_t last_scan_ms = 0;
+
+    while (!s_task_stop) {
+        /* Round up: a deadline under one tick away must not become a 0-tick spin */
+        uint32_t wait_ms = proto_wait_ms((uint64_t)esp_timer_get_time() / 1000ULL);
+        uint32_t woken = ulTaskNotifyTake(pdTRUE, (wait_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+        int64_t t0 = esp_timer_get_time();
+
+        uint32_t packets = 0;
+        bool budget_hit = false;
+        if (running) {
+            packets = proto_raw_drain(CONFIG_MODPROTO_RX_BATCH_MAX, &budget_hit);
+            /* Leftovers: come straight back instead of waiting for a notify */
+            if (budget_hit) xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+        }
+
+        uint64_t now_ms = (uint64_t)esp_timer_get_time() / 1000ULL;
+        merge_check_timeout_ms(now_ms);     /* O(1) until a loss deadline is due */
+        if (now_ms - last_scan_ms >= PROTO_TIMEOUT_SCAN_MS) {
+            merge_sweep_sources(now_ms);
+            last_scan_ms = now_ms;
+        }
+
+        if (woken) {
+            mod_proto_metrics_record_wakeup(packets, (uint32_t)(esp_timer_get_time() - t0), budget_hit);
+        }
+    }
+
+    if (running) proto_raw_stop();
+    if (igmp_sock >= 0) {
+        sacn_clear_socket();
+        close(igmp_sock);
+    }
+}
+#else
+/* Datagram handlers for the drain loop */
+static void handle_artnet(const uint8_t *buf, ssize_t len, const struct sockaddr_in *src)
+{
+    uint16_t universe = 0, dmx_len = 0;
+    const uint8_t *dmx_ptr = NULL;
+    if (parse_artnet_packet(buf, len, &universe, &dmx_ptr, &dmx_len) > 0) {
+        uint32_t sid = merge_source_id(PROTOCOL_ARTNET, buf, universe, src->sin_addr.s_addr);
+        if (sid) merge_input(PROTOCOL_ARTNET, universe, dmx_ptr, dmx_len, 0 /* priority for Art-Net */, sid, artnet_sequence(buf));
+    }
+}
+
+static void handle_sacn(const uint8_t *buf, ssize_t len, const struct sockaddr_in *src)
+{
+    uint16_t universe = 0, dmx_len = 0;
+    const uint8_t *dmx_ptr = NULL;
+    uint8_t priority = 0, start_code = 0;
+    if (parse_sacn_frame(buf, len, &universe, &start_code, &dmx_ptr, &dmx_len, &priority) > 0) {
+        merge_input_sacn(buf, universe, start_code, dmx_ptr, dmx_len, priority, src->sin_addr.s_addr);
+    }
+}
+
+/* Header peeking on the socket path. A peek saves copying the payload of
+ * a datagram for an unrouted universe, but costs every routed one a second
+ * recvfrom(), so it runs only while the traffic carries unrouted universes:
+ * each window of RX_PEEK_WINDOW datagrams decides for the next. With
+ * peeking off, datagrams are read whole and pre-filtered after the copy,
+ * which keeps the filtered count, and so the decision, current. */
+#define RX_PEEK_WINDOW 64
+
+typedef struct {
+    uint16_t seen;          // Datagrams in the current window
+    uint16_t filtered;      // ...for universes no port outputs
+    bool peek;              // Peek headers during this window
+} rx_peek_t;
+
+static void rx_peek_account(rx_peek_t *pk, bool filtered)
+{
+    pk->filtered += filtered;
+    if (++pk->seen < RX_PEEK_WINDOW) return;
+    pk->peek = pk->filtered > 0;
+    pk->seen = 0;
+    pk->filtered = 0;
+}
+
+/**
+ * @brief Receive one datagram from a non-blocking socket and dispatch it
+ *
+ * While @p pk is peeking, the header is read first and a datagram for a
+ * universe no port outputs is dequeued without copying its payload;
+ * otherwise the datagram is read once and filtered in the buffer.
+ *
+ * @return 1 if a datagram was handled or filtered, 0 if the socket is
+ *         drained (EAGAIN) or failed
+ */
+static int drain_one(int sock, uint8_t protocol, size_t peek_len, rx_peek_t *pk,
+                     uint8_t *rxbuf, size_t rxsize,
+                     void (*handle)(const uint8_t *, ssize_t, const struct sockaddr_in *))
+{
+    bool peeked = pk->peek;
+    ssize_t len;
+    if (peeked) {
+        len = recvfrom(sock, rxbuf, peek_len, MSG_PEEK, NULL, NULL);
+        if (len < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) mod_proto_metrics_inc_socket_error();
+            return 0;
+        }
+        if (!merge_prefilter(protocol, rxbuf, (size_t)len)) {
+            /* UDP: a short read dequeues the datagram and drops the rest */
+            recv(sock, rxbuf, 1, 0);
+            rx_peek_account(pk, true);
+            return 1;
+        }
+    }
+
+    struct sockaddr_in src;
+    socklen_t sl = sizeof(src);
+    len = recvfrom(sock, rxbuf, rxsize, 0, (struct sockaddr*)&src, &sl);
+    if (len < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) mod_proto_metrics_inc_socket_error();
+        return 0;
+    }
+    bool pass = peeked || merge_prefilter(protocol, rxbuf, (size_t)len);
+    rx_peek_account(pk, !pass);
+    if (pass && len > 0) handle(rxbuf, len, &src);
+    return 1;
+}
+
+/* Socket ingest: select() on both ports and drain them in this task */
+static void proto_rx_loop(void)
 {
-    ESP_LOGI(TAG, "proto_task started");
     int artnet_sock = make_udp_socket(NULL, ARTNET_PORT);
     int sacn_sock = make_udp_socket(NULL, SACN_PORT);
 
@@ -76,6 +225,8 @@ static void proto_task(void *arg)
     if (sacn_sock >= 0) sacn_apply_memberships_for_socket(sacn_sock);
 
     uint8_t rxbuf[RX_BUFFER_SIZE];
+    uint64_t last_scan_ms = 0;
+    rx_peek_t artnet_peek = {0}, sacn_peek = {0};
 
     while (!s_task_stop) {
         fd_set read_fds;
@@ -86,40 +237,45 @@ static void proto_task(void *arg)
 
         struct timeval timeout;
         timeout.tv_sec = 0;
-        timeout.tv_usec = 100 * 1000; /* 100 ms */
+        timeout.tv_usec = proto_wait_ms((uint64_t)esp_timer_get_time() / 1000ULL) * 1000;
 
         int ret = select(maxfd + 1, &read_fds, NULL, NULL, &timeout);
-        uint64_t now_ms = esp_timer_get_time() / 1000ULL;
-        merge_check_timeout_ms(now_ms);
+        int64_t t0 = esp_timer_get_time();
 
+        /* Drain every ready socket until EAGAIN, alternating between them so
+         * a flood on one protocol cannot starve the other, and stop at the
+         * batch budget to bound the time spent away from select(). */
+        uint32_t packets = 0;
+        bool budget_hit = false;
         if (ret > 0) {
-            if (artnet_sock >= 0 && FD_ISSET(artnet_sock, &read_fds)) {
-                struct sockaddr_in src;
-                socklen_t sl = sizeof(src);
-                ssize_t len = recvfrom(artnet_sock, rxbuf, sizeof(rxbuf), 0, (struct sockaddr*)&src, &sl);
-                if (len > 0) {
-                    uint16_t universe = 0, dmx_len = 0;
-                    const uint8_t *dmx_ptr = NULL;
-                    if (parse_artnet_packet(rxbuf, len, &universe, &dmx_ptr, &dmx_len) > 0) {
-                        merge_input_by_universe(universe, dmx_ptr, dmx_len, 0 /* priority for Art-Net */, src.sin_addr.s_addr);
-                    }
+            bool artnet_ready = artnet_sock >= 0 && FD_ISSET(artnet_sock, &read_fds);
+            bool sacn_ready = sacn_sock >= 0 && FD_ISSET(sacn_sock, &read_fds);
+            while (artnet_ready || sacn_ready) {
+                if (packets >= CONFIG_MODPROTO_RX_BATCH_MAX) {
+                    budget_hit = true;
+                    break;
                 }
-            }
-
-            if (sacn_sock >= 0 && FD_ISSET(sacn_sock, &read_fds)) {
-                struct sockaddr_in src;
-                socklen_t sl = sizeof(src);
-                ssize_t len = recvfrom(sacn_sock, rxbuf, sizeof(rxbuf), 0, (struct sockaddr*)&src, &sl);
-                if (len > 0) {
-                    uint16_t universe = 0, dmx_len = 0;
-                    const uint8_t *dmx_ptr = NULL;
-                    uint8_t priority = 0;
-                    if (parse_sacn_packet(rxbuf, len, &universe, &dmx_ptr, &dmx_len, &priority) > 0) {
-                        merge_input_by_universe(universe, dmx_ptr, dmx_len, priority, src.sin_addr.s_addr);
-                    }
+                if (artnet_ready) {
+                    if (drain_one(artnet_sock, PROTOCOL_ARTNET, ARTNET_PEEK_LEN, &artnet_peek, rxbuf, sizeof(rxbuf), handle_artnet)) packets++;
+                    else artnet_ready = false;
+                }
+                if (sacn_ready) {
+                    if (drain_one(sacn_sock, PROTOCOL_SACN, SACN_PEEK_LEN, &sacn_peek, rxbuf, sizeof(rxbuf), handle_sacn)) packets++;
+                    else sacn_ready = false;
                 }
             }
         }
+
+        uint64_t now_ms = (uint64_t)esp_timer_get_time() / 1000ULL;
+        merge_check_timeout_ms(now_ms);     /* O(1) until a loss deadline is due */
+        if (now_ms - last_scan_ms >= PROTO_TIMEOUT_SCAN_MS) {
+            merge_sweep_sources(now_ms);
+            last_scan_ms = now_ms;
+        }
+
+        if (ret > 0) {
+            mod_proto_metrics_record_wakeup(packets, (uint32_t)(esp_timer_get_time() - t0), budget_hit);
+        }
     }
 
     if (artnet_sock >= 0) close(artnet_sock);
@@ -128,7 +284,13 @@ static void proto_task(void *arg)
         sacn_clear_socket();
         close(sacn_sock);
     }
+}
+#endif
 
+static void proto_task(void *arg)
+{
+    ESP_LOGI(TAG, "proto_task started");
+    proto_rx_loop();
     ESP_LOGI(TAG, "proto_task exiting");
     s_proto_task = NULL;
     vTaskDelete(NULL);
@@ -0,0 +1,229 @@
+/**
+ * @file proto_raw.c
+ * @brief Art-Net / sACN ingest through the lwIP raw UDP API
+ *
+ * Enabled by CONFIG_MODPROTO_RAW_UDP. udp_recv() callbacks on 6454/5568 run
+ * in the tcpip thread: they copy the packet up to its last DMX slot into a
+ * preallocated queue cell, free the pbuf, parse the copy and hand it to
+ * proto_task through a lock-free SPSC queue. No socket mailbox hop, and
+ * since no pbuf outlives the callback a burst can never hold on to the
+ * Wi-Fi driver's RX buffers.
+ *
+ * sACN multicast memberships are still managed through a socket (bound to
+ * an ephemeral port): IGMP membership is per interface, so the raw PCB on
+ * 5568 receives the joined groups.
+ */
+
+#include "sdkconfig.h"
+#include "mod_proto.h"
+#include "sys_mod.h"
+
+#if CONFIG_MODPROTO_RAW_UDP
+
+#include "proto_rxq.h"
+#include "proto_types.h"
+#include <string.h>
+#include <sys/types.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/tcpip.h"
+
+static const char *TAG = "mod_proto.raw";
+
+#define ARTNET_PORT 6454
+#define SACN_PORT 5568
+
+enum { RAW_ARTNET = 1, RAW_SACN = 2 };
+
+/* Parsers and merge (this component) */
+int merge_input(uint8_t protocol, uint16_t universe, const uint8_t *data, size_t len, uint8_t priority,
+                uint32_t src_id, int seq);
+int parse_artnet_packet(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, const uint8_t **out_data, uint16_t *out_len);
+int parse_sacn_frame(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, uint8_t *out_start_code,
+                     const uint8_t **out_data, uint16_t *out_len, uint8_t *out_priority);
+
+static struct udp_pcb *s_pcb_artnet = NULL;
+static struct udp_pcb *s_pcb_sacn = NULL;
+static proto_rxq_t s_rxq;
+static TaskHandle_t s_consumer = NULL;
+
+/* Producer-side counters: written by the tcpip thread only */
+static mod_proto_raw_stats_t s_stats;
+
+/* tcpip thread */
+static void raw_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    (void)pcb;
+    (void)port;
+    int64_t t0 = esp_timer_get_time();
+    int proto = (int)(uintptr_t)arg;
+
+    /* Unrouted universe: drop before copying or parsing */
+    if (!merge_prefilter(proto == RAW_SACN ? PROTOCOL_SACN : PROTOCOL_ARTNET, p->payload, p->len)) {
+        pbuf_free(p);
+        return;
+    }
+
+    proto_rx_item_t *item = proto_rxq_reserve(&s_rxq);
+    if (!item) {
+        s_stats.drops_full++;
+        pbuf_free(p);
+        return;
+    }
+
+    /* A valid packet fits a cell; a longer one keeps its first
+     * PROTO_RX_PKT_MAX bytes and fails the parser's length checks. Chained
+     * pbufs are gathered by the same copy. */
+    if (p->next) s_stats.chained++;
+    uint16_t pkt_len = pbuf_copy_partial(p, item->pkt, PROTO_RX_PKT_MAX, 0);
+    item->src_ip = ip4_addr_get_u32(ip_2_ip4(addr));
+    pbuf_free(p);
+
+    const uint8_t *data = NULL;
+    int ok;
+    item->protocol = (proto == RAW_SACN) ? PROTOCOL_SACN : PROTOCOL_ARTNET;
+    item->priority = 0;
+    item->start_code = 0;
+    if (proto == RAW_SACN) {
+        ok = parse_sacn_frame(item->pkt, pkt_len, &item->universe, &item->start_code, &data, &item->len, &item->priority);
+        if (ok > 0 && item->start_code != SACN_START_CODE_DMX && item->start_code != SACN_START_CODE_PRIORITY) ok = 0;
+    } else {
+        ok = parse_artnet_packet(item->pkt, pkt_len, &item->universe, &data, &item->len);
+    }
+
+    if (ok > 0) {
+        item->pkt_len = pkt_len;
+        item->data_off = (uint16_t)(data - item->pkt);
+        proto_rxq_commit(&s_rxq);
+        s_stats.packets++;
+        if (s_consumer) xTaskNotifyGive(s_consumer);
+    }
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    s_stats.cb_us_total += us;
+    if (us > s_stats.cb_max_us) s_stats.cb_max_us = us;
+}
+
+typedef struct {
+    bool bind;
+    err_t err;
+    SemaphoreHandle_t done;
+} raw_call_t;
+
+static struct udp_pcb *raw_open(u16_t port, int proto)
+{
+    struct udp_pcb *pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    if (!pcb) return NULL;
+    if (udp_bind(pcb, IP4_ADDR_ANY, port) != ERR_OK) {
+        udp_remove(pcb);
+        return NULL;
+    }
+    udp_recv(pcb, raw_recv, (void *)(uintptr_t)proto);
+    return pcb;
+}
+
+/* tcpip thread: create or remove both PCBs */
+static void raw_call_fn(void *arg)
+{
+    raw_call_t *c = (raw_call_t *)arg;
+    if (c->bind) {
+        s_pcb_artnet = raw_open(ARTNET_PORT, RAW_ARTNET);
+        s_pcb_sacn = raw_open(SACN_PORT, RAW_SACN);
+        c->err = (s_pcb_artnet && s_pcb_sacn) ? ERR_OK : ERR_USE;
+    } else {
+        if (s_pcb_artnet) udp_remove(s_pcb_artnet);
+        if (s_pcb_sacn) udp_remove(s_pcb_sacn);
+        s_pcb_artnet = NULL;
+        s_pcb_sacn = NULL;
+        c->err = ERR_OK;
+    }
+    xSemaphoreGive(c->done);
+}
+
+/* Run raw_call_fn() in the tcpip thread and wait for it */
+static err_t raw_call(bool bind)
+{
+    StaticSemaphore_t done_buf;
+    raw_call_t c = { .bind = bind, .err = ERR_OK, .done = xSemaphoreCreateBinaryStatic(&done_buf) };
+    err_t err = tcpip_callback(raw_call_fn, &c);
+    if (err == ERR_OK) {
+        xSemaphoreTake(c.done, portMAX_DELAY);
+        err = c.err;
+    }
+    vSemaphoreDelete(c.done);
+    return err;
+}
+
+esp_err_t proto_raw_start(TaskHandle_t consumer)
+{
+    proto_rxq_init(&s_rxq);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_consumer = consumer;
+
+    err_t err = raw_call(true);
+    if (err != ERR_OK) {
+        ESP_LOGE(TAG, "Failed to bind raw UDP PCBs: %d", err);
+        raw_call(false);
+        mod_proto_metrics_inc_socket_error();
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Raw UDP ingest on %d/%d", ARTNET_PORT, SACN_PORT);
+    return ESP_OK;
+}
+
+/* proto_task: merge queued packets in place from their queue cells */
+uint32_t proto_raw_drain(uint32_t budget, bool *budget_hit)
+{
+    uint32_t n = 0;
+    const proto_rx_item_t *item;
+    *budget_hit = false;
+    while ((item = proto_rxq_front(&s_rxq)) != NULL) {
+        const uint8_t *data = item->pkt + item->data_off;
+        if (item->protocol == PROTOCOL_SACN) {
+            merge_input_sacn(item->pkt, item->universe, item->start_code, data, item->len, item->priority, item->src_ip);
+        } else {
+            /* 0: source table full, counted as sources_rejected */
+            uint32_t sid = merge_source_id(PROTOCOL_ARTNET, item->pkt, item->universe, item->src_ip);
+            if (sid) merge_input(PROTOCOL_ARTNET, item->universe, data, item->len, 0, sid, artnet_sequence(item->pkt));
+        }
+        proto_rxq_release(&s_rxq);
+        if (++n >= budget) {
+            *budget_hit = proto_rxq_count(&s_rxq) > 0;
+            break;
+        }
+    }
+    return n;
+}
+
+void proto_raw_stop(void)
+{
+    raw_call(false);
+    s_consumer = NULL;
+
+    /* Callbacks are gone: drop whatever is still queued */
+    proto_rxq_init(&s_rxq);
+}
+
+void mod_proto_get_raw_stats(mod_proto_raw_stats_t *out)
+{
+    if (!out) return;
+    *out = s_stats;
+    out->enabled = true;
+    out->queued = proto_rxq_count(&s_rxq);
+}
+
+#else /* !CONFIG_MODPROTO_RAW_UDP */
+
+#include <string.h>
+
+void mod_proto_get_raw_stats(mod_proto_raw_stats_t *out)
+{
+    if (out) memset(out, 0, sizeof(*out));
+}
+
+#endif /* CONFIG_MODPROTO_RAW_UDP */
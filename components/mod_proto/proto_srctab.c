@@ -0,0 +1,149 @@
+#include "proto_srctab.h"
+#include <string.h>
+
+/*
+ * Linear probing with backward-shift deletion: no tombstones, so lookups
+ * stop at the first empty slot however many sources have come and gone.
+ */
+
+#define SRCTAB_RATE_WINDOW_MS 1000u
+
+static inline uint32_t srctab_hash(uint8_t protocol, const uint8_t *key)
+{
+    uint32_t w[PROTO_SRC_KEY_LEN / 4];
+    memcpy(w, key, sizeof(w));
+    uint32_t h = (w[0] ^ w[1] ^ w[2] ^ w[3] ^ protocol) * 2654435761u;   /* Fibonacci hash */
+    return h >> (32 - __builtin_ctz(PROTO_SRCTAB_SLOTS));
+}
+
+static inline void srctab_write_begin(proto_srctab_t *t)
+{
+    __atomic_store_n(&t->seq, t->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void srctab_write_end(proto_srctab_t *t)
+{
+    __atomic_store_n(&t->seq, t->seq + 1, __ATOMIC_RELEASE);
+}
+
+void proto_srctab_init(proto_srctab_t *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->next_sid = 1;
+}
+
+uint32_t proto_srctab_touch(proto_srctab_t *t, uint8_t protocol, const uint8_t *key, uint32_t src_ip,
+                            uint16_t universe, const char *name, uint32_t now_ms)
+{
+    uint32_t i = srctab_hash(protocol, key);
+    for (;;) {
+        proto_src_entry_t *e = &t->slots[i];
+        if (e->sid == 0) break;
+        if (e->protocol == protocol && memcmp(e->key, key, PROTO_SRC_KEY_LEN) == 0) {
+            e->last_seen_ms = now_ms;
+            e->src_ip = src_ip;
+            e->universe = universe;
+            e->packets++;
+            return e->sid;
+        }
+        i = (i + 1) & (PROTO_SRCTAB_SLOTS - 1);
+    }
+
+    if (t->count >= PROTO_SRCTAB_MAX_LIVE) return 0;
+
+    proto_src_entry_t *e = &t->slots[i];
+    srctab_write_begin(t);
+    memcpy(e->key, key, PROTO_SRC_KEY_LEN);
+    e->protocol = protocol;
+    e->universe = universe;
+    e->src_ip = src_ip;
+    e->first_seen_ms = now_ms;
+    e->last_seen_ms = now_ms;
+    e->packets = 1;
+    e->rate_pps = 0;
+    e->window_packets = 0;
+    e->window_start_ms = now_ms;
+    e->seq_lost = 0;
+    e->seq_reordered = 0;
+    e->seq_duplicate = 0;
+    e->name[0] = '\0';
+    if (name) {
+        /* sACN names are NUL-padded but not always NUL-terminated */
+        size_t n = strnlen(name, PROTO_SRC_NAME_LEN - 1);
+        memcpy(e->name, name, n);
+        e->name[n] = '\0';
+    }
+    e->sid = t->next_sid++;
+    if (t->next_sid == 0) t->next_sid = 1;
+    t->count++;
+    srctab_write_end(t);
+    return e->sid;
+}
+
+void proto_srctab_note_seq(proto_srctab_t *t, uint32_t sid, uint32_t lost, uint32_t reordered, uint32_t duplicate)
+{
+    for (uint32_t i = 0; i < PROTO_SRCTAB_SLOTS; ++i) {
+        proto_src_entry_t *e = &t->slots[i];
+        if (e->sid != sid) continue;
+        e->seq_lost += lost;
+        e->seq_reordered += reordered;
+        e->seq_duplicate += duplicate;
+        return;
+    }
+}
+
+/* Empty slot i and pull later entries of its probe chain back over it */
+static void srctab_remove(proto_srctab_t *t, uint32_t i)
+{
+    const uint32_t mask = PROTO_SRCTAB_SLOTS - 1;
+    uint32_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        proto_src_entry_t *e = &t->slots[j];
+        if (e->sid == 0) break;
+        uint32_t home = srctab_hash(e->protocol, e->key);
+        /* Move e only if its home slot is not cyclically within (i, j] */
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            t->slots[i] = *e;
+            i = j;
+        }
+    }
+    t->slots[i].sid = 0;
+    t->count--;
+}
+
+void proto_srctab_sweep(proto_srctab_t *t, uint32_t now_ms, uint32_t idle_ms)
+{
+    for (uint32_t i = 0; i < PROTO_SRCTAB_SLOTS; ) {
+        proto_src_entry_t *e = &t->slots[i];
+        if (e->sid == 0) { ++i; continue; }
+        if (now_ms - e->last_seen_ms > idle_ms) {
+            srctab_write_begin(t);
+            srctab_remove(t, i);
+            srctab_write_end(t);
+            continue;   /* slot i may now hold a shifted entry */
+        }
+        uint32_t elapsed = now_ms - e->window_start_ms;
+        if (elapsed >= SRCTAB_RATE_WINDOW_MS) {
+            e->rate_pps = (uint32_t)(((uint64_t)(e->packets - e->window_packets) * 1000u) / elapsed);
+            e->window_packets = e->packets;
+            e->window_start_ms = now_ms;
+        }
+        ++i;
+    }
+}
+
+bool proto_srctab_snapshot(const proto_srctab_t *t, proto_src_entry_t *out, size_t max, size_t *out_n)
+{
+    uint32_t seq = __atomic_load_n(&t->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) return false;
+    size_t n = 0;
+    for (uint32_t i = 0; i < PROTO_SRCTAB_SLOTS && n < max; ++i) {
+        if (t->slots[i].sid != 0) out[n++] = t->slots[i];
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&t->seq, __ATOMIC_RELAXED) != seq) return false;
+    *out_n = n;
+    return true;
+}
@@ -8,6 +8,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "mod_proto.h" // metrics API
+#include "proto_types.h"
 
 static const char *TAG = "mod_proto.sacn";
 
@@ -78,9 +79,13 @@ static esp_err_t sacn_socket_leave(int sock, uint16_t uni)
 /* Minimal sACN (E1.31) parser based on the struct in design docs
  * - Verifies "ASC-E1.17" at root layer offset 4
  * - Extracts universe from framing layer (big-endian) at offset 113
- * - Extracts DMP prop_val_count at offset 123..124 and data at offset 125
+ * - Extracts DMP prop_val_count at offset 123..124, start code at 125 and
+ *   slot data from 126
+ * Returns 1 for any start code: 0x00 carries levels, 0xDD per-channel
+ * priorities.
  */
-int parse_sacn_packet(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, const uint8_t **out_data, uint16_t *out_len, uint8_t *out_priority)
+int parse_sacn_frame(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, uint8_t *out_start_code,
+                     const uint8_t **out_data, uint16_t *out_len, uint8_t *out_priority)
 {
     if (buflen < 126) return 0;
 
@@ -105,12 +110,51 @@ int parse_sacn_packet(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe
     if (dlen > 512) dlen = 512;
 
     *out_universe = universe;
+    *out_start_code = data[0];
     *out_data = data + 1; /* skip start code */
     *out_len = dlen;
     *out_priority = priority;
     return 1;
 }
 
+/* DMX levels only (start code 0x00); other start codes are ignored */
+int parse_sacn_packet(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, const uint8_t **out_data, uint16_t *out_len, uint8_t *out_priority)
+{
+    uint8_t start_code;
+    if (parse_sacn_frame(buf, buflen, out_universe, &start_code, out_data, out_len, out_priority) <= 0) return 0;
+    return start_code == SACN_START_CODE_DMX ? 1 : 0;
+}
+
+/* Root layer CID at offset 22 (16 bytes), framing layer source name at 44
+ * (64 bytes, UTF-8, NUL-padded). Only for frames parse_sacn_frame() accepted. */
+void sacn_source_info(const uint8_t *pkt, uint8_t *out_cid, const char **out_name)
+{
+    memcpy(out_cid, &pkt[22], 16);
+    *out_name = (const char *)&pkt[44];
+}
+
+/* Framing layer sequence number at offset 111 */
+uint8_t sacn_sequence(const uint8_t *pkt)
+{
+    return pkt[111];
+}
+
+/* Framing layer Options at offset 112 */
+uint8_t sacn_options(const uint8_t *pkt)
+{
+    return pkt[112];
+}
+
+/* Header-only check for the receive pre-filter: needs SACN_PEEK_LEN bytes.
+ * Returns 1 with the framing-layer universe, 0 if the header is not sACN. */
+int sacn_peek_universe(const uint8_t *hdr, size_t len, uint16_t *out_universe)
+{
+    if (len < SACN_PEEK_LEN) return 0;
+    if (memcmp(&hdr[4], "ASC-E1.17", 8) != 0) return 0;
+    *out_universe = (uint16_t)hdr[113] << 8 | (uint16_t)hdr[114];
+    return 1;
+}
+
 /* sACN IGMP join helper: compute multicast IP 239.255.u.u and join on a socket
  * NOTE: For simplicity this function only logs the target and returns OK. Implementing
  * actual join requires access to the sACN socket used by proto_mgr; that can be added
@@ -1,9 +1,22 @@
 #include "unity.h"
+#include "test_bench.h"
 #include "mod_proto.h"
 #include "proto_types.h"
+#include "proto_rxq.h"
+#include "merge_kernel.h"
+#include "proto_srctab.h"
+#include "esp_timer.h"
+#include <stdio.h>
 
 /* sacn helpers (internal) used by tests */
 extern size_t sacn_get_joined_universes(uint16_t *out, size_t max);
+/* merge.c / sacn.c (internal) */
+extern void merge_check_timeout_ms(uint64_t now_ms);
+extern int merge_input(uint8_t protocol, uint16_t universe, const uint8_t *data, size_t len, uint8_t priority,
+                       uint32_t src_id, int seq);
+extern int merge_input_priority(uint16_t universe, const uint8_t *prio, size_t len, uint32_t src_id, int seq);
+extern int parse_sacn_frame(const uint8_t *buf, ssize_t buflen, uint16_t *out_universe, uint8_t *out_start_code,
+                            const uint8_t **out_data, uint16_t *out_len, uint8_t *out_priority);
 
 
 /* Minimal unit tests for parsers and merge logic */
@@ -138,6 +151,504 @@ void test_sacn_malformed_prop_val_count(void)
     TEST_ASSERT_EQUAL_UINT32(before.malformed_sacn_packets + 1, after.malformed_sacn_packets);
 }
 
+void test_rx_hist_buckets(void)
+{
+    mod_proto_reset_rx_hist();
+    mod_proto_metrics_record_wakeup(0, 10, false);     /* batch 0, <50us */
+    mod_proto_metrics_record_wakeup(1, 50, false);     /* batch 1, 50-99us */
+    mod_proto_metrics_record_wakeup(5, 120, false);    /* batch 4-7, 100-199us */
+    mod_proto_metrics_record_wakeup(32, 900000, true); /* batch 32-63, open bucket */
+
+    mod_proto_rx_hist_t h;
+    mod_proto_get_rx_hist(&h);
+    TEST_ASSERT_EQUAL_UINT32(4, h.wakeups);
+    TEST_ASSERT_EQUAL_UINT32(38, h.packets);
+    TEST_ASSERT_EQUAL_UINT32(1, h.batch[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.batch[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.batch[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.batch[6]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.proc_us[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.proc_us[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.proc_us[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.proc_us[PROTO_HIST_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL_UINT32(32, h.batch_max);
+    TEST_ASSERT_EQUAL_UINT32(900000, h.proc_max_us);
+    TEST_ASSERT_EQUAL_UINT32(1, h.budget_hits);
+}
+
+void test_rxq_spsc(void)
+{
+    static proto_rxq_t q;
+    proto_rxq_init(&q);
+    proto_rx_item_t in = {0}, out;
+    TEST_ASSERT_FALSE(proto_rxq_pop(&q, &out));
+
+    /* Fill, overflow, drain in order; indices wrap past the ring size */
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < PROTO_RXQ_SIZE; ++i) {
+            in.universe = (uint16_t)i;
+            TEST_ASSERT_TRUE(proto_rxq_push(&q, &in));
+        }
+        TEST_ASSERT_FALSE(proto_rxq_push(&q, &in));
+        TEST_ASSERT_EQUAL_UINT32(PROTO_RXQ_SIZE, proto_rxq_count(&q));
+        for (int i = 0; i < PROTO_RXQ_SIZE; ++i) {
+            TEST_ASSERT_TRUE(proto_rxq_pop(&q, &out));
+            TEST_ASSERT_EQUAL_UINT16(i, out.universe);
+        }
+        TEST_ASSERT_FALSE(proto_rxq_pop(&q, &out));
+    }
+}
+
+void test_header_prefilter(void)
+{
+    uint8_t art[ARTNET_PEEK_LEN];
+    memset(art, 0, sizeof(art));
+    memcpy(art, "Art-Net", 7);
+    art[8] = 0x00; art[9] = 0x50;          /* ArtDmx */
+    art[14] = 0x34; art[15] = 0x12;        /* SubUni, Net */
+
+    uint16_t uni = 0;
+    TEST_ASSERT_EQUAL_INT(1, artnet_peek_universe(art, sizeof(art), &uni));
+    TEST_ASSERT_EQUAL_HEX16(0x1234, uni);
+    TEST_ASSERT_EQUAL_INT(0, artnet_peek_universe(art, sizeof(art) - 1, &uni));
+    art[9] = 0x20;                         /* ArtPoll: left to the full parser */
+    TEST_ASSERT_EQUAL_INT(0, artnet_peek_universe(art, sizeof(art), &uni));
+    art[9] = 0x50;
+
+    uint8_t sacn[SACN_PEEK_LEN];
+    memset(sacn, 0, sizeof(sacn));
+    memcpy(&sacn[4], "ASC-E1.17", 9);
+    sacn[113] = 0x00; sacn[114] = 0x07;
+    TEST_ASSERT_EQUAL_INT(1, sacn_peek_universe(sacn, sizeof(sacn), &uni));
+    TEST_ASSERT_EQUAL_UINT16(7, uni);
+
+    /* Default config routes universes 0-3 only */
+    mod_proto_metrics_t before, after;
+    mod_proto_get_metrics(&before);
+    TEST_ASSERT_FALSE(merge_prefilter(PROTOCOL_ARTNET, art, sizeof(art)));
+    art[14] = 0x02; art[15] = 0x00;
+    TEST_ASSERT_TRUE(merge_prefilter(PROTOCOL_ARTNET, art, sizeof(art)));
+    mod_proto_get_metrics(&after);
+    TEST_ASSERT_EQUAL_UINT32(before.rx_filtered + 1, after.rx_filtered);
+    TEST_ASSERT_EQUAL_UINT32(before.rx_accepted + 1, after.rx_accepted);
+}
+
+void test_merge_n_sources(void)
+{
+    merge_init();
+    mod_proto_set_merge_mode(0, MERGE_MODE_HTP);
+    uint8_t d[DMX_UNIVERSE_SIZE];
+    uint8_t *out = sys_get_dmx_buffer(0);
+    TEST_ASSERT_NOT_NULL(out);
+
+    /* Three consoles at the same priority: HTP across all of them */
+    for (int s = 0; s < 3; ++s) {
+        memset(d, 0, sizeof(d));
+        d[s] = (uint8_t)(10 * (s + 1));
+        merge_input_by_universe(0, d, DMX_UNIVERSE_SIZE, 100, 0x0A000001 + s);
+    }
+    TEST_ASSERT_EQUAL_HEX8(10, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(20, out[1]);
+    TEST_ASSERT_EQUAL_HEX8(30, out[2]);
+
+    /* A backup at lower priority is tracked but does not touch the output */
+    memset(d, 0xFF, sizeof(d));
+    merge_input_by_universe(0, d, DMX_UNIVERSE_SIZE, 50, 0x0A000010);
+    TEST_ASSERT_EQUAL_HEX8(10, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0, out[3]);
+
+    /* Table full: further sources are refused, none is evicted */
+    mod_proto_metrics_t before, after;
+    mod_proto_get_metrics(&before);
+    for (int s = 5; s <= MERGE_MAX_SOURCES; ++s) {   /* four in use */
+        merge_input_by_universe(0, d, DMX_UNIVERSE_SIZE, 10, 0x0A000020 + s);
+    }
+    merge_input_by_universe(0, d, DMX_UNIVERSE_SIZE, 200, 0x0A0000FF);
+    mod_proto_get_metrics(&after);
+    TEST_ASSERT_EQUAL_UINT32(before.sources_rejected + 1, after.sources_rejected);
+    TEST_ASSERT_EQUAL_HEX8(10, out[0]);
+
+    /* Everything times out and returns to the pool; a newcomer is accepted */
+    uint64_t now_ms = (uint64_t)esp_timer_get_time() / 1000ULL;
+    merge_check_timeout_ms(now_ms + 1);
+    TEST_ASSERT_EQUAL_HEX8(10, out[0]);
+    merge_check_timeout_ms(now_ms + PROTO_STREAM_TIMEOUT_MS + 1);
+    TEST_ASSERT_EQUAL_HEX8(0, out[0]);
+    merge_input_by_universe(0, d, DMX_UNIVERSE_SIZE, 10, 0x0A0000FF);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, out[0]);
+}
+
+void test_sacn_start_codes(void)
+{
+    uint8_t buf[256];
+    memset(buf, 0, sizeof(buf));
+    memcpy(&buf[4], "ASC-E1.17", 9);
+    buf[110] = 100;
+    buf[113] = 0x00; buf[114] = 0x01;
+    buf[123] = 0x00; buf[124] = 0x03;      /* start code + 2 slots */
+    buf[125] = SACN_START_CODE_PRIORITY;
+    buf[126] = 150; buf[127] = 0;
+
+    uint16_t uni = 0, dlen = 0; const uint8_t *data = NULL; uint8_t priority = 0, sc = 0;
+    TEST_ASSERT_EQUAL_INT(1, parse_sacn_frame(buf, sizeof(buf), &uni, &sc, &data, &dlen, &priority));
+    TEST_ASSERT_EQUAL_HEX8(SACN_START_CODE_PRIORITY, sc);
+    TEST_ASSERT_EQUAL_UINT16(2, dlen);
+    TEST_ASSERT_EQUAL_UINT8(150, data[0]);
+    /* Levels-only parser must not treat priorities as levels */
+    TEST_ASSERT_EQUAL_INT(0, parse_sacn_packet(buf, sizeof(buf), &uni, &data, &dlen, &priority));
+}
+
+void test_merge_per_channel_priority(void)
+{
+    merge_init();
+    mod_proto_set_merge_mode(0, MERGE_MODE_HTP);
+    uint8_t *out = sys_get_dmx_buffer(0);
+    TEST_ASSERT_NOT_NULL(out);
+
+    /* Two sources at the same universe priority, levels everywhere */
+    uint8_t a[DMX_UNIVERSE_SIZE], b[DMX_UNIVERSE_SIZE];
+    memset(a, 0x40, sizeof(a));
+    memset(b, 0x80, sizeof(b));
+    merge_input_by_universe(0, a, DMX_UNIVERSE_SIZE, 100, 0x01000001);
+    merge_input_by_universe(0, b, DMX_UNIVERSE_SIZE, 100, 0x02000002);
+    TEST_ASSERT_EQUAL_HEX8(0x80, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, out[300]);
+
+    /* A claims the first 256 channels at 150 and gives up the rest */
+    uint8_t pa[DMX_UNIVERSE_SIZE];
+    memset(pa, 0, sizeof(pa));
+    memset(pa, 150, 256);
+    merge_input_priority(0, pa, DMX_UNIVERSE_SIZE, 0x01000001, MERGE_SEQ_NONE);
+    TEST_ASSERT_EQUAL_HEX8(0x40, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x40, out[255]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, out[256]);
+
+    /* B lowers channel 300 below its universe priority: nobody else has it */
+    uint8_t pb[DMX_UNIVERSE_SIZE];
+    memset(pb, 100, sizeof(pb));
+    pb[300] = 1;
+    merge_input_priority(0, pb, DMX_UNIVERSE_SIZE, 0x02000002, MERGE_SEQ_NONE);
+    TEST_ASSERT_EQUAL_HEX8(0x80, out[300]);
+    TEST_ASSERT_EQUAL_HEX8(0x40, out[10]);
+
+    /* Sources time out with their planes; levels alone merge per universe */
+    uint64_t now_ms = (uint64_t)esp_timer_get_time() / 1000ULL;
+    merge_check_timeout_ms(now_ms + PROTO_STREAM_TIMEOUT_MS + 1);
+    merge_input_by_universe(0, a, DMX_UNIVERSE_SIZE, 100, 0x01000001);
+    merge_input_by_universe(0, b, DMX_UNIVERSE_SIZE, 100, 0x02000002);
+    TEST_ASSERT_EQUAL_HEX8(0x80, out[0]);
+}
+
+void test_source_table(void)
+{
+    static proto_srctab_t t;
+    proto_srctab_init(&t);
+    uint8_t k1[PROTO_SRC_KEY_LEN] = {1}, k2[PROTO_SRC_KEY_LEN] = {2};
+
+    /* One IP, two CIDs: two sources. One CID over two IPs: one source */
+    uint32_t a = proto_srctab_touch(&t, PROTOCOL_SACN, k1, 0x0A000001, 1, "A", 0);
+    uint32_t b = proto_srctab_touch(&t, PROTOCOL_SACN, k2, 0x0A000001, 1, "B", 0);
+    TEST_ASSERT_NOT_EQUAL(0, a);
+    TEST_ASSERT_NOT_EQUAL(0, b);
+    TEST_ASSERT_NOT_EQUAL(a, b);
+    TEST_ASSERT_EQUAL_UINT32(a, proto_srctab_touch(&t, PROTOCOL_SACN, k1, 0x0B000001, 1, NULL, 10));
+    /* Same key bytes under the other protocol are a different source */
+    TEST_ASSERT_NOT_EQUAL(a, proto_srctab_touch(&t, PROTOCOL_ARTNET, k1, 0x0A000001, 1, NULL, 10));
+
+    /* Unterminated 64-byte names are cut to fit */
+    char name[PROTO_SRC_NAME_LEN];
+    memset(name, 'x', sizeof(name));
+    uint8_t k3[PROTO_SRC_KEY_LEN] = {3};
+    proto_srctab_touch(&t, PROTOCOL_SACN, k3, 0x0A000003, 1, name, 10);
+
+    /* Fill up: the table refuses newcomers past its load limit */
+    uint8_t k[PROTO_SRC_KEY_LEN] = {0};
+    for (uint32_t i = 4; i < PROTO_SRCTAB_MAX_LIVE; ++i) {
+        memcpy(&k[4], &i, sizeof(i));
+        TEST_ASSERT_NOT_EQUAL(0, proto_srctab_touch(&t, PROTOCOL_ARTNET, k, i, 1, NULL, 10));
+    }
+    uint32_t extra = 0xFFFF;
+    memcpy(&k[4], &extra, sizeof(extra));
+    TEST_ASSERT_EQUAL_UINT32(0, proto_srctab_touch(&t, PROTOCOL_ARTNET, k, extra, 1, NULL, 10));
+
+    /* a keeps sending at 50 packets/s; everything else goes idle and leaves */
+    for (uint32_t ms = 20; ms <= 1000; ms += 20) proto_srctab_touch(&t, PROTOCOL_SACN, k1, 0x0B000001, 1, NULL, ms);
+    proto_srctab_sweep(&t, 1000, 500);
+    static proto_src_entry_t snap[PROTO_SRCTAB_MAX_LIVE];
+    size_t n = 0;
+    TEST_ASSERT_TRUE(proto_srctab_snapshot(&t, snap, PROTO_SRCTAB_MAX_LIVE, &n));
+    TEST_ASSERT_EQUAL_UINT32(1, n);
+    TEST_ASSERT_EQUAL_UINT32(a, snap[0].sid);
+    TEST_ASSERT_EQUAL_STRING("A", snap[0].name);
+    TEST_ASSERT_EQUAL_UINT32(0x0B000001, snap[0].src_ip);
+    TEST_ASSERT_EQUAL_UINT32(52, snap[0].rate_pps);   /* 50 plus the two at 0 and 10 ms */
+
+    /* Survivors stay reachable after removals reshuffle probe chains */
+    TEST_ASSERT_EQUAL_UINT32(a, proto_srctab_touch(&t, PROTOCOL_SACN, k1, 0x0B000001, 1, NULL, 1000));
+    uint32_t b2 = proto_srctab_touch(&t, PROTOCOL_SACN, k2, 0x0A000001, 1, "B", 1000);
+    TEST_ASSERT_NOT_EQUAL(b, b2);   /* ids are never reused */
+}
+
+void test_merge_sources_by_cid(void)
+{
+    merge_init();
+    mod_proto_set_merge_mode(0, MERGE_MODE_HTP);
+    uint8_t *out = sys_get_dmx_buffer(0);
+    TEST_ASSERT_NOT_NULL(out);
+
+    /* One media server, two sACN streams (two CIDs) from one IP */
+    uint8_t pkt[126];
+    memset(pkt, 0, sizeof(pkt));
+    memcpy(&pkt[4], "ASC-E1.17", 9);
+    uint8_t d1[DMX_UNIVERSE_SIZE] = {0}, d2[DMX_UNIVERSE_SIZE] = {0};
+    d1[0] = 0x10; d2[1] = 0x20;
+
+    pkt[22] = 0xA1;
+    uint32_t s1 = merge_source_id(PROTOCOL_SACN, pkt, 0, 0x0A000001);
+    pkt[22] = 0xA2;
+    uint32_t s2 = merge_source_id(PROTOCOL_SACN, pkt, 0, 0x0A000001);
+    TEST_ASSERT_NOT_EQUAL(s1, s2);
+    merge_input(PROTOCOL_SACN, 0, d1, DMX_UNIVERSE_SIZE, 100, s1, MERGE_SEQ_NONE);
+    merge_input(PROTOCOL_SACN, 0, d2, DMX_UNIVERSE_SIZE, 100, s2, MERGE_SEQ_NONE);
+    TEST_ASSERT_EQUAL_HEX8(0x10, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x20, out[1]);
+
+    /* Art-Net: the physical port tells two inputs of one node apart */
+    uint8_t art[18] = {0};
+    art[13] = 1;
+    uint32_t p1 = merge_source_id(PROTOCOL_ARTNET, art, 0, 0x0A000002);
+    art[13] = 2;
+    TEST_ASSERT_NOT_EQUAL(p1, merge_source_id(PROTOCOL_ARTNET, art, 0, 0x0A000002));
+
+    mod_proto_source_info_t info[MOD_PROTO_MAX_SOURCES];
+    TEST_ASSERT_EQUAL_UINT32(4, mod_proto_get_sources(info, MOD_PROTO_MAX_SOURCES));
+}
+
+void test_merge_sequence(void)
+{
+    merge_init();
+    mod_proto_set_merge_mode(0, MERGE_MODE_LTP);
+    uint8_t *out = sys_get_dmx_buffer(0);
+    TEST_ASSERT_NOT_NULL(out);
+    uint8_t d[DMX_UNIVERSE_SIZE] = {0};
+    mod_proto_seq_stats_t before, after;
+    mod_proto_get_port_seq_stats(0, &before);
+
+    /* In order, then a duplicate and a late packet: both dropped */
+    d[0] = 10; merge_input(PROTOCOL_SACN, 0, d, DMX_UNIVERSE_SIZE, 100, 0x51, 10);
+    d[0] = 11; merge_input(PROTOCOL_SACN, 0, d, DMX_UNIVERSE_SIZE, 100, 0x51, 11);
+    d[0] = 99; merge_input(PROTOCOL_SACN, 0, d, DMX_UNIVERSE_SIZE, 100, 0x51, 11);
+    d[0] = 9;  merge_input(PROTOCOL_SACN, 0, d, DMX_UNIVERSE_SIZE, 100, 0x51, 9);
+    TEST_ASSERT_EQUAL_HEX8(11, out[0]);
+
+    /* A gap is counted and accepted; 20 or more behind is a restart */
+    d[0] = 14; merge_input(PROTOCOL_SACN, 0, d, DMX_UNIVERSE_SIZE, 100, 0x51, 14);
+    TEST_ASSERT_EQUAL_HEX8(14, out[0]);
+    d[0] = 250; merge_input(PROTOCOL_SACN, 0, d, DMX_UNIVERSE_SIZE, 100, 0x51, (14 - 20) & 0xFF);
+    TEST_ASSERT_EQUAL_HEX8(250, out[0]);
+
+    mod_proto_get_port_seq_stats(0, &after);
+    TEST_ASSERT_EQUAL_UINT32(before.duplicate + 1, after.duplicate);
+    TEST_ASSERT_EQUAL_UINT32(before.reordered + 1, after.reordered);
+    TEST_ASSERT_EQUAL_UINT32(before.lost + 2, after.lost);
+
+    /* Art-Net: 255 wraps to 1 without a gap; 0 means "not sequenced" */
+    merge_init();
+    mod_proto_set_merge_mode(0, MERGE_MODE_LTP);
+    d[0] = 1; merge_input(PROTOCOL_ARTNET, 0, d, DMX_UNIVERSE_SIZE, 0, 0x52, 255);
+    d[0] = 2; merge_input(PROTOCOL_ARTNET, 0, d, DMX_UNIVERSE_SIZE, 0, 0x52, 1);
+    d[0] = 3; merge_input(PROTOCOL_ARTNET, 0, d, DMX_UNIVERSE_SIZE, 0, 0x52, 0);
+    d[0] = 4; merge_input(PROTOCOL_ARTNET, 0, d, DMX_UNIVERSE_SIZE, 0, 0x52, 0);
+    TEST_ASSERT_EQUAL_HEX8(4, out[0]);
+    mod_proto_get_port_seq_stats(0, &before);
+    TEST_ASSERT_EQUAL_UINT32(after.lost, before.lost);
+}
+
+/* sACN header for merge_input_sacn(): CID, priority, sequence, options */
+static void make_sacn_header(uint8_t *pkt, uint8_t cid, uint8_t priority, uint8_t seq, uint8_t options)
+{
+    memset(pkt, 0, 126);
+    memcpy(&pkt[4], "ASC-E1.17", 9);
+    pkt[22] = cid;
+    pkt[110] = priority;
+    pkt[111] = seq;
+    pkt[112] = options;
+}
+
+void test_sacn_stream_terminated(void)
+{
+    merge_init();
+    mod_proto_set_merge_mode(0, MERGE_MODE_HTP);
+    uint8_t *out = sys_get_dmx_buffer(0);
+    TEST_ASSERT_NOT_NULL(out);
+    uint8_t pkt[126];
+    uint8_t main_lv[DMX_UNIVERSE_SIZE], backup_lv[DMX_UNIVERSE_SIZE];
+    memset(main_lv, 0x11, sizeof(main_lv));
+    memset(backup_lv, 0x22, sizeof(backup_lv));
+
+    /* Main console at 150 wins over the backup at 100 */
+    make_sacn_header(pkt, 0xA1, 150, 1, 0);
+    merge_input_sacn(pkt, 0, SACN_START_CODE_DMX, main_lv, DMX_UNIVERSE_SIZE, 150, 0x0A000001);
+    make_sacn_header(pkt, 0xB1, 100, 1, 0);
+    merge_input_sacn(pkt, 0, SACN_START_CODE_DMX, backup_lv, DMX_UNIVERSE_SIZE, 100, 0x0A000002);
+    TEST_ASSERT_EQUAL_HEX8(0x11, out[0]);
+
+    /* Preview data never reaches the output, whatever its priority */
+    uint8_t preview[DMX_UNIVERSE_SIZE];
+    memset(preview, 0x33, sizeof(preview));
+    make_sacn_header(pkt, 0xC1, 200, 1, SACN_OPT_PREVIEW);
+    merge_input_sacn(pkt, 0, SACN_START_CODE_DMX, preview, DMX_UNIVERSE_SIZE, 200, 0x0A000003);
+    TEST_ASSERT_EQUAL_HEX8(0x11, out[0]);
+
+    /* Stream_Terminated: the backup takes over now, not after the timeout;
+     * the terminating packet's own levels are ignored */
+    make_sacn_header(pkt, 0xA1, 150, 2, SACN_OPT_TERMINATED);
+    merge_input_sacn(pkt, 0, SACN_START_CODE_DMX, preview, DMX_UNIVERSE_SIZE, 150, 0x0A000001);
+    TEST_ASSERT_EQUAL_HEX8(0x22, out[0]);
+    /* Senders repeat it: later copies are no-ops */
+    make_sacn_header(pkt, 0xA1, 150, 3, SACN_OPT_TERMINATED);
+    merge_input_sacn(pkt, 0, SACN_START_CODE_DMX, preview, DMX_UNIVERSE_SIZE, 150, 0x0A000001);
+    TEST_ASSERT_EQUAL_HEX8(0x22, out[0]);
+}
+
+void test_loss_timeout_per_port(void)
+{
+    merge_init();
+    mod_proto_set_merge_mode(0, MERGE_MODE_HTP);
+    dmx_port_cfg_t saved = sys_get_config()->ports[0];
+    dmx_port_cfg_t cfg = saved;
+    cfg.loss_timeout_ms = 50;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, sys_update_port_cfg(0, &cfg));   /* below the minimum */
+    cfg.loss_timeout_ms = 500;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, sys_update_port_cfg(0, &cfg));
+
+    uint8_t *out = sys_get_dmx_buffer(0);
+    TEST_ASSERT_NOT_NULL(out);
+    uint8_t a[DMX_UNIVERSE_SIZE];
+    memset(a, 0x40, sizeof(a));
+    merge_input_by_universe(0, a, DMX_UNIVERSE_SIZE, 100, 0x01000001);
+    TEST_ASSERT_EQUAL_HEX8(0x40, out[0]);
+
+    /* The deadline queue names the next expiry; nothing happens before it */
+    uint64_t now_ms = (uint64_t)esp_timer_get_time() / 1000ULL;
+    uint64_t due = merge_next_deadline_ms();
+    TEST_ASSERT_TRUE(due > now_ms && due <= now_ms + 501);
+    merge_check_timeout_ms(due - 1);
+    TEST_ASSERT_EQUAL_HEX8(0x40, out[0]);
+    /* Dropped after the port's 500 ms, not the default 2.5 s */
+    merge_check_timeout_ms(now_ms + 502);
+    TEST_ASSERT_EQUAL_HEX8(0, out[0]);
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, merge_next_deadline_ms());
+
+    /* Back to the default: the same gap no longer drops the source */
+    TEST_ASSERT_EQUAL_INT(ESP_OK, sys_update_port_cfg(0, &saved));
+    merge_input_by_universe(0, a, DMX_UNIVERSE_SIZE, 100, 0x01000001);
+    now_ms = (uint64_t)esp_timer_get_time() / 1000ULL;
+    merge_check_timeout_ms(now_ms + 502);
+    TEST_ASSERT_EQUAL_HEX8(0x40, out[0]);
+    merge_check_timeout_ms(now_ms + PROTO_STREAM_TIMEOUT_MS + 1);
+    TEST_ASSERT_EQUAL_HEX8(0, out[0]);
+}
+
+static uint8_t s_ka[DMX_UNIVERSE_SIZE + 16] __attribute__((aligned(16)));
+static uint8_t s_kb[DMX_UNIVERSE_SIZE + 16] __attribute__((aligned(16)));
+static uint8_t s_kout[DMX_UNIVERSE_SIZE + 16] __attribute__((aligned(16)));
+static uint8_t s_kref[DMX_UNIVERSE_SIZE + 16];
+
+void test_merge_kernel_matches_scalar(void)
+{
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(s_ka); ++i) {
+        seed = seed * 1103515245u + 12345u; s_ka[i] = (uint8_t)(seed >> 16);
+        seed = seed * 1103515245u + 12345u; s_kb[i] = (uint8_t)(seed >> 16);
+    }
+    s_ka[0] = 0x00; s_kb[0] = 0xFF; s_ka[1] = 0x7F; s_kb[1] = 0x80; s_ka[2] = 0xFF; s_kb[2] = 0xFF;
+
+    /* Aligned universe (PIE path on the S3), then odd offsets and lengths */
+    const size_t offs[] = { 0, 1, 3 };
+    const size_t lens[] = { DMX_UNIVERSE_SIZE, 511, 17, 3 };
+    for (size_t o = 0; o < sizeof(offs) / sizeof(offs[0]); ++o) {
+        for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); ++l) {
+            size_t off = offs[o], len = lens[l];
+            merge_kernel_htp_scalar(s_kref, s_ka + off, s_kb + off, len);
+            merge_kernel_htp(s_kout + off, s_ka + off, s_kb + off, len);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(s_kref, s_kout + off, len);
+            merge_kernel_htp_swar(s_kout + off, s_ka + off, s_kb + off, len);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(s_kref, s_kout + off, len);
+        }
+    }
+
+    /* Per-channel priority fold: priorities 0-3 force ties and gaps */
+    static uint8_t prio[DMX_UNIVERSE_SIZE], best_ref[DMX_UNIVERSE_SIZE], best[DMX_UNIVERSE_SIZE];
+    for (int ltp = 0; ltp < 2; ++ltp) {
+        memset(s_kref, 0, DMX_UNIVERSE_SIZE); memset(best_ref, 0, sizeof(best_ref));
+        memset(s_kout, 0, DMX_UNIVERSE_SIZE); memset(best, 0, sizeof(best));
+        for (int src = 0; src < 3; ++src) {
+            const uint8_t *d = src == 1 ? s_kb : s_ka + src;
+            for (size_t i = 0; i < sizeof(prio); ++i) prio[i] = (uint8_t)((d[i] ^ (i >> 2)) & 3);
+            const uint8_t *pp = src == 2 ? NULL : prio;   /* one source without a plane */
+            merge_kernel_prio_scalar(s_kref, best_ref, d, pp, 2, ltp, DMX_UNIVERSE_SIZE);
+            merge_kernel_prio(s_kout, best, d, pp, 2, ltp, DMX_UNIVERSE_SIZE);
+        }
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(s_kref, s_kout, DMX_UNIVERSE_SIZE);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(best_ref, best, DMX_UNIVERSE_SIZE);
+    }
+}
+
+/* The merge loop the kernels replaced, on the old two-source layout */
+typedef struct {
+    bool active;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+} legacy_source_t;
+
+static void legacy_htp(uint8_t *out, const legacy_source_t *a, const legacy_source_t *b)
+{
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i) {
+        uint8_t x = a->active ? a->data[i] : 0;
+        uint8_t y = b->active ? b->data[i] : 0;
+        out[i] = (x >= y) ? x : y;
+    }
+}
+
+void test_merge_kernel_benchmark(void)
+{
+    static legacy_source_t a, b;
+    a.active = b.active = true;
+    memcpy(a.data, s_ka, DMX_UNIVERSE_SIZE);
+    memcpy(b.data, s_kb, DMX_UNIVERSE_SIZE);
+
+    const int iterations = 2000;
+    uint64_t t0 = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        a.data[i & 511]++;
+        legacy_htp(s_kout, &a, &b);
+    }
+    uint64_t legacy = bench_now() - t0;
+
+    t0 = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        a.data[i & 511]++;
+        merge_kernel_htp_swar(s_kout, a.data, b.data, DMX_UNIVERSE_SIZE);
+    }
+    uint64_t swar = bench_now() - t0;
+
+    t0 = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        a.data[i & 511]++;
+        merge_kernel_htp(s_kout, a.data, b.data, DMX_UNIVERSE_SIZE);
+    }
+    uint64_t best = bench_now() - t0;
+
+    legacy_htp(s_kref, &a, &b);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(s_kref, s_kout, DMX_UNIVERSE_SIZE);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "HTP universe: loop %llu, swar %llu, kernel %llu " BENCH_UNIT,
+             (unsigned long long)(legacy / iterations), (unsigned long long)(swar / iterations),
+             (unsigned long long)(best / iterations));
+    TEST_MESSAGE(msg);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -150,6 +661,19 @@ int main(void)
     RUN_TEST(test_priority_override_ltp);
     RUN_TEST(test_artnet_malformed_length);
     RUN_TEST(test_sacn_malformed_prop_val_count);
+    RUN_TEST(test_rx_hist_buckets);
+    RUN_TEST(test_rxq_spsc);
+    RUN_TEST(test_header_prefilter);
+    RUN_TEST(test_merge_n_sources);
+    RUN_TEST(test_sacn_start_codes);
+    RUN_TEST(test_merge_per_channel_priority);
+    RUN_TEST(test_source_table);
+    RUN_TEST(test_merge_sources_by_cid);
+    RUN_TEST(test_merge_sequence);
+    RUN_TEST(test_sacn_stream_terminated);
+    RUN_TEST(test_loss_timeout_per_port);
+    RUN_TEST(test_merge_kernel_matches_scalar);
+    RUN_TEST(test_merge_kernel_benchmark);
     return UNITY_END();
 }
 
@@ -169,6 +693,8 @@ void test_proto_reload_join_leave(void)
     cfg[1].enabled = true; cfg[1].protocol = PROTOCOL_SACN; cfg[1].universe = 2; cfg[1].fps = 40;
 
     TEST_ASSERT_EQUAL_INT(SYS_OK, sys_apply_dmx_config(cfg, 4));
+    // The reload runs in the event dispatcher: wait for it
+    TEST_ASSERT_EQUAL_INT(0, sys_event_flush(1000));
 
     // Now joined universes should include 1 and 2
     n = sacn_get_joined_universes(out, 64);
@@ -185,6 +711,7 @@ void test_proto_reload_join_leave(void)
     cfg[0].enabled = true; cfg[0].protocol = PROTOCOL_SACN; cfg[0].universe = 3; cfg[0].fps = 40;
 
     TEST_ASSERT_EQUAL_INT(SYS_OK, sys_apply_dmx_config(cfg, 4));
+    TEST_ASSERT_EQUAL_INT(0, sys_event_flush(1000));
 
     // Now joined universes should include 3 and not include 1
     n = sacn_get_joined_universes(out, 64);
@@ -67,6 +67,23 @@ esp_err_t mod_web_api_dmx_status(httpd_req_t *req);
  */
 esp_err_t mod_web_api_dmx_config(httpd_req_t *req);
 
+/* ========== Protocol API Handlers ========== */
+
+/**
+ * @brief GET /api/proto/stats
+ *
+ * Returns parser/socket counters and receive loop histograms.
+ */
+esp_err_t mod_web_api_proto_stats(httpd_req_t *req);
+
+/**
+ * @brief GET /api/proto/sources
+ *
+ * Lists live sources (sACN CID and name, Art-Net IP and physical port)
+ * with their packet rates.
+ */
+esp_err_t mod_web_api_proto_sources(httpd_req_t *req);
+
 /* ========== Network API Handlers ========== */
 
 /**
@@ -17,7 +17,7 @@ extern "C" {
 /**
  * @brief Validate DMX port index
  * 
- * @param port Port index (0-3)
+ * @param port Port index (0 to SYS_MAX_PORTS - 1)
  * @return true if valid
  */
 bool mod_web_validation_port(int port);
@@ -46,6 +46,17 @@ bool mod_web_validation_break_us(int break_us);
  */
 bool mod_web_validation_mab_us(int mab_us);
 
+/**
+ * @brief Validate DMX refresh rate
+ * 
+ * Rates above ~44 Hz are only reached by ports with short frames
+ * (slot_count); longer frames run as fast as their wire time allows.
+ *
+ * @param refresh_rate Output refresh rate in Hz (20-830)
+ * @return true if valid
+ */
+bool mod_web_validation_refresh_rate(int refresh_rate);
+
 /**
  * @brief Validate IP address format (basic check)
  * 
@@ -11,6 +11,8 @@
 #include "mod_web_error.h"
 #include "sys_mod.h"
 #include "mod_net.h"
+#include "mod_dmx.h"
+#include "mod_proto.h"
 #include "mod_web_auth.h"
 #include "dmx_types.h"
 #include "esp_log.h"
@@ -20,6 +22,7 @@
 #include "esp_wifi.h"
 #include "cJSON.h"
 #include <string.h>
+#include <stdio.h>
 
 static const char *TAG = "MOD_WEB_API";
 
@@ -51,7 +54,7 @@ esp_err_t mod_web_api_system_info(httpd_req_t *req)
     cJSON *root = cJSON_CreateObject();
 
     cJSON_AddStringToObject(root, "device", cfg->device_label);
-    cJSON_AddStringToObject(root, "version", cfg->version == 1 ? "1.0" : "unknown");
+    cJSON_AddStringToObject(root, "version", cfg->version == 2 ? "2.0" : "unknown");
     cJSON_AddNumberToObject(root, "uptime", uptime_sec);
     cJSON_AddNumberToObject(root, "free_heap", free_heap);
     const sys_state_t *state = sys_get_state();
@@ -264,7 +267,7 @@ esp_err_t mod_web_api_dmx_status(httpd_req_t *req)
     cJSON *ports = cJSON_CreateArray();
 
     // Get activity timestamps for FPS calculation
-    for (int i = 0; i < 4; i++) {
+    for (int i = 0; i < SYS_MAX_PORTS; i++) {
         cJSON *port = cJSON_CreateObject();
         // Copy to local variable to avoid packed member address warning
         dmx_port_cfg_t port_cfg = cfg->ports[i];
@@ -273,17 +276,32 @@ esp_err_t mod_web_api_dmx_status(httpd_req_t *req)
         cJSON_AddNumberToObject(port, "universe", port_cfg.universe);
         cJSON_AddBoolToObject(port, "enabled", port_cfg.enabled);
 
-        // Calculate FPS from activity (simplified - TODO: implement proper FPS calculation)
+        // Achieved output frame rate as measured by MOD_DMX
         int64_t last_activity = sys_get_last_activity(i);
-        uint16_t fps = 0;
-        if (last_activity > 0) {
-            // Simple FPS estimate (would need proper tracking)
-            fps = port_cfg.enabled ? 40 : 0;
-        }
-        cJSON_AddNumberToObject(port, "fps", fps);
-
-        // Backend type (RMT or UART - simplified)
-        cJSON_AddStringToObject(port, "backend", "RMT");
+        dmx_port_stats_t stats = {0};
+        dmx_get_port_stats(i, &stats);
+        cJSON_AddNumberToObject(port, "fps", stats.fps);
+        cJSON_AddNumberToObject(port, "deadline_missed", stats.deadline_missed);
+        cJSON_AddNumberToObject(port, "frames_skipped", stats.frames_skipped);
+        cJSON_AddNumberToObject(port, "frames_flash_delayed", stats.frames_flash_delayed);
+        cJSON_AddNumberToObject(port, "refresh_rate", stats.refresh_rate);
+        cJSON_AddNumberToObject(port, "jitter_avg_us", stats.jitter_avg_us);
+        cJSON_AddNumberToObject(port, "jitter_max_us", stats.jitter_max_us);
+        cJSON_AddNumberToObject(port, "tx_isr_per_frame", stats.tx_isr_last);
+        cJSON_AddNumberToObject(port, "tx_isr_max", stats.tx_isr_max);
+        cJSON_AddBoolToObject(port, "tx_dma", stats.tx_dma);
+        cJSON_AddStringToObject(port, "output_mode",
+                                stats.output_mode == DMX_OUTPUT_LATENCY ? "latency" : "periodic");
+        cJSON_AddNumberToObject(port, "latency_avg_us", stats.latency_avg_us);
+        cJSON_AddNumberToObject(port, "latency_max_us", stats.latency_max_us);
+        cJSON_AddNumberToObject(port, "slot_count", stats.slot_count);
+        cJSON_AddBoolToObject(port, "slot_count_auto", port_cfg.slot_count == DMX_SLOTS_AUTO);
+        cJSON_AddNumberToObject(port, "loss_timeout_ms",
+                                port_cfg.loss_timeout_ms ? port_cfg.loss_timeout_ms : PROTO_STREAM_TIMEOUT_MS);
+
+        // Output backend bound to the port ("rmt", "uart", ...)
+        const char *backend = dmx_get_port_backend(i);
+        cJSON_AddStringToObject(port, "backend", backend ? backend : "none");
 
         // Activity counter (simplified)
         cJSON_AddNumberToObject(port, "activity_counter", last_activity > 0 ? 1 : 0);
@@ -331,6 +349,10 @@ esp_err_t mod_web_api_dmx_config(httpd_req_t *req)
     cJSON *enabled_item = cJSON_GetObjectItem(json, "enabled");
     cJSON *break_us_item = cJSON_GetObjectItem(json, "break_us");
     cJSON *mab_us_item = cJSON_GetObjectItem(json, "mab_us");
+    cJSON *refresh_item = cJSON_GetObjectItem(json, "refresh_rate");
+    cJSON *mode_item = cJSON_GetObjectItem(json, "output_mode");
+    cJSON *slots_item = cJSON_GetObjectItem(json, "slot_count");
+    cJSON *loss_item = cJSON_GetObjectItem(json, "loss_timeout_ms");
 
     if (!cJSON_IsNumber(port_item) || !cJSON_IsNumber(universe_item) || !cJSON_IsBool(enabled_item)) {
         cJSON_Delete(json);
@@ -344,7 +366,9 @@ esp_err_t mod_web_api_dmx_config(httpd_req_t *req)
     // Validate port
     if (!mod_web_validation_port(port)) {
         cJSON_Delete(json);
-        return mod_web_error_send_400(req, "Invalid port (0-3)");
+        char msg[32];
+        snprintf(msg, sizeof(msg), "Invalid port (0-%d)", SYS_MAX_PORTS - 1);
+        return mod_web_error_send_400(req, msg);
     }
 
     // Validate universe
@@ -382,7 +406,54 @@ esp_err_t mod_web_api_dmx_config(httpd_req_t *req)
         new_cfg.timing.mab_us = 12; // Default
     }
 
-    new_cfg.timing.refresh_rate = 40; // Default
+    if (cJSON_IsNumber(refresh_item)) {
+        int refresh_rate = refresh_item->valueint;
+        if (!mod_web_validation_refresh_rate(refresh_rate)) {
+            cJSON_Delete(json);
+            return mod_web_error_send_400(req, "Invalid refresh_rate (20-830)");
+        }
+        new_cfg.timing.refresh_rate = (uint16_t)refresh_rate;
+    } else {
+        new_cfg.timing.refresh_rate = 40; // Default
+    }
+
+    // Slot count: 1-512, 0 for full frames (default) or "auto"
+    if (cJSON_IsNumber(slots_item)) {
+        int slots = slots_item->valueint;
+        if (slots < 0 || slots > DMX_UNIVERSE_SIZE) {
+            cJSON_Delete(json);
+            return mod_web_error_send_400(req, "Invalid slot_count (0-512 or \"auto\")");
+        }
+        new_cfg.slot_count = (uint16_t)slots;
+    } else if (cJSON_IsString(slots_item)) {
+        if (strcmp(slots_item->valuestring, "auto") != 0) {
+            cJSON_Delete(json);
+            return mod_web_error_send_400(req, "Invalid slot_count (0-512 or \"auto\")");
+        }
+        new_cfg.slot_count = DMX_SLOTS_AUTO;
+    }
+
+    // Source loss timeout: 0 = E1.31 default (2500ms)
+    if (cJSON_IsNumber(loss_item)) {
+        int loss_ms = loss_item->valueint;
+        if (loss_ms != 0 && (loss_ms < DMX_LOSS_TIMEOUT_MIN_MS || loss_ms > DMX_LOSS_TIMEOUT_MAX_MS)) {
+            cJSON_Delete(json);
+            return mod_web_error_send_400(req, "Invalid loss_timeout_ms (0 or 100-10000)");
+        }
+        new_cfg.loss_timeout_ms = (uint16_t)loss_ms;
+    }
+
+    // Output mode: "periodic" (default) or "latency"
+    if (cJSON_IsString(mode_item)) {
+        if (strcmp(mode_item->valuestring, "latency") == 0) {
+            new_cfg.output_mode = DMX_OUTPUT_LATENCY;
+        } else if (strcmp(mode_item->valuestring, "periodic") == 0) {
+            new_cfg.output_mode = DMX_OUTPUT_PERIODIC;
+        } else {
+            cJSON_Delete(json);
+            return mod_web_error_send_400(req, "Invalid output_mode (periodic|latency)");
+        }
+    }
 
     cJSON_Delete(json);
 
@@ -403,6 +474,130 @@ esp_err_t mod_web_api_dmx_config(httpd_req_t *req)
     return resp_ret;
 }
 
+/* ========== PROTO API HANDLERS ========== */
+
+esp_err_t mod_web_api_proto_stats(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/proto/stats");
+
+    mod_proto_metrics_t m;
+    mod_proto_get_metrics(&m);
+    mod_proto_rx_hist_t h;
+    mod_proto_get_rx_hist(&h);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "malformed_artnet", m.malformed_artnet_packets);
+    cJSON_AddNumberToObject(root, "malformed_sacn", m.malformed_sacn_packets);
+    cJSON_AddNumberToObject(root, "socket_errors", m.socket_errors);
+    cJSON_AddNumberToObject(root, "igmp_failures", m.igmp_failures);
+    // Header pre-filter: datagrams for unrouted universes dropped unread
+    cJSON_AddNumberToObject(root, "rx_accepted", m.rx_accepted);
+    cJSON_AddNumberToObject(root, "rx_filtered", m.rx_filtered);
+    cJSON_AddNumberToObject(root, "sources_rejected", m.sources_rejected);
+
+    // Sequence numbers: totals, then per output port (network quality per universe)
+    cJSON *seq = cJSON_CreateObject();
+    cJSON_AddNumberToObject(seq, "lost", m.seq_lost);
+    cJSON_AddNumberToObject(seq, "reordered", m.seq_reordered);
+    cJSON_AddNumberToObject(seq, "duplicate", m.seq_duplicate);
+    cJSON *seq_ports = cJSON_CreateArray();
+    for (int i = 0; i < SYS_MAX_PORTS; ++i) {
+        mod_proto_seq_stats_t ps;
+        mod_proto_get_port_seq_stats(i, &ps);
+        cJSON *p = cJSON_CreateObject();
+        cJSON_AddNumberToObject(p, "lost", ps.lost);
+        cJSON_AddNumberToObject(p, "reordered", ps.reordered);
+        cJSON_AddNumberToObject(p, "duplicate", ps.duplicate);
+        cJSON_AddItemToArray(seq_ports, p);
+    }
+    cJSON_AddItemToObject(seq, "ports", seq_ports);
+    cJSON_AddItemToObject(root, "seq", seq);
+
+    // Receive loop: batch size buckets 0,1,2-3,4-7..; time buckets <50us, <100us, ..
+    cJSON *rx = cJSON_CreateObject();
+    cJSON_AddNumberToObject(rx, "wakeups", h.wakeups);
+    cJSON_AddNumberToObject(rx, "packets", h.packets);
+    cJSON_AddNumberToObject(rx, "batch_max", h.batch_max);
+    cJSON_AddNumberToObject(rx, "proc_max_us", h.proc_max_us);
+    cJSON_AddNumberToObject(rx, "budget_hits", h.budget_hits);
+    cJSON *batch = cJSON_CreateArray();
+    cJSON *proc = cJSON_CreateArray();
+    for (int i = 0; i < PROTO_HIST_BUCKETS; ++i) {
+        cJSON_AddItemToArray(batch, cJSON_CreateNumber(h.batch[i]));
+        cJSON_AddItemToArray(proc, cJSON_CreateNumber(h.proc_us[i]));
+    }
+    cJSON_AddItemToObject(rx, "batch_hist", batch);
+    cJSON_AddItemToObject(rx, "proc_us_hist", proc);
+    cJSON_AddNumberToObject(rx, "proc_hist_base_us", PROTO_HIST_PROC_BASE_US);
+    cJSON_AddItemToObject(root, "rx", rx);
+
+    // Raw UDP ingest (CONFIG_MODPROTO_RAW_UDP); CPU/packet = cb_us_total / packets
+    mod_proto_raw_stats_t r;
+    mod_proto_get_raw_stats(&r);
+    cJSON_AddStringToObject(root, "ingest", r.enabled ? "raw" : "socket");
+    if (r.enabled) {
+        cJSON *raw = cJSON_CreateObject();
+        cJSON_AddNumberToObject(raw, "packets", r.packets);
+        cJSON_AddNumberToObject(raw, "drops_full", r.drops_full);
+        cJSON_AddNumberToObject(raw, "chained", r.chained);
+        cJSON_AddNumberToObject(raw, "cb_us_total", r.cb_us_total);
+        cJSON_AddNumberToObject(raw, "cb_max_us", r.cb_max_us);
+        cJSON_AddNumberToObject(raw, "queued", r.queued);
+        cJSON_AddItemToObject(root, "raw", raw);
+    }
+
+    esp_err_t ret = mod_web_json_send_response(req, root);
+    cJSON_Delete(root);
+    return ret;
+}
+
+esp_err_t mod_web_api_proto_sources(httpd_req_t *req)
+{
+    ESP_LOGD(TAG, "GET /api/proto/sources");
+
+    static mod_proto_source_info_t src[MOD_PROTO_MAX_SOURCES];  // ~2.5 KB, off the httpd stack
+    size_t n = mod_proto_get_sources(src, MOD_PROTO_MAX_SOURCES);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *list = cJSON_CreateArray();
+    for (size_t i = 0; i < n; ++i) {
+        const mod_proto_source_info_t *s = &src[i];
+        cJSON *item = cJSON_CreateObject();
+        char ip[16];
+        const uint8_t *a = (const uint8_t *)&s->ip;
+        snprintf(ip, sizeof(ip), "%u.%u.%u.%u", a[0], a[1], a[2], a[3]);
+        cJSON_AddStringToObject(item, "protocol", s->protocol == PROTOCOL_SACN ? "sacn" : "artnet");
+        cJSON_AddStringToObject(item, "ip", ip);
+        if (s->protocol == PROTOCOL_SACN) {
+            // CID in the usual UUID form
+            char cid[37];
+            const uint8_t *c = s->cid;
+            snprintf(cid, sizeof(cid),
+                     "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                     c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7],
+                     c[8], c[9], c[10], c[11], c[12], c[13], c[14], c[15]);
+            cJSON_AddStringToObject(item, "cid", cid);
+            cJSON_AddStringToObject(item, "name", s->name);
+        } else {
+            cJSON_AddNumberToObject(item, "physical", s->physical);
+        }
+        cJSON_AddNumberToObject(item, "universe", s->universe);
+        cJSON_AddNumberToObject(item, "packets", s->packets);
+        cJSON_AddNumberToObject(item, "rate_pps", s->rate_pps);
+        cJSON_AddNumberToObject(item, "age_ms", s->age_ms);
+        cJSON_AddNumberToObject(item, "idle_ms", s->idle_ms);
+        cJSON_AddNumberToObject(item, "seq_lost", s->seq.lost);
+        cJSON_AddNumberToObject(item, "seq_reordered", s->seq.reordered);
+        cJSON_AddNumberToObject(item, "seq_duplicate", s->seq.duplicate);
+        cJSON_AddItemToArray(list, item);
+    }
+    cJSON_AddItemToObject(root, "sources", list);
+
+    esp_err_t ret = mod_web_json_send_response(req, root);
+    cJSON_Delete(root);
+    return ret;
+}
+
 /* ========== NETWORK API HANDLERS ========== */
 
 esp_err_t mod_web_api_network_status(httpd_req_t *req)
@@ -1,4 +1,5 @@
 #include "mod_web_auth.h"
+#include "sys_mod.h"
 #include "sdkconfig.h"
 #ifndef CONFIG_LOG_MAXIMUM_LEVEL
 #define CONFIG_LOG_MAXIMUM_LEVEL 0
@@ -70,8 +71,10 @@ esp_err_t mod_web_auth_set_password(const char *password_plain)
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
     if (ret != ESP_OK) return ret;
 
+    sys_flash_write_begin();
     ret = nvs_set_str(h, NVS_KEY_ADMIN_HASH, hex);
     if (ret == ESP_OK) ret = nvs_commit(h);
+    sys_flash_write_end();
     nvs_close(h);
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Admin password set (hash stored in NVS)");
@@ -180,6 +180,34 @@ esp_err_t mod_web_register_routes(httpd_handle_t server)
         return ret;
     }
 
+    // ========== Protocol API Handlers ==========
+
+    // GET /api/proto/stats
+    httpd_uri_t uri_proto_stats = {
+        .uri = "/api/proto/stats",
+        .method = HTTP_GET,
+        .handler = mod_web_api_proto_stats,
+        .user_ctx = NULL
+    };
+    ret = httpd_register_uri_handler(server, &uri_proto_stats);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register /api/proto/stats handler");
+        return ret;
+    }
+
+    // GET /api/proto/sources
+    httpd_uri_t uri_proto_sources = {
+        .uri = "/api/proto/sources",
+        .method = HTTP_GET,
+        .handler = mod_web_api_proto_sources,
+        .user_ctx = NULL
+    };
+    ret = httpd_register_uri_handler(server, &uri_proto_sources);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register /api/proto/sources handler");
+        return ret;
+    }
+
     // ========== Network API Handlers ==========
     
     // POST /api/net/config (per MOD_WEB.md)
@@ -4,12 +4,13 @@
  */
 
 #include "mod_web_validation.h"
+#include "dmx_types.h"
 #include <string.h>
 #include <ctype.h>
 
 bool mod_web_validation_port(int port)
 {
-    return (port >= 0 && port < 4);
+    return (port >= 0 && port < SYS_MAX_PORTS);
 }
 
 bool mod_web_validation_universe(int universe)
@@ -27,6 +28,11 @@ bool mod_web_validation_mab_us(int mab_us)
     return (mab_us >= 8 && mab_us <= 100);
 }
 
+bool mod_web_validation_refresh_rate(int refresh_rate)
+{
+    return (refresh_rate >= DMX_REFRESH_MIN_HZ && refresh_rate <= DMX_REFRESH_MAX_HZ);
+}
+
 bool mod_web_validation_ip(const char *ip)
 {
     if (ip == NULL || strlen(ip) == 0) {
@@ -11,6 +11,7 @@
 #include "sys_mod.h"
 #include "sys_event.h"
 #include "mod_net.h"
+#include "mod_dmx.h"
 #include <string.h>
 #include "esp_log.h"
 #include "esp_http_server.h"
@@ -239,12 +240,10 @@ static void ws_send_dmx_port_status(int port_idx)
     // Copy to local variable to avoid packed member address warning
     dmx_port_cfg_t port_cfg = cfg->ports[port_idx];
     
-    // Calculate FPS (simplified - TODO: proper calculation)
-    int64_t last_activity = sys_get_last_activity(port_idx);
-    uint16_t fps = 0;
-    if (last_activity > 0 && port_cfg.enabled) {
-        fps = 40; // Simplified
-    }
+    // Achieved output frame rate as measured by MOD_DMX
+    dmx_port_stats_t stats = {0};
+    dmx_get_port_stats(port_idx, &stats);
+    uint16_t fps = stats.fps;
     
     // Build data object
     cJSON *data = cJSON_CreateObject();
@@ -3,20 +3,33 @@
  * @brief Shared data type definitions for DMX Node V4.0
  * 
  * This file contains all core data structures used across modules.
- * Total config size: 512 bytes (aligned for NVS storage)
+ * Total config size: 512 bytes with 4 ports, +16 bytes per extra port
  */
 
 #pragma once
 
 #include <stdint.h>
 #include <stdbool.h>
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
 
 /* ========== CONSTANTS ========== */
 
 #define SYS_CONFIG_MAGIC    0xDEADBEEF  // Magic number for NVS validation
-#define SYS_CONFIG_VERSION  1           // Config version for migration
+#define SYS_CONFIG_VERSION  2           // Config version for migration (sys_persist.h)
+#ifdef CONFIG_MODDMX_PORT_COUNT
+#define SYS_MAX_PORTS       CONFIG_MODDMX_PORT_COUNT  // 4, or one per LCD_CAM lane
+#else
 #define SYS_MAX_PORTS       4           // Number of DMX output ports
+#endif
+#define SYS_PORTS_LIMIT     16          // Widest LCD_CAM bus; bounds SYS_MAX_PORTS
 #define DMX_UNIVERSE_SIZE   512         // DMX512 standard channel count
+#define DMX_SLOTS_AUTO      0xFFFF      // slot_count: track highest written channel
+#define DMX_REFRESH_MIN_HZ  20
+#define DMX_REFRESH_MAX_HZ  830         // 1204us minimum break-to-break; short frames only
+#define DMX_LOSS_TIMEOUT_MIN_MS 100     // loss_timeout_ms range (0 = E1.31 default 2500ms)
+#define DMX_LOSS_TIMEOUT_MAX_MS 10000
 
 /* ========== TIMING CONFIGURATION ========== */
 
@@ -27,7 +40,7 @@
 typedef struct {
     uint16_t break_us;      // Break time: 88-500us (Default: 176us)
     uint16_t mab_us;        // Mark After Break: 8-100us (Default: 12us)
-    uint16_t refresh_rate;  // Refresh rate: 20-44Hz (Default: 40Hz)
+    uint16_t refresh_rate;  // Refresh rate: 20-830Hz (Default: 40Hz); capped by frame length
 } dmx_timing_t;
 
 /* ========== FAIL-SAFE CONFIGURATION ========== */
@@ -63,6 +76,14 @@ typedef enum {
     PROTOCOL_SACN = 1
 } protocol_type_t;
 
+/**
+ * @brief Output scheduling mode
+ */
+typedef enum {
+    DMX_OUTPUT_PERIODIC = 0,    // Frames at timing.refresh_rate
+    DMX_OUTPUT_LATENCY = 1      // Frame as soon as new data is merged, plus keepalive
+} dmx_output_mode_t;
+
 /**
  * @brief Per-port DMX configuration
  * Size: 16 bytes (aligned to 4-byte boundary)
@@ -72,9 +93,10 @@ typedef struct {
     uint8_t protocol;       // protocol_type_t
     uint16_t universe;      // Universe ID: 0-32767
     bool rdm_enabled;       // RDM enable (future feature)
-    uint8_t reserved[3];    // Padding
+    uint8_t output_mode;    // dmx_output_mode_t
+    uint16_t loss_timeout_ms; // Source loss timeout: 0 = default (2500ms), 100-10000ms
     dmx_timing_t timing;    // 6 bytes
-    uint8_t reserved2[2];   // Padding to 16 bytes
+    uint16_t slot_count;    // Channels per frame: 0 = 512, 1-512 fixed, DMX_SLOTS_AUTO
 } dmx_port_cfg_t;
 
 /* ========== NETWORK CONFIGURATION ========== */
@@ -120,18 +142,21 @@ typedef struct {
 
 /**
  * @brief Global system configuration
- * Size: 512 bytes (aligned for NVS blob storage)
+ * Size: 512 bytes with 4 ports (aligned for NVS blob storage)
  * 
- * Memory layout:
+ * Memory layout, P = SYS_MAX_PORTS:
  * Offset   0: Magic number (4 bytes)
  * Offset   4: Version (4 bytes)
  * Offset   8: Device label (32 bytes)
- * Offset  40: LED brightness (1 byte) + padding (23 bytes)
+ * Offset  40: LED brightness (1 byte) + port count (1 byte) + padding (22 bytes)
  * Offset  64: Network config (~256 bytes)
- * Offset 320: Port configs (16 * 4 = 64 bytes)
- * Offset 384: Failsafe config (8 bytes)
- * Offset 392: Reserved (120 bytes)
- * Offset 508: CRC32 checksum (4 bytes)
+ * Offset 320: Port configs (16 * P bytes)
+ * Offset 320 + 16P: Failsafe config (8 bytes)
+ * Offset 328 + 16P: Reserved (116 bytes)
+ * Offset 444 + 16P: CRC32 checksum (4 bytes)
+ *
+ * Version 1 images have no port count (the byte is 0) and 4 ports. Images
+ * with another port count are converted on load (sys_persist_upgrade()).
  */
 typedef struct __attribute__((packed)) {
     uint32_t magic_number;              // Offset 0: Magic validation
@@ -139,20 +164,24 @@ typedef struct __attribute__((packed)) {
     
     char device_label[32];              // Offset 8: Device name
     uint8_t led_brightness;             // Offset 40: LED brightness 0-100
-    uint8_t reserved1[23];              // Padding to offset 64
+    uint8_t port_count;                 // Offset 41: Entries in ports[] (version 2+)
+    uint8_t reserved1[22];              // Padding to offset 64
     
     net_config_t net;                   // Offset 64: Network config
     
     dmx_port_cfg_t ports[SYS_MAX_PORTS]; // Offset 320: Port configs
-    dmx_failsafe_t failsafe;            // Offset 384: Failsafe config
+    dmx_failsafe_t failsafe;            // Offset 320 + 16P: Failsafe config
     
-    uint8_t reserved2[116];             // Offset 392: Future expansion
+    uint8_t reserved2[116];             // Offset 328 + 16P: Future expansion
     
-    uint32_t crc32;                     // Offset 508: CRC32 checksum
+    uint32_t crc32;                     // Offset 444 + 16P: CRC32 checksum
 } sys_config_t;
 
 /* Compile-time size validation */
-_Static_assert(sizeof(sys_config_t) == 512, "sys_config_t must be exactly 512 bytes");
+_Static_assert(SYS_MAX_PORTS == 4 || SYS_MAX_PORTS == 8 || SYS_MAX_PORTS == SYS_PORTS_LIMIT,
+               "SYS_MAX_PORTS must be 4, 8 or 16");
+_Static_assert(sizeof(sys_config_t) == 512 + (SYS_MAX_PORTS - 4) * 16,
+               "sys_config_t must be 512 bytes plus 16 per port beyond 4");
 
 /* ========== RUNTIME STATE ========== */
 
@@ -165,7 +194,6 @@ typedef struct {
     
     bool config_dirty;                  // Unsaved changes flag
     int64_t last_change_time;           // Timestamp of last change (us)
-    void* save_timer;                   // esp_timer_handle_t
     
     bool ota_in_progress;               // OTA update flag
     const void* ota_partition;          // esp_partition_t*
@@ -182,7 +210,7 @@ typedef struct {
 
 /**
  * @brief Snapshot data for one port (stored in NVS)
- * NVS key format: "snap_port0" to "snap_port3"
+ * NVS key format: "snap_port0" to "snap_port<SYS_MAX_PORTS - 1>"
  * Size: 512 bytes
  */
 typedef struct {
@@ -25,16 +25,55 @@ typedef struct {
     } payload;
 } sys_evt_msg_t;
 
-// Event callback signature: returns void, called in SYS_MOD context
+// Event callback signature: returns void, called in the event dispatcher
+// task, one event at a time, in emission order
 typedef void (*sys_event_cb_t)(const sys_evt_msg_t *evt, void *user_ctx);
 
+// Subscription filter: one bit per sys_event_t
+#define SYS_EVT_MASK(type)  (1u << (type))
+#define SYS_EVT_MASK_ALL    0xFFFFFFFFu
+
+// Callbacks and queues together
+#define SYS_EVENT_MAX_SUBSCRIBERS 16
+
+typedef struct {
+    uint32_t emitted;               // Events queued for dispatch
+    uint32_t dropped;               // Events refused: dispatch queue full
+    uint32_t queue_high_water;      // Most events waiting at once
+    uint32_t subscriber_overflows;  // Deliveries refused by a full subscriber queue
+} sys_event_stats_t;
+
 // Register a callback to receive events. Multiple callbacks allowed.
 // Returns 0 on success, non-zero on error (e.g., max callbacks reached).
 int sys_event_register_cb(sys_event_cb_t cb, void *user_ctx);
 
-// Unregister a previously registered callback.
+// Unregister a previously registered callback. Once it returns, the
+// callback is not running and will not be called again.
 int sys_event_unregister_cb(sys_event_cb_t cb, void *user_ctx);
 
+// Register a callback for the event types in type_mask only.
+int sys_event_subscribe(uint32_t type_mask, sys_event_cb_t cb, void *user_ctx);
+
+// Deliver the event types in type_mask to a FreeRTOS queue (QueueHandle_t,
+// item size sizeof(sys_evt_msg_t)) for a subscriber with its own task.
+// Delivery never blocks: a full queue loses the event and counts it.
+int sys_event_subscribe_queue(uint32_t type_mask, void *queue);
+
+// Stop delivering to a queue registered with sys_event_subscribe_queue().
+int sys_event_unsubscribe_queue(void *queue);
+
+// Queue a copy of evt for the dispatcher and return; never blocks. Any
+// task may emit (not ISRs). Returns 0, or -1 if the dispatch queue is full
+// (the event is dropped and counted).
+int sys_event_emit(const sys_evt_msg_t *evt);
+
+// Wait until every event emitted before the call has been delivered.
+// Returns 0, or -1 on timeout or when called from a subscriber callback.
+int sys_event_flush(uint32_t timeout_ms);
+
+// Bus counters since boot.
+void sys_event_get_stats(sys_event_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
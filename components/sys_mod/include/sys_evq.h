@@ -0,0 +1,69 @@
+/**
+ * @file sys_evq.h
+ * @brief Bounded lock-free MPSC queue of system events
+ *
+ * Any number of tasks push; one consumer (the event dispatcher) pops. Each
+ * cell carries a sequence number, so producers claim a cell with one CAS
+ * and never wait for each other. A full queue drops the new event and
+ * counts it.
+ *
+ * Push and pop never block: how the consumer waits for work is left to
+ * sys_mod_api.c, which owns the device instance and its dispatcher task.
+ * test_evq.c runs several producer threads against one queue on the host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sys_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYS_EVQ_SIZE 32     // Power of two
+
+typedef struct {
+    uint32_t seq;           // == position: free; == position + 1: holds an event
+    sys_evt_msg_t msg;
+} sys_evq_cell_t;
+
+typedef struct {
+    sys_evq_cell_t cells[SYS_EVQ_SIZE];
+    uint32_t head;          // Next position to claim (producers)
+    uint32_t tail;          // Next position to pop (consumer only)
+    uint32_t pushed;        // Events accepted
+    uint32_t dropped;       // Events refused: queue full
+    uint32_t high_water;    // Most events queued at once
+} sys_evq_t;
+
+void sys_evq_init(sys_evq_t *q);
+
+/**
+ * @brief Queue a copy of @p msg (any task)
+ * @return false if the queue was full; the event is dropped and counted
+ */
+bool sys_evq_push(sys_evq_t *q, const sys_evt_msg_t *msg);
+
+/**
+ * @brief Take the oldest event (consumer only)
+ *
+ * @return false if empty, or if the oldest event's producer has claimed
+ *         its cell but not finished writing it; that producer's own wake-up
+ *         follows
+ */
+bool sys_evq_pop(sys_evq_t *q, sys_evt_msg_t *out);
+
+/**
+ * @brief Would sys_evq_pop() succeed now? (consumer only)
+ */
+static inline bool sys_evq_ready(const sys_evq_t *q)
+{
+    const sys_evq_cell_t *cell = &q->cells[q->tail & (SYS_EVQ_SIZE - 1)];
+    return __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) == q->tail + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
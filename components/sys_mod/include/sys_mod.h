@@ -80,7 +80,7 @@ sys_status_t sys_system_control(sys_cmd_type_t cmd);
  * 2. Create mutexes
  * 3. Load configuration from NVS (or defaults)
  * 4. Allocate DMX buffers
- * 5. Create lazy save timer
+ * 5. Start config persistence worker
  * 
  * @return ESP_OK on success, error code otherwise
  */
@@ -91,13 +91,44 @@ esp_err_t sys_mod_init(void);
 /**
  * @brief Get read-only pointer to system configuration
  * 
- * Thread-safety: YES (read-only pointer)
- * Performance: O(1), no mutex
+ * Returns the current published snapshot. A snapshot never changes: an
+ * update publishes a new one, so every field read through the pointer
+ * belongs to the same configuration. Call again at least once a second
+ * (e.g. once per loop iteration); a replaced snapshot is reused after that.
+ * 
+ * Thread-safety: YES (immutable snapshot)
+ * Performance: O(1), one atomic load, no mutex
  * 
- * @return Pointer to global config (do NOT modify directly)
+ * @return Pointer to config snapshot (do NOT modify)
  */
 const sys_config_t* sys_get_config(void);
 
+/**
+ * @brief Publication generation of a snapshot from sys_get_config()
+ * 
+ * Increases with every published change (unrelated to cfg->version, the
+ * layout version). Subsystems can cache state derived from the config and
+ * rebuild it only when the generation moves.
+ * 
+ * @param cfg Pointer returned by sys_get_config()
+ * @return Generation, 0 before the configuration was first loaded
+ */
+uint32_t sys_config_generation(const sys_config_t* cfg);
+
+/**
+ * @brief Copy the current configuration
+ * 
+ * For callers that may be preempted for long (web handlers, the persistence
+ * worker): unlike holding the sys_get_config() pointer, the copy is never
+ * torn, however long the caller is suspended.
+ * 
+ * Thread-safety: YES (lock-free, retries if a writer reuses the snapshot)
+ * 
+ * @param out Destination
+ * @return Generation of the copied snapshot (see sys_config_generation())
+ */
+uint32_t sys_config_copy(sys_config_t* out);
+
 /**
  * @brief Update port configuration (Hot-swap capable)
  * 
@@ -105,11 +136,14 @@ const sys_config_t* sys_get_config(void);
  * - break_us: 88-500
  * - mab_us: 8-100
  * - universe: 0-32767
+ * - slot_count: 0-512 or DMX_SLOTS_AUTO
  * 
  * Thread-safety: YES (mutex protected)
- * Triggers: Lazy save timer (5 seconds)
+ * Blocking: no. A burst of updates (three within a second) is published
+ * together up to 1 s later (see sys_config_edit_begin())
+ * Triggers: Config save once updates settle (5 s quiet, 30 s at most)
  * 
- * @param port_idx Port index (0-3)
+ * @param port_idx Port index (0 to SYS_MAX_PORTS - 1)
  * @param new_cfg New configuration
  * @return ESP_OK if valid, ESP_ERR_INVALID_ARG otherwise
  */
@@ -145,14 +179,31 @@ esp_err_t sys_update_device_label(const char* label);
 esp_err_t sys_update_led_brightness(uint8_t brightness);
 
 /**
- * @brief Force immediate save to NVS (bypass lazy timer)
+ * @brief Force immediate save to NVS (bypass persistence worker)
  * 
  * Use case: User clicks "Save" button, OTA update preparation
+ * Skips the write if flash already holds the current config.
  * 
  * @return ESP_OK on success, ESP_ERR_NVS_* on failure
  */
 esp_err_t sys_save_config_now(void);
 
+typedef struct {
+    uint32_t requests;      // Config changes seen by the worker
+    uint32_t commits;       // Records written to flash
+    uint32_t unchanged;     // Saves skipped: flash already held the image
+    uint32_t seq;           // Sequence number of the newest record
+    int8_t slot;            // Slot holding it (0/1), -1 if none yet
+} sys_persist_stats_t;
+
+/**
+ * @brief Config persistence counters
+ *
+ * Every published change is a request; a burst of them becomes one save,
+ * so commits stays well below requests.
+ */
+void sys_persist_get_stats(sys_persist_stats_t* out);
+
 /**
  * @brief Factory reset - erase NVS and load defaults
  * 
@@ -160,16 +211,40 @@ esp_err_t sys_save_config_now(void);
  */
 esp_err_t sys_factory_reset(void);
 
+/**
+ * @brief Bracket a flash write (NVS set / commit / erase)
+ *
+ * While flash is written the cache is off: both cores run nothing but IRAM
+ * code until the write ends. Every NVS write made while DMX output runs
+ * goes between these two calls so MOD_DMX can tell frames delayed by flash
+ * from ordinary lateness. Any task; brackets may overlap.
+ */
+void sys_flash_write_begin(void);
+void sys_flash_write_end(void);
+
+/**
+ * @brief Flash writes begun so far (wraps at 2^32)
+ *
+ * In IRAM, like sys_flash_write_active(): both are polled by the DMX task.
+ */
+uint32_t sys_flash_write_count(void);
+
+/**
+ * @brief True while a bracketed flash write is in progress
+ */
+bool sys_flash_write_active(void);
+
 /* ========== DMX BUFFER ACCESS ========== */
 
 /**
  * @brief Get pointer to DMX buffer for a port
  * 
  * Usage:
- * - MOD_PROTO: Write incoming packet data
- * - MOD_DMX: Read for transmission
+ * - MOD_PROTO: Write incoming packet data, then sys_dmx_commit()
+ * - MOD_DMX: do not transmit from it, use sys_dmx_acquire_frame()
  * 
- * Thread-safety: YES (pointer is stable, never freed)
+ * Thread-safety: pointer is stable, never freed; contents are the writer's
+ * working copy and may change at any time
  * Performance: O(1)
  * 
  * @param port_idx Port index (0-3)
@@ -177,6 +252,36 @@ esp_err_t sys_factory_reset(void);
  */
 uint8_t* sys_get_dmx_buffer(int port_idx);
 
+/**
+ * @brief Publish the port's DMX buffer as a complete frame
+ * 
+ * Copies the buffer into the port's triple buffer and hands it to the
+ * output task without a lock. Call from the single writer (MOD_PROTO)
+ * after each change.
+ * 
+ * Thread-safety: one writer per port
+ * Performance: one 512-byte copy and an atomic exchange
+ * 
+ * @param port_idx Port index (0-3)
+ * @return Generation of the published frame, 0 if invalid port
+ */
+uint32_t sys_dmx_commit(int port_idx);
+
+/**
+ * @brief Newest complete frame for a port
+ * 
+ * Never torn: the frame stays unchanged until the caller's next call for
+ * the same port, however often the writer commits meanwhile.
+ * 
+ * Thread-safety: one reader per port (MOD_DMX task)
+ * Performance: O(1), lock-free
+ * 
+ * @param port_idx Port index (0-3)
+ * @param gen Optional; receives the frame generation (0 before any commit)
+ * @return Pointer to 512-byte frame, or NULL if invalid port
+ */
+const uint8_t* sys_dmx_acquire_frame(int port_idx, uint32_t* gen);
+
 /**
  * @brief Notify activity on port (reset watchdog timer)
  * 
@@ -198,6 +303,42 @@ void sys_notify_activity(int port_idx);
  */
 int64_t sys_get_last_activity(int port_idx);
 
+/**
+ * @brief Hook called by sys_notify_activity() after new data was written
+ *
+ * Runs in the caller's (MOD_PROTO) context; keep it short.
+ *
+ * @param port_idx Port index (0-3)
+ * @param timestamp_us Activity timestamp just recorded (esp_timer_get_time)
+ */
+typedef void (*sys_dmx_update_hook_t)(int port_idx, int64_t timestamp_us);
+
+/**
+ * @brief Install the DMX update hook (one slot, NULL to remove)
+ *
+ * Used by MOD_DMX to start a frame as soon as a port's buffer changes.
+ */
+void sys_set_dmx_update_hook(sys_dmx_update_hook_t hook);
+
+/**
+ * @brief Record how many channels a source wrote to a port
+ *
+ * Called by MOD_PROTO for every merged packet. The port keeps the highest
+ * value seen since its config last changed; MOD_DMX uses it as the frame
+ * length for ports with slot_count == DMX_SLOTS_AUTO.
+ *
+ * Thread-safety: YES (single 16-bit store)
+ *
+ * @param port_idx Port index (0-3)
+ * @param slots Channels carried by the packet (1-512)
+ */
+void sys_note_slot_extent(int port_idx, uint16_t slots);
+
+/**
+ * @brief Highest channel count written to a port, 0 if none yet
+ */
+uint16_t sys_get_slot_extent(int port_idx);
+
 /* ========== INTERNAL / Advanced Accessors ==========
  * These helpers are used by initialization and internal modules.
  * Consider them advanced APIs; use sparingly.
@@ -209,9 +350,31 @@ int64_t sys_get_last_activity(int port_idx);
 sys_state_t* sys_get_state(void);
 
 /**
- * @brief Get pointer to mutable config for init/load routines
+ * @brief Start a config change: lock writers and get a private draft
+ *
+ * The draft starts as a copy of the current config, including edits
+ * still waiting to be published. Finish with sys_config_publish() or
+ * sys_config_edit_cancel().
+ *
+ * Waits only for another writer's edit (a memcpy), never for a grace
+ * period. If no snapshot slot is reclaimable yet (three publications
+ * within a second), the draft is kept aside and a timer publishes it
+ * once one is: readers may see the change up to 1 s late.
+ */
+sys_config_t* sys_config_edit_begin(void);
+
+/**
+ * @brief Make the draft the current config, rebuild routing, unlock writers
+ *
+ * A draft kept aside by sys_config_edit_begin() becomes current later,
+ * from the esp_timer task.
  */
-sys_config_t* sys_get_config_mutable(void);
+void sys_config_publish(void);
+
+/**
+ * @brief Discard the draft and unlock writers
+ */
+void sys_config_edit_cancel(void);
 
 /**
  * @brief Get read-only pointer to the default configuration template
@@ -221,12 +384,22 @@ const sys_config_t* sys_get_default_config(void);
 /* ========== ROUTING ========== */
 
 /**
- * @brief Find port index for given protocol and universe
+ * @brief Find all ports fed by a protocol and universe
  * 
- * Used by MOD_PROTO to route incoming packets.
+ * Used by MOD_PROTO to route incoming packets; one universe may drive
+ * several ports.
  * 
- * Algorithm: Linear search through ports[] array
- * Performance: O(4) worst case
+ * Algorithm: Hash lookup in an index rebuilt whenever port config changes
+ * Performance: O(1), no mutex
+ * 
+ * @param protocol PROTOCOL_ARTNET or PROTOCOL_SACN
+ * @param universe Universe ID (0-32767)
+ * @return Bitmask of port indices (bit n = port n), 0 if no match
+ */
+uint32_t sys_route_find_ports(uint8_t protocol, uint16_t universe);
+
+/**
+ * @brief Find the lowest port index for given protocol and universe
  * 
  * @param protocol PROTOCOL_ARTNET or PROTOCOL_SACN
  * @param universe Universe ID (0-32767)
@@ -234,6 +407,20 @@ const sys_config_t* sys_get_default_config(void);
  */
 int8_t sys_route_find_port(uint8_t protocol, uint16_t universe);
 
+/**
+ * @brief Receive pre-filter: is any port configured for this universe?
+ * 
+ * Checks a 32768-bit bitmap of the low 15 bits of every enabled port's
+ * universe, ignoring protocol. false means no port can use the packet;
+ * true still needs sys_route_find_ports() to pick the ports.
+ * 
+ * Performance: one word load, no mutex
+ * 
+ * @param universe Universe ID / Art-Net port-address
+ * @return false if the packet can be dropped unread
+ */
+bool sys_route_universe_used(uint16_t universe);
+
 /* ========== SNAPSHOT ========== */
 
 /**
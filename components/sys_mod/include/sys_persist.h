@@ -0,0 +1,115 @@
+/**
+ * @file sys_persist.h
+ * @brief A/B journal records for the persisted configuration
+ *
+ * The config is stored in two NVS slots, each holding a record with a
+ * sequence number. A save always overwrites the slot that does not hold
+ * the newest valid record, so if power fails mid-write the other slot
+ * still has the previous config. On load the valid record with the higher
+ * sequence number wins.
+ *
+ * Records are sealed and checked here as plain memory; sys_nvs.c moves
+ * them to and from NVS and owns the journal state. test_persist.c replays
+ * power cuts at many points of a slot write.
+ *
+ * Records written by a build with another port count (or a version 1
+ * config, always 4 ports) have another size. sys_persist_upgrade() checks
+ * them against their own size and rebuilds them in this build's layout;
+ * ports the image lacks take their defaults, extra ones are dropped.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "dmx_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYS_PERSIST_MAGIC 0x4A43464Eu   // Record header; distinct from SYS_CONFIG_MAGIC
+#define SYS_PERSIST_SLOTS 2
+
+/* Config image and journal record sizes for @p n ports */
+#define SYS_PERSIST_CFG_SIZE(n)   (sizeof(sys_config_t) + ((n) - SYS_MAX_PORTS) * sizeof(dmx_port_cfg_t))
+#define SYS_PERSIST_REC_SIZE(n)   (3 * sizeof(uint32_t) + SYS_PERSIST_CFG_SIZE(n))
+#define SYS_PERSIST_REC_MAX       SYS_PERSIST_REC_SIZE(SYS_PORTS_LIMIT)   // Staging for any layout
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;         // SYS_PERSIST_MAGIC
+    uint32_t seq;           // Higher is newer (wraps; compared as a signed difference)
+    uint32_t crc32;         // Over seq and cfg, except cfg.crc32
+    sys_config_t cfg;       // CRC-stamped config image
+} sys_persist_record_t;
+
+/* Change mask returned by sys_persist_diff() */
+#define SYS_PERSIST_CHG_LABEL     (1u << 0)
+#define SYS_PERSIST_CHG_LED       (1u << 1)
+#define SYS_PERSIST_CHG_NET       (1u << 2)
+#define SYS_PERSIST_CHG_FAILSAFE  (1u << 3)
+#define SYS_PERSIST_CHG_OTHER     (1u << 4)   // Header, version or reserved bytes
+#define SYS_PERSIST_CHG_PORT(n)   (1u << (8 + (n)))
+
+/**
+ * @brief Fill in magic, sequence number and CRC of a record
+ *
+ * @p rec->cfg must already be final, including its own crc32.
+ */
+void sys_persist_seal(sys_persist_record_t *rec, uint32_t seq);
+
+/**
+ * @brief True if the record is complete: magic, record CRC and the
+ *        config's own magic and CRC all check out
+ */
+bool sys_persist_valid(const sys_persist_record_t *rec);
+
+/**
+ * @brief Slot holding the newest valid record
+ *
+ * @param recs One record per slot; NULL for a slot that could not be read
+ * @return Slot index, or -1 if no slot holds a valid record
+ */
+int sys_persist_newest(const sys_persist_record_t *const recs[SYS_PERSIST_SLOTS]);
+
+/**
+ * @brief Slot the next save goes to: never the one holding @p newest
+ */
+static inline int sys_persist_next_slot(int newest)
+{
+    return newest < 0 ? 0 : (newest + 1) % SYS_PERSIST_SLOTS;
+}
+
+/**
+ * @brief Check a bare config image of any supported layout and convert it
+ *
+ * @param img      Image as stored, @p len bytes
+ * @param defaults Source of ports the image does not have
+ * @param out      This build's layout, version and CRC
+ * @return false if the image is not a complete config (size, magic, CRC)
+ */
+bool sys_persist_upgrade_config(const void *img, size_t len, const sys_config_t *defaults,
+                                sys_config_t *out);
+
+/**
+ * @brief Check a journal record of any supported layout and convert it
+ *
+ * The result keeps the sequence number and is resealed, so it passes
+ * sys_persist_valid() and takes part in sys_persist_newest() as usual.
+ * A record of this version and port count comes out byte for byte equal.
+ *
+ * @return false if the record is not complete in its own layout
+ */
+bool sys_persist_upgrade(const void *blob, size_t len, const sys_config_t *defaults,
+                         sys_persist_record_t *out);
+
+/**
+ * @brief Which parts of the config differ (crc32 is ignored)
+ * @return SYS_PERSIST_CHG_* mask, 0 if the images are equal
+ */
+uint32_t sys_persist_diff(const sys_config_t *a, const sys_config_t *b);
+
+#ifdef __cplusplus
+}
+#endif
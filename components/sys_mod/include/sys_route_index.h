@@ -0,0 +1,72 @@
+/**
+ * @file sys_route_index.h
+ * @brief Open-addressing hash from (protocol, universe) to a port bitmask
+ *
+ * The caller provides the table and its size. sys_route.c keeps two
+ * SYS_ROUTE_SLOTS tables and publishes them alternately; test_route.c
+ * sizes them for up to 512 routes to compare lookups with a linear scan.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Key 0 marks a free entry, so a zeroed table is a valid empty index */
+#define SYS_ROUTE_EMPTY 0u
+#define SYS_ROUTE_KEY(protocol, universe) ((((uint32_t)(protocol) + 1u) << 16) | (uint16_t)(universe))
+
+/* Entries in the device index: a power of two, at least twice the number
+ * of ports so probe chains stay short */
+#define SYS_ROUTE_SLOTS 16
+
+typedef struct {
+    uint32_t key;       // SYS_ROUTE_KEY() or SYS_ROUTE_EMPTY
+    uint32_t ports;     // Bit n set: port n outputs this universe
+} sys_route_entry_t;
+
+static inline uint32_t sys_route_index_hash(uint32_t key, size_t slots)
+{
+    // Fibonacci hashing; slots must be a power of two
+    return ((key * 0x9E3779B1u) >> 16) & (uint32_t)(slots - 1);
+}
+
+/**
+ * @brief Mark every entry free
+ */
+void sys_route_index_clear(sys_route_entry_t *tab, size_t slots);
+
+/**
+ * @brief Add @p port to the bitmask for (@p protocol, @p universe)
+ *
+ * @param port Port index (0-31)
+ * @return false if the key is new and the table is full
+ */
+bool sys_route_index_add(sys_route_entry_t *tab, size_t slots,
+                         uint8_t protocol, uint16_t universe, uint8_t port);
+
+/**
+ * @brief Bitmask of ports fed by (@p protocol, @p universe), 0 if none
+ */
+static inline uint32_t sys_route_index_lookup(const sys_route_entry_t *tab, size_t slots,
+                                              uint8_t protocol, uint16_t universe)
+{
+    uint32_t key = SYS_ROUTE_KEY(protocol, universe);
+    uint32_t i = sys_route_index_hash(key, slots);
+    for (size_t n = 0; n < slots; n++) {
+        const sys_route_entry_t *e = &tab[i];
+        if (e->key == key) return e->ports;
+        if (e->key == SYS_ROUTE_EMPTY) return 0;
+        i = (i + 1) & (uint32_t)(slots - 1);
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
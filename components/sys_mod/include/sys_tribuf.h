@@ -0,0 +1,70 @@
+/**
+ * @file sys_tribuf.h
+ * @brief Lock-free triple buffer for one DMX universe
+ *
+ * One writer (MOD_PROTO) and one reader (the DMX task) exchange whole
+ * frames without a lock: the writer fills its own slot and swaps it with
+ * the pending slot; the reader swaps its slot with the pending one when a
+ * newer frame is there. Each side only ever touches the slot it owns, so
+ * the reader always sees a complete frame. Frames the reader never picked
+ * up are overwritten; nobody waits.
+ *
+ * The whole exchange is one atomic swap of a slot index, so it needs no
+ * scheduler support; test_tribuf.c races a writer and a reader thread on
+ * the host. sys_buffer.c owns the per-port instances.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dmx_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t  frame[3][DMX_UNIVERSE_SIZE] __attribute__((aligned(4)));
+    uint32_t gen[3];        // Generation of the frame in each slot
+    uint8_t  pending;       // Slot index | SYS_TRIBUF_FRESH; the only shared word
+    uint8_t  write_idx;     // Writer's slot
+    uint8_t  read_idx;      // Reader's slot
+    uint32_t next_gen;      // Writer only
+} sys_tribuf_t;
+
+#define SYS_TRIBUF_FRESH 0x04u  // Pending slot holds a frame the reader has not taken
+
+/**
+ * @brief Zero all slots; the reader starts on a blank frame of generation 0
+ */
+void sys_tribuf_init(sys_tribuf_t *tb);
+
+/**
+ * @brief Writer: slot to fill (contents are stale, write the whole frame)
+ */
+static inline uint8_t *sys_tribuf_write_slot(sys_tribuf_t *tb)
+{
+    return tb->frame[tb->write_idx];
+}
+
+/**
+ * @brief Writer: hand the filled slot to the reader
+ * @return Generation of the published frame
+ */
+uint32_t sys_tribuf_publish(sys_tribuf_t *tb);
+
+/**
+ * @brief Reader: newest complete frame
+ *
+ * The frame stays valid and unchanged until the next call.
+ *
+ * @param gen Optional; receives the frame's generation (1 for the first
+ *            published frame, 0 before any)
+ * @return true if the frame is newer than the one returned last time
+ */
+bool sys_tribuf_acquire(sys_tribuf_t *tb, const uint8_t **frame, uint32_t *gen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,6 +4,7 @@
  */
 
 #include "sys_mod.h"
+#include "sys_tribuf.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
@@ -11,6 +12,12 @@
 
 static const char* TAG = "SYS_BUF";
 
+static volatile sys_dmx_update_hook_t s_update_hook = NULL;
+static volatile uint16_t s_slot_extent[SYS_MAX_PORTS];
+
+/* Complete frames handed from MOD_PROTO to MOD_DMX */
+static sys_tribuf_t s_frames[SYS_MAX_PORTS];
+
 /* Forward declaration */
 extern sys_state_t* sys_get_state(void);
 
@@ -39,6 +46,7 @@ esp_err_t sys_buffer_init(void) {
         
         // Initialize to zeros
         memset(state->dmx_buffers[i], 0, DMX_UNIVERSE_SIZE);
+        sys_tribuf_init(&s_frames[i]);
         
         // Initialize activity timestamp
         state->last_activity[i] = 0;
@@ -62,6 +70,26 @@ uint8_t* sys_get_dmx_buffer(int port_idx) {
     return state->dmx_buffers[port_idx];
 }
 
+uint32_t sys_dmx_commit(int port_idx) {
+    if (port_idx < 0 || port_idx >= SYS_MAX_PORTS) {
+        return 0;
+    }
+
+    sys_state_t* state = sys_get_state();
+    memcpy(sys_tribuf_write_slot(&s_frames[port_idx]), state->dmx_buffers[port_idx], DMX_UNIVERSE_SIZE);
+    return sys_tribuf_publish(&s_frames[port_idx]);
+}
+
+const uint8_t* sys_dmx_acquire_frame(int port_idx, uint32_t* gen) {
+    if (port_idx < 0 || port_idx >= SYS_MAX_PORTS) {
+        return NULL;
+    }
+
+    const uint8_t* frame;
+    sys_tribuf_acquire(&s_frames[port_idx], &frame, gen);
+    return frame;
+}
+
 /* ========== ACTIVITY TRACKING ========== */
 
 void sys_notify_activity(int port_idx) {
@@ -70,7 +98,40 @@ void sys_notify_activity(int port_idx) {
     }
     
     sys_state_t* state = sys_get_state();
-    state->last_activity[port_idx] = esp_timer_get_time();
+    int64_t now = esp_timer_get_time();
+    state->last_activity[port_idx] = now;
+
+    sys_dmx_update_hook_t hook = s_update_hook;
+    if (hook) hook(port_idx, now);
+}
+
+void sys_set_dmx_update_hook(sys_dmx_update_hook_t hook) {
+    s_update_hook = hook;
+}
+
+/* ========== SLOT EXTENT (auto slot count) ========== */
+
+void sys_note_slot_extent(int port_idx, uint16_t slots) {
+    if (port_idx < 0 || port_idx >= SYS_MAX_PORTS) {
+        return;
+    }
+    if (slots > DMX_UNIVERSE_SIZE) slots = DMX_UNIVERSE_SIZE;
+    // Only the proto task writes; a lost race just delays growth by a packet
+    if (slots > s_slot_extent[port_idx]) s_slot_extent[port_idx] = slots;
+}
+
+uint16_t sys_get_slot_extent(int port_idx) {
+    if (port_idx < 0 || port_idx >= SYS_MAX_PORTS) {
+        return 0;
+    }
+    return s_slot_extent[port_idx];
+}
+
+void sys_reset_slot_extent(int port_idx) {
+    if (port_idx < 0 || port_idx >= SYS_MAX_PORTS) {
+        return;
+    }
+    s_slot_extent[port_idx] = 0;
 }
 
 int64_t sys_get_last_activity(int port_idx) {
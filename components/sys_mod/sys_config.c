@@ -9,24 +9,70 @@
 #include "esp_crc.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 #include <string.h>
 
 static const char* TAG = "SYS_CFG";
 
+/* Internal (sys_buffer.c, sys_route.c) */
+extern void sys_reset_slot_extent(int port_idx);
+extern void sys_route_rebuild(void);
+
 /* ========== GLOBAL VARIABLES ========== */
 
-// Global configuration (512 bytes in .bss)
-static sys_config_t g_sys_config;
+/*
+ * Published configuration (RCU style). Readers load one pointer and get an
+ * immutable snapshot; writers (serialized by config_mutex) fill a free slot
+ * and swap the pointer. A replaced slot is reused only after
+ * SYS_CONFIG_GRACE_US, so readers may use a snapshot for that long.
+ *
+ * A preempted reader can outlive the grace period, so readers that copy
+ * the whole config (sys_config_copy()) also check the slot's generation
+ * like a seqlock: a slot being refilled has SYS_CONFIG_GEN_FILLING, and the
+ * copy is retried if the generation changed under it.
+ *
+ * Writers never wait out a grace period. When every other slot is still in
+ * its grace period (a third publication within SYS_CONFIG_GRACE_US), the
+ * edit lands in s_config_pending instead, and edits made meanwhile pile
+ * onto it; s_pending_timer publishes it once a slot can be reclaimed. So
+ * readers may see such an edit up to SYS_CONFIG_GRACE_US late.
+ */
+#define SYS_CONFIG_SLOTS    3
+#define SYS_CONFIG_GRACE_US (1000 * 1000)
+#define SYS_CONFIG_GEN_FILLING UINT32_MAX
+
+typedef struct {
+    sys_config_t cfg;
+    uint32_t generation;        // Bumped on every publication
+    int64_t retired_us;         // When it stopped being current, 0 if never published
+} sys_config_slot_t;
+
+static sys_config_slot_t s_config_slots[SYS_CONFIG_SLOTS];
+static sys_config_slot_t* s_config_current = &s_config_slots[0];
+static sys_config_slot_t* s_config_draft;   // Slot being edited, under config_mutex
+
+// Edits waiting for a free slot, and the draft made on top of them. Under
+// config_mutex; s_config_has_pending is also read outside it.
+static sys_config_t s_config_pending;
+static sys_config_t s_config_scratch;
+static bool s_config_has_pending;
+static esp_timer_handle_t s_pending_timer;
 
 // Runtime state
 static sys_state_t g_sys_state;
 
+// Port n on universe n; only C and D start enabled
+#define DEFAULT_PORT(n, en) \
+    {.enabled = (en), .protocol = PROTOCOL_ARTNET, .universe = (n), .rdm_enabled = false, \
+     .timing = {.break_us = 176, .mab_us = 12, .refresh_rate = 40}}
+
 // Default configuration template
 static const sys_config_t DEFAULT_CONFIG = {
     .magic_number = SYS_CONFIG_MAGIC,
     .version = SYS_CONFIG_VERSION,
     .device_label = "DMX-Node-V4",
     .led_brightness = 50,
+    .port_count = SYS_MAX_PORTS,
     .reserved1 = {0},
     
     .net = {
@@ -58,14 +104,14 @@ static const sys_config_t DEFAULT_CONFIG = {
     },
     
     .ports = {
-        {.enabled = false, .protocol = PROTOCOL_ARTNET, .universe = 0, .rdm_enabled = false, 
-         .timing = {.break_us = 176, .mab_us = 12, .refresh_rate = 40}},
-        {.enabled = false, .protocol = PROTOCOL_ARTNET, .universe = 1, .rdm_enabled = false,
-         .timing = {.break_us = 176, .mab_us = 12, .refresh_rate = 40}},
-        {.enabled = true, .protocol = PROTOCOL_ARTNET, .universe = 2, .rdm_enabled = false,
-         .timing = {.break_us = 176, .mab_us = 12, .refresh_rate = 40}},
-        {.enabled = true, .protocol = PROTOCOL_ARTNET, .universe = 3, .rdm_enabled = false,
-         .timing = {.break_us = 176, .mab_us = 12, .refresh_rate = 40}}
+        DEFAULT_PORT(0, false), DEFAULT_PORT(1, false), DEFAULT_PORT(2, true), DEFAULT_PORT(3, true),
+#if SYS_MAX_PORTS > 4
+        DEFAULT_PORT(4, false), DEFAULT_PORT(5, false), DEFAULT_PORT(6, false), DEFAULT_PORT(7, false),
+#endif
+#if SYS_MAX_PORTS > 8
+        DEFAULT_PORT(8, false), DEFAULT_PORT(9, false), DEFAULT_PORT(10, false), DEFAULT_PORT(11, false),
+        DEFAULT_PORT(12, false), DEFAULT_PORT(13, false), DEFAULT_PORT(14, false), DEFAULT_PORT(15, false),
+#endif
     },
     
     .failsafe = {
@@ -81,13 +127,124 @@ static const sys_config_t DEFAULT_CONFIG = {
 /* ========== FORWARD DECLARATIONS ========== */
 esp_err_t sys_load_config_from_nvs(void);
 esp_err_t sys_save_config_to_nvs(void);
-void sys_lazy_save_callback(void* arg);  // Non-static, used by timer in sys_setup.c
+void sys_persist_request(void);
 uint32_t sys_calculate_config_crc(const sys_config_t* cfg);  // Non-static for sys_nvs.c
 
 /* ========== CONFIGURATION ACCESS ========== */
 
 const sys_config_t* sys_get_config(void) {
-    return &g_sys_config;
+    // Acquire: pairs with the release in sys_config_publish()
+    return &__atomic_load_n(&s_config_current, __ATOMIC_ACQUIRE)->cfg;
+}
+
+uint32_t sys_config_generation(const sys_config_t* cfg) {
+    return ((const sys_config_slot_t*)cfg)->generation;  // cfg is the slot's first member
+}
+
+// Oldest retired slot and how long until readers may have let go of it
+static sys_config_slot_t* sys_config_free_slot(int64_t* wait_us) {
+    sys_config_slot_t* cur = __atomic_load_n(&s_config_current, __ATOMIC_ACQUIRE);
+    sys_config_slot_t* slot = NULL;
+    for (int i = 0; i < SYS_CONFIG_SLOTS; i++) {
+        sys_config_slot_t* s = &s_config_slots[i];
+        if (s == cur) continue;
+        if (!slot || s->retired_us < slot->retired_us) slot = s;
+    }
+    *wait_us = slot->retired_us != 0 ?
+               slot->retired_us + SYS_CONFIG_GRACE_US - esp_timer_get_time() : 0;
+    return slot;
+}
+
+sys_config_t* sys_config_edit_begin(void) {
+    SemaphoreHandle_t mutex = (SemaphoreHandle_t)g_sys_state.config_mutex;
+    int64_t wait_us;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    sys_config_slot_t* slot = sys_config_free_slot(&wait_us);
+    const sys_config_t* base = s_config_has_pending ? &s_config_pending : &s_config_current->cfg;
+    if (wait_us > 0) {
+        // No slot reclaimable yet: edit on top of the pending config
+        memcpy(&s_config_scratch, base, sizeof(sys_config_t));
+        s_config_draft = NULL;
+        return &s_config_scratch;
+    }
+
+    // Invalidate before overwriting: copies in progress see the change
+    __atomic_store_n(&slot->generation, SYS_CONFIG_GEN_FILLING, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->cfg, base, sizeof(sys_config_t));
+    s_config_draft = slot;
+    return &slot->cfg;
+}
+
+// esp_timer task: publish the pending edits now that a slot has aged out
+static void sys_config_pending_cb(void* arg) {
+    (void)arg;
+    if (!__atomic_load_n(&s_config_has_pending, __ATOMIC_RELAXED)) return;
+    sys_config_edit_begin();
+    sys_config_publish();   // Re-arms if the slot is somehow not free yet
+}
+
+// Under config_mutex
+static void sys_config_arm_pending(void) {
+    int64_t wait_us;
+    sys_config_free_slot(&wait_us);
+    if (!s_pending_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = sys_config_pending_cb,
+            .name = "cfg_pending",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&args, &s_pending_timer));
+    }
+    if (!esp_timer_is_active(s_pending_timer)) {
+        esp_timer_start_once(s_pending_timer, wait_us > 0 ? (uint64_t)wait_us : 1);
+    }
+}
+
+bool sys_config_has_pending(void) {
+    return __atomic_load_n(&s_config_has_pending, __ATOMIC_RELAXED);
+}
+
+uint32_t sys_config_copy(sys_config_t* out) {
+    for (;;) {
+        const sys_config_slot_t* slot = __atomic_load_n(&s_config_current, __ATOMIC_ACQUIRE);
+        uint32_t gen = __atomic_load_n(&slot->generation, __ATOMIC_ACQUIRE);
+        if (gen == SYS_CONFIG_GEN_FILLING) continue;   // Reused since we loaded it
+        memcpy(out, &slot->cfg, sizeof(sys_config_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->generation, __ATOMIC_RELAXED) == gen) return gen;
+    }
+}
+
+void sys_config_publish(void) {
+    sys_config_slot_t* old = s_config_current;
+    sys_config_slot_t* slot = s_config_draft;
+    s_config_draft = NULL;
+
+    if (!slot) {
+        // Drafted outside the slots: wait in s_config_pending for one
+        memcpy(&s_config_pending, &s_config_scratch, sizeof(sys_config_t));
+        __atomic_store_n(&s_config_has_pending, true, __ATOMIC_RELAXED);
+        sys_config_arm_pending();
+        xSemaphoreGive((SemaphoreHandle_t)g_sys_state.config_mutex);
+        return;
+    }
+    // The draft started from the pending edits, if any: they go out with it
+    __atomic_store_n(&s_config_has_pending, false, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&slot->generation, old->generation + 1, __ATOMIC_RELEASE);
+    // Release: the snapshot is complete before readers can see it
+    __atomic_store_n(&s_config_current, slot, __ATOMIC_RELEASE);
+    old->retired_us = esp_timer_get_time();
+    sys_route_rebuild();
+
+    xSemaphoreGive((SemaphoreHandle_t)g_sys_state.config_mutex);
+    sys_persist_request();  // Saved by the worker once changes settle
+}
+
+void sys_config_edit_cancel(void) {
+    s_config_draft = NULL;  // Slot or scratch was never visible: free again
+    xSemaphoreGive((SemaphoreHandle_t)g_sys_state.config_mutex);
 }
 
 esp_err_t sys_get_config_snapshot(sys_config_t *out, TickType_t ticks_to_wait) {
@@ -96,14 +253,9 @@ esp_err_t sys_get_config_snapshot(sys_config_t *out, TickType_t ticks_to_wait) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    SemaphoreHandle_t mutex = (SemaphoreHandle_t)g_sys_state.config_mutex;
-    if (xSemaphoreTake(mutex, ticks_to_wait) != pdTRUE) {
-        ESP_LOGW(TAG, "sys_get_config_snapshot: mutex take timed out");
-        return ESP_ERR_TIMEOUT;
-    }
+    (void)ticks_to_wait;    // Lock-free: the copy retries if its slot is reused
 
-    memcpy(out, &g_sys_config, sizeof(sys_config_t));
-    xSemaphoreGive(mutex);
+    sys_config_copy(out);
     return ESP_OK;
 }
 
@@ -127,30 +279,46 @@ esp_err_t sys_update_port_cfg(int port_idx, const dmx_port_cfg_t* new_cfg) {
         ESP_LOGE(TAG, "Invalid mab_us: %d (must be 8-100)", new_cfg->timing.mab_us);
         return ESP_ERR_INVALID_ARG;
     }
-    if (new_cfg->timing.refresh_rate < 20 || new_cfg->timing.refresh_rate > 44) {
-        ESP_LOGW(TAG, "Refresh rate %d out of range, clamping to 20-44Hz", new_cfg->timing.refresh_rate);
+    if (new_cfg->slot_count > DMX_UNIVERSE_SIZE && new_cfg->slot_count != DMX_SLOTS_AUTO) {
+        ESP_LOGE(TAG, "Invalid slot_count: %d (must be 0-512 or auto)", new_cfg->slot_count);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (new_cfg->output_mode > DMX_OUTPUT_LATENCY) {
+        ESP_LOGE(TAG, "Invalid output_mode: %d", new_cfg->output_mode);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (new_cfg->loss_timeout_ms != 0 &&
+        (new_cfg->loss_timeout_ms < DMX_LOSS_TIMEOUT_MIN_MS || new_cfg->loss_timeout_ms > DMX_LOSS_TIMEOUT_MAX_MS)) {
+        ESP_LOGE(TAG, "Invalid loss_timeout_ms: %d (must be 0 or %d-%d)", new_cfg->loss_timeout_ms,
+                 DMX_LOSS_TIMEOUT_MIN_MS, DMX_LOSS_TIMEOUT_MAX_MS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    dmx_port_cfg_t applied = *new_cfg;
+    if (applied.timing.refresh_rate < DMX_REFRESH_MIN_HZ || applied.timing.refresh_rate > DMX_REFRESH_MAX_HZ) {
+        ESP_LOGW(TAG, "Refresh rate %d out of range, clamping to %d-%dHz", applied.timing.refresh_rate,
+                 DMX_REFRESH_MIN_HZ, DMX_REFRESH_MAX_HZ);
         // Clamp instead of rejecting
+        applied.timing.refresh_rate = (applied.timing.refresh_rate < DMX_REFRESH_MIN_HZ) ?
+                                      DMX_REFRESH_MIN_HZ : DMX_REFRESH_MAX_HZ;
     }
     
     // Critical Section Start
-    SemaphoreHandle_t mutex = (SemaphoreHandle_t)g_sys_state.config_mutex;
-    xSemaphoreTake(mutex, portMAX_DELAY);
+    sys_config_t* cfg = sys_config_edit_begin();
     
-    // Apply changes
-    memcpy(&g_sys_config.ports[port_idx], new_cfg, sizeof(dmx_port_cfg_t));
+    // Apply changes; a new universe or slot setting restarts slot tracking
+    bool retrack = cfg->ports[port_idx].universe != applied.universe ||
+                   cfg->ports[port_idx].protocol != applied.protocol ||
+                   cfg->ports[port_idx].slot_count != applied.slot_count;
+    memcpy(&cfg->ports[port_idx], &applied, sizeof(dmx_port_cfg_t));
+    if (retrack) sys_reset_slot_extent(port_idx);
     
     // Mark dirty
     g_sys_state.config_dirty = true;
     g_sys_state.last_change_time = esp_timer_get_time();
     
-    xSemaphoreGive(mutex);
+    sys_config_publish();
     // Critical Section End
     
-    // Trigger lazy save timer (5 seconds)
-    esp_timer_handle_t timer = (esp_timer_handle_t)g_sys_state.save_timer;
-    esp_timer_stop(timer);
-    esp_timer_start_once(timer, 5000000); // 5s in microseconds
-    
     ESP_LOGI(TAG, "Port %d config updated (Universe=%d, Protocol=%d)", 
              port_idx, new_cfg->universe, new_cfg->protocol);
     return ESP_OK;
@@ -159,18 +327,13 @@ esp_err_t sys_update_port_cfg(int port_idx, const dmx_port_cfg_t* new_cfg) {
 esp_err_t sys_update_net_cfg(const net_config_t* new_net) {
     if (!new_net) return ESP_ERR_INVALID_ARG;
     
-    SemaphoreHandle_t mutex = (SemaphoreHandle_t)g_sys_state.config_mutex;
-    xSemaphoreTake(mutex, portMAX_DELAY);
+    sys_config_t* cfg = sys_config_edit_begin();
     
-    memcpy(&g_sys_config.net, new_net, sizeof(net_config_t));
+    memcpy(&cfg->net, new_net, sizeof(net_config_t));
     g_sys_state.config_dirty = true;
     g_sys_state.last_change_time = esp_timer_get_time();
     
-    xSemaphoreGive(mutex);
-    
-    esp_timer_handle_t timer = (esp_timer_handle_t)g_sys_state.save_timer;
-    esp_timer_stop(timer);
-    esp_timer_start_once(timer, 5000000);
+    sys_config_publish();
     
     ESP_LOGI(TAG, "Network config updated");
     return ESP_OK;
@@ -179,18 +342,13 @@ esp_err_t sys_update_net_cfg(const net_config_t* new_net) {
 esp_err_t sys_update_device_label(const char* label) {
     if (!label) return ESP_ERR_INVALID_ARG;
     
-    SemaphoreHandle_t mutex = (SemaphoreHandle_t)g_sys_state.config_mutex;
-    xSemaphoreTake(mutex, portMAX_DELAY);
+    sys_config_t* cfg = sys_config_edit_begin();
     
-    strncpy(g_sys_config.device_label, label, sizeof(g_sys_config.device_label) - 1);
-    g_sys_config.device_label[sizeof(g_sys_config.device_label) - 1] = '\0';
+    strncpy(cfg->device_label, label, sizeof(cfg->device_label) - 1);
+    cfg->device_label[sizeof(cfg->device_label) - 1] = '\0';
     g_sys_state.config_dirty = true;
     
-    xSemaphoreGive(mutex);
-    
-    esp_timer_handle_t timer = (esp_timer_handle_t)g_sys_state.save_timer;
-    esp_timer_stop(timer);
-    esp_timer_start_once(timer, 5000000);
+    sys_config_publish();
     
     ESP_LOGI(TAG, "Device label updated: %s", label);
     return ESP_OK;
@@ -202,28 +360,20 @@ esp_err_t sys_update_led_brightness(uint8_t brightness) {
         brightness = 100;
     }
     
-    SemaphoreHandle_t mutex = (SemaphoreHandle_t)g_sys_state.config_mutex;
-    xSemaphoreTake(mutex, portMAX_DELAY);
+    sys_config_t* cfg = sys_config_edit_begin();
     
-    g_sys_config.led_brightness = brightness;
+    cfg->led_brightness = brightness;
     g_sys_state.config_dirty = true;
     
-    xSemaphoreGive(mutex);
-    
-    esp_timer_handle_t timer = (esp_timer_handle_t)g_sys_state.save_timer;
-    esp_timer_stop(timer);
-    esp_timer_start_once(timer, 5000000);
+    sys_config_publish();
     
     return ESP_OK;
 }
 
 esp_err_t sys_save_config_now(void) {
     ESP_LOGI(TAG, "Force save config to NVS");
-    esp_err_t ret = sys_save_config_to_nvs();
-    if (ret == ESP_OK) {
-        g_sys_state.config_dirty = false;
-    }
-    return ret;
+    // Clears config_dirty itself, only if no edit was published or left pending meanwhile
+    return sys_save_config_to_nvs();
 }
 
 /* ========== CRC CALCULATION ========== */
@@ -233,25 +383,6 @@ uint32_t sys_calculate_config_crc(const sys_config_t* cfg) {
     return esp_crc32_le(0, (uint8_t*)cfg, sizeof(sys_config_t) - sizeof(uint32_t));
 }
 
-/* ========== LAZY SAVE CALLBACK ========== */
-
-void sys_lazy_save_callback(void* arg) {
-    (void)arg;
-    
-    if (!g_sys_state.config_dirty) {
-        return; // Nothing to save
-    }
-    
-    ESP_LOGI(TAG, "Lazy save triggered");
-    esp_err_t ret = sys_save_config_to_nvs();
-    if (ret == ESP_OK) {
-        g_sys_state.config_dirty = false;
-        ESP_LOGI(TAG, "Config saved successfully");
-    } else {
-        ESP_LOGE(TAG, "Failed to save config: %d", ret);
-    }
-}
-
 /* ========== GETTERS FOR INTERNAL USE ========== */
 
 // Used by other sys_mod files
@@ -259,10 +390,6 @@ sys_state_t* sys_get_state(void) {
     return &g_sys_state;
 }
 
-sys_config_t* sys_get_config_mutable(void) {
-    return &g_sys_config;
-}
-
 const sys_config_t* sys_get_default_config(void) {
     return &DEFAULT_CONFIG;
 }
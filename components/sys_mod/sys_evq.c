@@ -0,0 +1,61 @@
+/**
+ * @file sys_evq.c
+ * @brief Bounded MPSC event queue (per-cell sequence numbers)
+ */
+
+#include "sys_evq.h"
+#include <string.h>
+
+void sys_evq_init(sys_evq_t *q)
+{
+    memset(q, 0, sizeof(*q));
+    for (uint32_t i = 0; i < SYS_EVQ_SIZE; i++) q->cells[i].seq = i;
+}
+
+bool sys_evq_push(sys_evq_t *q, const sys_evt_msg_t *msg)
+{
+    uint32_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    sys_evq_cell_t *cell;
+    for (;;) {
+        cell = &q->cells[pos & (SYS_EVQ_SIZE - 1)];
+        int32_t dif = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (dif == 0) {
+            // Free for this lap: claim it (on failure pos is reloaded)
+            if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            // Still holds the event from one lap ago: full
+            __atomic_fetch_add(&q->dropped, 1, __ATOMIC_RELAXED);
+            return false;
+        } else {
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->msg = *msg;
+    // Release: the event is written before the consumer can see the cell full
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&q->pushed, 1, __ATOMIC_RELAXED);
+    // The consumer may already be past pos: depth then reads <= 0
+    int32_t depth = (int32_t)(pos + 1 - __atomic_load_n(&q->tail, __ATOMIC_RELAXED));
+    if (depth > (int32_t)__atomic_load_n(&q->high_water, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&q->high_water, (uint32_t)depth, __ATOMIC_RELAXED);  // statistic: a lost race is fine
+    }
+    return true;
+}
+
+bool sys_evq_pop(sys_evq_t *q, sys_evt_msg_t *out)
+{
+    uint32_t pos = q->tail;
+    sys_evq_cell_t *cell = &q->cells[pos & (SYS_EVQ_SIZE - 1)];
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1) return false;
+
+    *out = cell->msg;
+    // Free the cell for the producers' next lap
+    __atomic_store_n(&cell->seq, pos + SYS_EVQ_SIZE, __ATOMIC_RELEASE);
+    __atomic_store_n(&q->tail, pos + 1, __ATOMIC_RELAXED);
+    return true;
+}
@@ -1,4 +1,8 @@
 #include "sys_mod.h"
+#include "sys_evq.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include <string.h>
 
 // This file provides a small, safe stub implementation of the public API declared
@@ -6,7 +10,7 @@
 // implementation; it is intended as a compile-ready placeholder and for unit tests.
 
 static sys_system_status_t s_status;
-static sys_dmx_port_status_t s_ports[4];
+static sys_dmx_port_status_t s_ports[SYS_MAX_PORTS];
 
 /* sys_mod_init/sys_mod_deinit are implemented in sys_setup.c; these stubs were removed to avoid duplicate symbols. */
 
@@ -20,7 +24,7 @@ sys_status_t sys_get_system_status(sys_system_status_t *out)
 sys_status_t sys_get_dmx_status(sys_dmx_port_status_t *out, size_t max_port)
 {
     if (!out || max_port == 0) return SYS_ERR_INVALID;
-    size_t to_copy = (max_port < 4) ? max_port : 4;
+    size_t to_copy = (max_port < SYS_MAX_PORTS) ? max_port : SYS_MAX_PORTS;
     for (size_t i = 0; i < to_copy; ++i) out[i] = s_ports[i];
     return SYS_OK;
 }
@@ -54,42 +58,189 @@ void sys_mod_tick(uint32_t seconds)
     s_status.uptime += seconds;
 }
 
-// ===== Event registration (local lightweight registry) =====
-#define MAX_EVENT_CBS 4
-static sys_event_cb_t s_cbs[MAX_EVENT_CBS];
-static void *s_cb_ctx[MAX_EVENT_CBS];
+// ===== Event bus =====
+// Emitters only push to a lock-free queue; a dispatcher task delivers each
+// event to the subscribers whose mask matches, in emission order, so
+// subscriber work (JSON, socket sends, IGMP joins) never runs in the
+// emitter's context.
+#define SYS_EVENT_TASK_PRIO   5
+#define SYS_EVENT_TASK_STACK  4096
+#define SYS_EVENT_TASK_CORE   0
 
-int sys_event_register_cb(sys_event_cb_t cb, void *user_ctx)
+typedef struct {
+    uint32_t mask;          // 0: free slot
+    sys_event_cb_t cb;      // NULL: queue subscriber
+    void *user_ctx;
+    QueueHandle_t queue;
+} sys_event_sub_t;
+
+enum { BUS_DOWN, BUS_STARTING, BUS_UP };
+
+static sys_evq_t s_evq;
+static sys_event_sub_t s_subs[SYS_EVENT_MAX_SUBSCRIBERS];
+static SemaphoreHandle_t s_sub_mutex;       // Recursive: callbacks may (un)subscribe
+static StaticSemaphore_t s_sub_mutex_buf;
+static TaskHandle_t s_dispatch_task;
+static uint32_t s_bus_state;                // BUS_*
+static bool s_dispatch_idle;                // Dispatcher asleep: the next emitter wakes it
+static uint32_t s_delivered;                // Queue position delivered up to
+static uint32_t s_sub_overflows;
+
+static void sys_event_deliver(const sys_evt_msg_t *evt)
 {
-    if (!cb) return -1;
-    for (int i = 0; i < MAX_EVENT_CBS; ++i) {
-        if (s_cbs[i] == NULL) {
-            s_cbs[i] = cb;
-            s_cb_ctx[i] = user_ctx;
-            return 0;
+    uint32_t bit = SYS_EVT_MASK(evt->type);
+    xSemaphoreTakeRecursive(s_sub_mutex, portMAX_DELAY);
+    for (int i = 0; i < SYS_EVENT_MAX_SUBSCRIBERS; ++i) {
+        sys_event_sub_t *sub = &s_subs[i];
+        if (!(sub->mask & bit)) continue;
+        if (sub->cb) {
+            sub->cb(evt, sub->user_ctx);
+        } else if (xQueueSend(sub->queue, evt, 0) != pdTRUE) {
+            s_sub_overflows++;
         }
     }
-    return -1;
+    xSemaphoreGiveRecursive(s_sub_mutex);
 }
 
-int sys_event_unregister_cb(sys_event_cb_t cb, void *user_ctx)
+static void sys_event_dispatch_task(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        sys_evt_msg_t evt;
+        while (sys_evq_pop(&s_evq, &evt)) {
+            sys_event_deliver(&evt);
+            __atomic_store_n(&s_delivered, s_evq.tail, __ATOMIC_RELEASE);
+        }
+        // Announce the sleep before the last look, so an emitter either
+        // sees the flag or its event is seen here
+        __atomic_store_n(&s_dispatch_idle, true, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (sys_evq_ready(&s_evq)) {
+            __atomic_store_n(&s_dispatch_idle, false, __ATOMIC_RELAXED);
+            continue;
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+// First user starts the bus; concurrent first users wait for it
+static bool sys_event_bus_start(void)
 {
-    for (int i = 0; i < MAX_EVENT_CBS; ++i) {
-        if (s_cbs[i] == cb && s_cb_ctx[i] == user_ctx) {
-            s_cbs[i] = NULL;
-            s_cb_ctx[i] = NULL;
-            return 0;
+    uint32_t state = __atomic_load_n(&s_bus_state, __ATOMIC_ACQUIRE);
+    if (state == BUS_UP) return s_dispatch_task != NULL;
+    if (state == BUS_DOWN &&
+        __atomic_compare_exchange_n(&s_bus_state, &state, BUS_STARTING, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        sys_evq_init(&s_evq);
+        s_sub_mutex = xSemaphoreCreateRecursiveMutexStatic(&s_sub_mutex_buf);
+        TaskHandle_t task = NULL;
+        if (xTaskCreatePinnedToCore(sys_event_dispatch_task, "sys_evt_bus", SYS_EVENT_TASK_STACK, NULL,
+                                    SYS_EVENT_TASK_PRIO, &task, SYS_EVENT_TASK_CORE) != pdPASS) {
+            task = NULL;    // Events queue up but are never delivered
         }
+        s_dispatch_task = task;
+        __atomic_store_n(&s_bus_state, BUS_UP, __ATOMIC_RELEASE);
+        return task != NULL;
+    }
+    while (__atomic_load_n(&s_bus_state, __ATOMIC_ACQUIRE) != BUS_UP) vTaskDelay(1);
+    return s_dispatch_task != NULL;
+}
+
+static int sys_event_add_sub(uint32_t type_mask, sys_event_cb_t cb, void *user_ctx, QueueHandle_t queue)
+{
+    if (type_mask == 0) return -1;
+    sys_event_bus_start();
+    int ret = -1;
+    xSemaphoreTakeRecursive(s_sub_mutex, portMAX_DELAY);
+    for (int i = 0; i < SYS_EVENT_MAX_SUBSCRIBERS; ++i) {
+        if (s_subs[i].mask == 0) {
+            s_subs[i] = (sys_event_sub_t){ .mask = type_mask, .cb = cb, .user_ctx = user_ctx, .queue = queue };
+            ret = 0;
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(s_sub_mutex);
+    return ret;
+}
+
+static int sys_event_remove_sub(sys_event_cb_t cb, void *user_ctx, QueueHandle_t queue)
+{
+    if (__atomic_load_n(&s_bus_state, __ATOMIC_ACQUIRE) != BUS_UP) return -1;
+    int ret = -1;
+    // Waits for a delivery in progress: the subscriber is idle on return
+    xSemaphoreTakeRecursive(s_sub_mutex, portMAX_DELAY);
+    for (int i = 0; i < SYS_EVENT_MAX_SUBSCRIBERS; ++i) {
+        sys_event_sub_t *sub = &s_subs[i];
+        if (sub->mask != 0 && sub->cb == cb && sub->user_ctx == user_ctx && sub->queue == queue) {
+            memset(sub, 0, sizeof(*sub));
+            ret = 0;
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(s_sub_mutex);
+    return ret;
+}
+
+int sys_event_subscribe(uint32_t type_mask, sys_event_cb_t cb, void *user_ctx)
+{
+    if (!cb) return -1;
+    return sys_event_add_sub(type_mask, cb, user_ctx, NULL);
+}
+
+int sys_event_register_cb(sys_event_cb_t cb, void *user_ctx)
+{
+    return sys_event_subscribe(SYS_EVT_MASK_ALL, cb, user_ctx);
+}
+
+int sys_event_unregister_cb(sys_event_cb_t cb, void *user_ctx)
+{
+    if (!cb) return -1;
+    return sys_event_remove_sub(cb, user_ctx, NULL);
+}
+
+int sys_event_subscribe_queue(uint32_t type_mask, void *queue)
+{
+    if (!queue) return -1;
+    return sys_event_add_sub(type_mask, NULL, NULL, (QueueHandle_t)queue);
+}
+
+int sys_event_unsubscribe_queue(void *queue)
+{
+    if (!queue) return -1;
+    return sys_event_remove_sub(NULL, NULL, (QueueHandle_t)queue);
+}
+
+int sys_event_emit(const sys_evt_msg_t *evt)
+{
+    if (!evt) return -1;
+    sys_event_bus_start();
+    if (!sys_evq_push(&s_evq, evt)) return -1;
+    if (__atomic_exchange_n(&s_dispatch_idle, false, __ATOMIC_SEQ_CST) && s_dispatch_task) {
+        xTaskNotifyGive(s_dispatch_task);
     }
-    return -1;
+    return 0;
 }
 
-static void sys_event_emit(const sys_evt_msg_t *evt)
+int sys_event_flush(uint32_t timeout_ms)
 {
-    if (!evt) return;
-    for (int i = 0; i < MAX_EVENT_CBS; ++i) {
-        if (s_cbs[i]) s_cbs[i](evt, s_cb_ctx[i]);
+    if (!sys_event_bus_start()) return -1;
+    if (xTaskGetCurrentTaskHandle() == s_dispatch_task) return -1;
+    uint32_t target = __atomic_load_n(&s_evq.head, __ATOMIC_ACQUIRE);
+    TickType_t start = xTaskGetTickCount();
+    while ((int32_t)(__atomic_load_n(&s_delivered, __ATOMIC_ACQUIRE) - target) < 0) {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms)) return -1;
+        vTaskDelay(1);
     }
+    return 0;
+}
+
+void sys_event_get_stats(sys_event_stats_t *out)
+{
+    if (!out) return;
+    out->emitted = __atomic_load_n(&s_evq.pushed, __ATOMIC_RELAXED);
+    out->dropped = __atomic_load_n(&s_evq.dropped, __ATOMIC_RELAXED);
+    out->queue_high_water = __atomic_load_n(&s_evq.high_water, __ATOMIC_RELAXED);
+    out->subscriber_overflows = __atomic_load_n(&s_sub_overflows, __ATOMIC_RELAXED);
 }
 
 // Example: emit a config-applied event after applying DMX config
@@ -107,12 +258,12 @@ static void emit_config_applied(uint8_t port)
 sys_status_t sys_apply_dmx_config(const sys_dmx_port_status_t *cfg, size_t count)
 {
     if (!cfg || count == 0) return SYS_ERR_INVALID;
-    for (size_t i = 0; i < count && i < 4; ++i) {
+    for (size_t i = 0; i < count && i < SYS_MAX_PORTS; ++i) {
         if (cfg[i].universe > 63999) return SYS_ERR_INVALID;
         if (cfg[i].fps == 0 || cfg[i].fps > 1000) return SYS_ERR_INVALID;
     }
     // Apply and emit
-    for (size_t i = 0; i < count && i < 4; ++i) {
+    for (size_t i = 0; i < count && i < SYS_MAX_PORTS; ++i) {
         s_ports[i] = cfg[i];
         emit_config_applied((uint8_t)i);
     }
@@ -1,12 +1,21 @@
 /**
  * @file sys_nvs.c
  * @brief NVS persistence operations for configuration
+ *
+ * The config is journaled in two NVS slots (sys_persist.h). A worker task
+ * turns bursts of config changes into one save, and a save that would
+ * write the image already in flash is skipped.
  */
 
 #include "sys_mod.h"
+#include "sys_persist.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include <string.h>
 #include <inttypes.h>
 
@@ -14,12 +23,98 @@ static const char* TAG = "SYS_NVS";
 
 /* NVS configuration */
 #define NVS_NAMESPACE "sys_cfg"
-#define NVS_KEY_CONFIG "config"
+#define NVS_KEY_CONFIG "config"     // Pre-journal single image, read only if no slot is valid
+static const char* const NVS_KEY_SLOT[SYS_PERSIST_SLOTS] = { "cfg_a", "cfg_b" };
+
+/* Persistence worker */
+#define PERSIST_QUIET_MS        5000    // Save once changes stop for this long...
+#define PERSIST_MAX_DELAY_MS    30000   // ...but no later than this after the first one
+#define PERSIST_TASK_STACK      4096
+#define PERSIST_TASK_PRIO       2
 
 /* Forward declarations */
-extern sys_config_t* sys_get_config_mutable(void);
 extern const sys_config_t* sys_get_default_config(void);
 uint32_t sys_calculate_config_crc(const sys_config_t* cfg);
+bool sys_config_has_pending(void);
+
+/* Journal state: the newest image in flash and where it is. Guarded by
+ * s_persist_lock, which also serializes every config write and erase. */
+static StaticSemaphore_t s_persist_lock_buf;
+static SemaphoreHandle_t s_persist_lock;
+static sys_persist_record_t s_records[SYS_PERSIST_SLOTS];  // I/O staging
+static uint8_t s_blob[SYS_PERSIST_REC_MAX];     // Raw slot, any port count
+static sys_config_t s_committed;
+static bool s_have_committed;
+static uint32_t s_seq;
+static int s_slot = -1;                 // Slot holding s_committed, -1 if none
+static uint32_t s_commits;
+static uint32_t s_unchanged;
+static uint32_t s_requests;
+static TaskHandle_t s_persist_task;
+
+/* Flash write tracking (sys_flash_write_begin/end) */
+static uint32_t s_flash_writes_begun;
+static uint32_t s_flash_writes_ended;
+
+/* ========== FLASH WRITE TRACKING ========== */
+
+void sys_flash_write_begin(void) {
+    __atomic_fetch_add(&s_flash_writes_begun, 1, __ATOMIC_RELAXED);
+}
+
+void sys_flash_write_end(void) {
+    __atomic_fetch_add(&s_flash_writes_ended, 1, __ATOMIC_RELAXED);
+}
+
+uint32_t sys_flash_write_count(void) {
+    return __atomic_load_n(&s_flash_writes_begun, __ATOMIC_RELAXED);
+}
+
+bool sys_flash_write_active(void) {
+    return __atomic_load_n(&s_flash_writes_begun, __ATOMIC_RELAXED) !=
+           __atomic_load_n(&s_flash_writes_ended, __ATOMIC_RELAXED);
+}
+
+/* ========== JOURNAL ========== */
+
+// First use is sys_init() step 4, before any other task can save, so the
+// lazy creation cannot race
+static void persist_lock(void) {
+    if (!s_persist_lock) s_persist_lock = xSemaphoreCreateMutexStatic(&s_persist_lock_buf);
+    xSemaphoreTake(s_persist_lock, portMAX_DELAY);
+}
+
+static void persist_unlock(void) {
+    xSemaphoreGive(s_persist_lock);
+}
+
+static void persist_forget(void) {
+    s_have_committed = false;
+    s_seq = 0;
+    s_slot = -1;
+}
+
+// Bare config under NVS_KEY_CONFIG, as written before the journal existed
+static esp_err_t load_legacy_config(nvs_handle_t nvs_handle, sys_config_t* out) {
+    size_t size = sizeof(s_blob);
+    esp_err_t ret = nvs_get_blob(nvs_handle, NVS_KEY_CONFIG, s_blob, &size);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NVS read failed: %d", ret);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // Validates magic, size for its port count and CRC32
+    if (!sys_persist_upgrade_config(s_blob, size, sys_get_default_config(), out)) {
+        ESP_LOGE(TAG, "Legacy config invalid (%u bytes)", (unsigned)size);
+        return ESP_ERR_INVALID_CRC;
+    }
+    return ESP_OK;
+}
+
+// Nothing published or waiting for a slot since generation @p gen was copied
+static bool config_saved_all(uint32_t gen) {
+    return sys_config_generation(sys_get_config()) == gen && !sys_config_has_pending();
+}
 
 /* ========== NVS OPERATIONS ========== */
 
@@ -34,42 +129,63 @@ esp_err_t sys_load_config_from_nvs(void) {
         return ESP_ERR_NVS_NOT_FOUND;
     }
     
-    // Read blob
-    sys_config_t temp_config;
-    size_t required_size = sizeof(sys_config_t);
-    ret = nvs_get_blob(nvs_handle, NVS_KEY_CONFIG, &temp_config, &required_size);
+    persist_lock();
     
-    if (ret != ESP_OK || required_size != sizeof(sys_config_t)) {
-        ESP_LOGW(TAG, "NVS read failed or size mismatch: %d (expected %d, got %d)", 
-                 ret, sizeof(sys_config_t), required_size);
-        nvs_close(nvs_handle);
-        return ESP_ERR_INVALID_SIZE;
+    // Read both journal slots; a slot torn by a power cut fails its CRC.
+    // Records from a build with another port count are converted here.
+    const sys_persist_record_t* recs[SYS_PERSIST_SLOTS] = { NULL };
+    bool damaged[SYS_PERSIST_SLOTS] = { false };
+    for (int i = 0; i < SYS_PERSIST_SLOTS; i++) {
+        size_t size = sizeof(s_blob);
+        if (nvs_get_blob(nvs_handle, NVS_KEY_SLOT[i], s_blob, &size) != ESP_OK) continue;
+        if (sys_persist_upgrade(s_blob, size, sys_get_default_config(), &s_records[i])) {
+            recs[i] = &s_records[i];
+            if (size != sizeof(sys_persist_record_t)) {
+                ESP_LOGI(TAG, "Config slot %s converted from %u bytes", NVS_KEY_SLOT[i], (unsigned)size);
+            }
+        } else {
+            damaged[i] = true;
+        }
     }
-    
-    // Validate magic number
-    if (temp_config.magic_number != SYS_CONFIG_MAGIC) {
-        ESP_LOGE(TAG, "Magic number mismatch: 0x%08" PRIx32 " (expected 0x%08" PRIx32 ")", 
-                 temp_config.magic_number, (uint32_t)SYS_CONFIG_MAGIC);
-        nvs_close(nvs_handle);
-        return ESP_ERR_INVALID_CRC;
+    int newest = sys_persist_newest(recs);
+    for (int i = 0; i < SYS_PERSIST_SLOTS; i++) {
+        if (damaged[i]) ESP_LOGW(TAG, "Config slot %s damaged, ignored", NVS_KEY_SLOT[i]);
     }
     
-    // Validate CRC32
-    uint32_t calculated_crc = sys_calculate_config_crc(&temp_config);
-    if (calculated_crc != temp_config.crc32) {
-        ESP_LOGE(TAG, "CRC mismatch: 0x%08" PRIx32 " (expected 0x%08" PRIx32 ")", 
-                 calculated_crc, temp_config.crc32);
-        nvs_close(nvs_handle);
-        return ESP_ERR_INVALID_CRC;
+    sys_config_t temp_config;
+    if (newest >= 0) {
+        memcpy(&temp_config, &s_records[newest].cfg, sizeof(sys_config_t));
+        s_seq = s_records[newest].seq;
+        s_slot = newest;
+    } else {
+        // No journal yet: the legacy image moves into a slot on the next change
+        ret = load_legacy_config(nvs_handle, &temp_config);
+        if (ret != ESP_OK) {
+            persist_forget();
+            persist_unlock();
+            nvs_close(nvs_handle);
+            return ret;
+        }
+        s_seq = 0;
+        s_slot = -1;
     }
+    memcpy(&s_committed, &temp_config, sizeof(sys_config_t));
+    s_have_committed = true;
     
-    // Copy to global config
-    sys_config_t* cfg = sys_get_config_mutable();
-    memcpy(cfg, &temp_config, sizeof(sys_config_t));
-    
+    persist_unlock();
     nvs_close(nvs_handle);
     
-    ESP_LOGI(TAG, "Config loaded from NVS (Device: %s)", cfg->device_label);
+    // Publish as the current config
+    sys_config_t* cfg = sys_config_edit_begin();
+    memcpy(cfg, &temp_config, sizeof(sys_config_t));
+    sys_config_publish();
+    
+    if (newest >= 0) {
+        ESP_LOGI(TAG, "Config loaded from slot %s, seq %" PRIu32 " (Device: %s)",
+                 NVS_KEY_SLOT[newest], s_seq, temp_config.device_label);
+    } else {
+        ESP_LOGI(TAG, "Config loaded from NVS (Device: %s)", temp_config.device_label);
+    }
     return ESP_OK;
 }
 
@@ -77,62 +193,140 @@ esp_err_t sys_save_config_to_nvs(void) {
     nvs_handle_t nvs_handle;
     esp_err_t ret;
     
-    // Get mutable config
-    sys_config_t* cfg = sys_get_config_mutable();
+    persist_lock();
     
-    // Calculate and update CRC
-    cfg->crc32 = sys_calculate_config_crc(cfg);
+    // Published snapshots are read-only: stamp the CRC on the record's copy
+    int slot = sys_persist_next_slot(s_slot);
+    sys_persist_record_t* rec = &s_records[slot];
+    uint32_t gen = sys_config_copy(&rec->cfg);
+    rec->cfg.crc32 = sys_calculate_config_crc(&rec->cfg);
+    
+    // Nothing to write if flash already holds this image
+    uint32_t changed = s_have_committed ? sys_persist_diff(&s_committed, &rec->cfg) : UINT32_MAX;
+    if (changed == 0) {
+        s_unchanged++;
+        persist_unlock();
+        if (config_saved_all(gen)) sys_get_state()->config_dirty = false;
+        ESP_LOGD(TAG, "Config unchanged, save skipped");
+        return ESP_OK;
+    }
+    sys_persist_seal(rec, s_seq + 1);
     
     // Open NVS namespace (read-write)
     ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open NVS: %d", ret);
+        persist_unlock();
         return ret;
     }
     
-    // Write blob
-    ret = nvs_set_blob(nvs_handle, NVS_KEY_CONFIG, cfg, sizeof(sys_config_t));
+    // Write the slot not holding the newest record, then commit
+    sys_flash_write_begin();
+    ret = nvs_set_blob(nvs_handle, NVS_KEY_SLOT[slot], rec, sizeof(sys_persist_record_t));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write config: %d", ret);
-        nvs_close(nvs_handle);
-        return ret;
+    } else {
+        ret = nvs_commit(nvs_handle);
+        if (ret != ESP_OK) ESP_LOGE(TAG, "Failed to commit NVS: %d", ret);
     }
+    sys_flash_write_end();
+    nvs_close(nvs_handle);
     
-    // Commit changes
-    ret = nvs_commit(nvs_handle);
+    if (ret == ESP_OK) {
+        memcpy(&s_committed, &rec->cfg, sizeof(sys_config_t));
+        s_have_committed = true;
+        s_seq = rec->seq;
+        s_slot = slot;
+        s_commits++;
+    }
+    uint32_t seq = s_seq;
+    persist_unlock();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NVS: %d", ret);
-        nvs_close(nvs_handle);
         return ret;
     }
     
-    nvs_close(nvs_handle);
-    
-    ESP_LOGI(TAG, "Config saved to NVS (CRC: 0x%08" PRIx32 ")", cfg->crc32);
+    if (config_saved_all(gen)) sys_get_state()->config_dirty = false;
+    ESP_LOGI(TAG, "Config saved to slot %s, seq %" PRIu32 " (changed 0x%06" PRIx32 ")",
+             NVS_KEY_SLOT[slot], seq, changed);
     return ESP_OK;
 }
 
+/* ========== PERSISTENCE WORKER ========== */
+
+// Waits for the first request, then for PERSIST_QUIET_MS without one (at
+// most PERSIST_MAX_DELAY_MS in all), so a burst of API updates is one save
+static void sys_persist_task(void* arg) {
+    (void)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t last_call = esp_timer_get_time() + (int64_t)PERSIST_MAX_DELAY_MS * 1000;
+        for (;;) {
+            int64_t wait_ms = (last_call - esp_timer_get_time()) / 1000;
+            if (wait_ms > PERSIST_QUIET_MS) wait_ms = PERSIST_QUIET_MS;
+            if (wait_ms <= 0) break;
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms)) == 0) break;
+        }
+        
+        esp_err_t ret = sys_save_config_to_nvs();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to save config: %d", ret);
+        }
+    }
+}
+
+esp_err_t sys_persist_start(void) {
+    if (s_persist_task) return ESP_OK;
+    BaseType_t ok = xTaskCreatePinnedToCore(sys_persist_task, "sys_persist", PERSIST_TASK_STACK,
+                                            NULL, PERSIST_TASK_PRIO, &s_persist_task, 0);
+    return ok == pdPASS ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void sys_persist_request(void) {
+    __atomic_fetch_add(&s_requests, 1, __ATOMIC_RELAXED);
+    TaskHandle_t task = s_persist_task;
+    if (task) xTaskNotifyGive(task);
+}
+
+void sys_persist_get_stats(sys_persist_stats_t* out) {
+    if (!out) return;
+    persist_lock();
+    out->requests = __atomic_load_n(&s_requests, __ATOMIC_RELAXED);
+    out->commits = s_commits;
+    out->unchanged = s_unchanged;
+    out->seq = s_seq;
+    out->slot = (int8_t)s_slot;
+    persist_unlock();
+}
+
 esp_err_t sys_factory_reset(void) {
     ESP_LOGW(TAG, "Factory reset triggered");
     
-    // Erase NVS namespace
+    // Erase NVS namespace; the journal starts over. The lock keeps the
+    // worker out until NVS is usable again.
+    persist_lock();
+    sys_flash_write_begin();
     esp_err_t ret = nvs_flash_erase_partition("nvs");
+    sys_flash_write_end();
     if (ret != ESP_OK) {
+        persist_unlock();
         ESP_LOGE(TAG, "Failed to erase NVS: %d", ret);
         return ret;
     }
+    persist_forget();
     
     // Reinitialize NVS
     ret = nvs_flash_init();
+    persist_unlock();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to reinit NVS: %d", ret);
         return ret;
     }
     
     // Load default config
-    sys_config_t* cfg = sys_get_config_mutable();
+    sys_config_t* cfg = sys_config_edit_begin();
     const sys_config_t* defaults = sys_get_default_config();
     memcpy(cfg, defaults, sizeof(sys_config_t));
+    sys_config_publish();
     
     // Save defaults to NVS
     ret = sys_save_config_to_nvs();
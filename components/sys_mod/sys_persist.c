@@ -0,0 +1,120 @@
+/**
+ * @file sys_persist.c
+ * @brief A/B journal record sealing, validation and diffing
+ */
+
+#include "sys_persist.h"
+#include "esp_crc.h"
+#include <stddef.h>
+#include <string.h>
+
+// Covers seq and cfg up to its own crc32; the magic is checked on its own.
+// Including cfg.crc32 would cancel the body out: a CRC run over data
+// followed by that data's CRC ends the same whatever the data was.
+static uint32_t record_crc(const sys_persist_record_t *rec)
+{
+    uint32_t crc = esp_crc32_le(0, (const uint8_t *)&rec->seq, sizeof(rec->seq));
+    return esp_crc32_le(crc, (const uint8_t *)&rec->cfg, sizeof(rec->cfg) - sizeof(uint32_t));
+}
+
+void sys_persist_seal(sys_persist_record_t *rec, uint32_t seq)
+{
+    rec->magic = SYS_PERSIST_MAGIC;
+    rec->seq = seq;
+    rec->crc32 = record_crc(rec);
+}
+
+bool sys_persist_valid(const sys_persist_record_t *rec)
+{
+    if (rec->magic != SYS_PERSIST_MAGIC || rec->crc32 != record_crc(rec)) return false;
+    // Same check as loading a bare config (sys_calculate_config_crc())
+    const sys_config_t *cfg = &rec->cfg;
+    return cfg->magic_number == SYS_CONFIG_MAGIC &&
+           cfg->crc32 == esp_crc32_le(0, (const uint8_t *)cfg, sizeof(*cfg) - sizeof(uint32_t));
+}
+
+int sys_persist_newest(const sys_persist_record_t *const recs[SYS_PERSIST_SLOTS])
+{
+    int best = -1;
+    for (int i = 0; i < SYS_PERSIST_SLOTS; ++i) {
+        if (!recs[i] || !sys_persist_valid(recs[i])) continue;
+        if (best < 0 || (int32_t)(recs[i]->seq - recs[best]->seq) > 0) best = i;
+    }
+    return best;
+}
+
+// Ports held by an image: version 1 predates the count and always had 4
+static int image_ports(const sys_config_t *hdr)
+{
+    return hdr->version < 2 ? 4 : hdr->port_count;
+}
+
+bool sys_persist_upgrade_config(const void *img, size_t len, const sys_config_t *defaults,
+                                sys_config_t *out)
+{
+    const uint8_t *src = img;
+    const size_t head = offsetof(sys_config_t, ports);
+    const size_t tail = sizeof(sys_config_t) - offsetof(sys_config_t, failsafe);
+    sys_config_t hdr;
+
+    if (len < head) return false;
+    memcpy(&hdr, src, head);
+    int n = image_ports(&hdr);
+    if (hdr.magic_number != SYS_CONFIG_MAGIC || n < 1 || n > SYS_PORTS_LIMIT ||
+        len != SYS_PERSIST_CFG_SIZE(n)) {
+        return false;
+    }
+    uint32_t crc;
+    memcpy(&crc, src + len - sizeof(crc), sizeof(crc));
+    if (crc != esp_crc32_le(0, src, len - sizeof(crc))) return false;
+
+    // Header and network, the ports both layouts have, then failsafe onwards
+    int keep = n < SYS_MAX_PORTS ? n : SYS_MAX_PORTS;
+    memcpy(out, src, head);
+    memcpy(out->ports, src + head, keep * sizeof(dmx_port_cfg_t));
+    memcpy(&out->ports[keep], &defaults->ports[keep], (SYS_MAX_PORTS - keep) * sizeof(dmx_port_cfg_t));
+    memcpy(&out->failsafe, src + len - tail, tail);
+    out->version = SYS_CONFIG_VERSION;
+    out->port_count = SYS_MAX_PORTS;
+    out->crc32 = esp_crc32_le(0, (const uint8_t *)out, sizeof(*out) - sizeof(uint32_t));
+    return true;
+}
+
+bool sys_persist_upgrade(const void *blob, size_t len, const sys_config_t *defaults,
+                         sys_persist_record_t *out)
+{
+    const uint8_t *src = blob;
+    const size_t head = offsetof(sys_persist_record_t, cfg);
+    uint32_t magic, seq, crc;
+
+    if (len <= head + sizeof(uint32_t)) return false;
+    memcpy(&magic, src + offsetof(sys_persist_record_t, magic), sizeof(magic));
+    memcpy(&seq, src + offsetof(sys_persist_record_t, seq), sizeof(seq));
+    memcpy(&crc, src + offsetof(sys_persist_record_t, crc32), sizeof(crc));
+    // Same coverage as record_crc(), in the record's own size
+    uint32_t calc = esp_crc32_le(0, (const uint8_t *)&seq, sizeof(seq));
+    calc = esp_crc32_le(calc, src + head, len - head - sizeof(uint32_t));
+    if (magic != SYS_PERSIST_MAGIC || crc != calc) return false;
+
+    if (!sys_persist_upgrade_config(src + head, len - head, defaults, &out->cfg)) return false;
+    sys_persist_seal(out, seq);
+    return true;
+}
+
+uint32_t sys_persist_diff(const sys_config_t *a, const sys_config_t *b)
+{
+    uint32_t mask = 0;
+    if (memcmp(a->device_label, b->device_label, sizeof(a->device_label)) != 0) mask |= SYS_PERSIST_CHG_LABEL;
+    if (a->led_brightness != b->led_brightness) mask |= SYS_PERSIST_CHG_LED;
+    if (memcmp(&a->net, &b->net, sizeof(a->net)) != 0) mask |= SYS_PERSIST_CHG_NET;
+    for (int i = 0; i < SYS_MAX_PORTS; ++i) {
+        if (memcmp(&a->ports[i], &b->ports[i], sizeof(a->ports[i])) != 0) mask |= SYS_PERSIST_CHG_PORT(i);
+    }
+    if (memcmp(&a->failsafe, &b->failsafe, sizeof(a->failsafe)) != 0) mask |= SYS_PERSIST_CHG_FAILSAFE;
+    if (a->magic_number != b->magic_number || a->version != b->version || a->port_count != b->port_count ||
+        memcmp(a->reserved1, b->reserved1, sizeof(a->reserved1)) != 0 ||
+        memcmp(a->reserved2, b->reserved2, sizeof(a->reserved2)) != 0) {
+        mask |= SYS_PERSIST_CHG_OTHER;
+    }
+    return mask;
+}
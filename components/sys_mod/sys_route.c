@@ -1,27 +1,98 @@
 /**
  * @file sys_route.c
  * @brief Universe-to-port routing logic
+ *
+ * The port configs are compiled into a hash index (sys_route_index.h) each
+ * time they change. Two tables alternate: the rebuild fills the one not in
+ * use and publishes it by bumping a generation counter, so lookups on the
+ * packet path never take the config mutex. The counter doubles as a
+ * seqlock: a rebuild only rewrites a table after the counter has moved
+ * past it, so a lookup that still sees its generation afterwards read a
+ * table nobody was writing.
+ *
+ * A 32768-bit bitmap of configured universes (low 15 bits, any protocol)
+ * backs the receive pre-filter, which rejects packets from their header
+ * alone.
  */
 
 #include "sys_mod.h"
+#include "sys_route_index.h"
+#include <string.h>
 
-/* ========== ROUTING LOGIC ========== */
+/* ========== ROUTING INDEX ========== */
 
-int8_t sys_route_find_port(uint8_t protocol, uint16_t universe) {
+static sys_route_entry_t s_route_tab[2][SYS_ROUTE_SLOTS];
+static uint32_t s_route_gen;    // Published table: s_route_tab[s_route_gen & 1]
+
+#define ROUTE_BITMAP_WORDS (32768 / 32)
+static uint32_t s_universe_bits[ROUTE_BITMAP_WORDS];
+static uint16_t s_bitmap_universes[SYS_MAX_PORTS];  // Bits set by the last rebuild
+static int s_bitmap_count;
+
+/* Updated in place: new bits are set before stale ones are cleared, so a
+ * universe kept across a rebuild never reads as unrouted */
+static void route_bitmap_update(const sys_config_t* cfg) {
+    uint16_t now[SYS_MAX_PORTS];
+    int count = 0;
+    for (int i = 0; i < SYS_MAX_PORTS; i++) {
+        if (!cfg->ports[i].enabled) continue;
+        uint16_t u = cfg->ports[i].universe & 0x7FFF;
+        now[count++] = u;
+        __atomic_fetch_or(&s_universe_bits[u >> 5], 1u << (u & 31), __ATOMIC_RELEASE);
+    }
+    for (int i = 0; i < s_bitmap_count; i++) {
+        uint16_t u = s_bitmap_universes[i];
+        bool kept = false;
+        for (int j = 0; j < count && !kept; j++) kept = (now[j] == u);
+        if (!kept) __atomic_fetch_and(&s_universe_bits[u >> 5], ~(1u << (u & 31)), __ATOMIC_RELEASE);
+    }
+    memcpy(s_bitmap_universes, now, sizeof(now));
+    s_bitmap_count = count;
+}
+
+void sys_route_rebuild(void) {
+    // Single writer: called with the config mutex held, or during init
     const sys_config_t* cfg = sys_get_config();
-    
-    // Linear search through ports
+    uint32_t gen = __atomic_load_n(&s_route_gen, __ATOMIC_RELAXED);
+    sys_route_entry_t* tab = s_route_tab[(gen + 1) & 1];
+    // Lookups that can observe the writes below must also observe the
+    // generation (gen - 1 -> gen) that retired this table
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    sys_route_index_clear(tab, SYS_ROUTE_SLOTS);
     for (int i = 0; i < SYS_MAX_PORTS; i++) {
         const dmx_port_cfg_t* port = &cfg->ports[i];
-        
-        // Check if port matches criteria
-        if (port->enabled && 
-            port->protocol == protocol && 
-            port->universe == universe) {
-            return (int8_t)i;
+        if (port->enabled) {
+            sys_route_index_add(tab, SYS_ROUTE_SLOTS, port->protocol, port->universe, (uint8_t)i);
+        }
+    }
+
+    __atomic_store_n(&s_route_gen, gen + 1, __ATOMIC_RELEASE);
+    route_bitmap_update(cfg);
+}
+
+/* ========== ROUTING LOGIC ========== */
+
+uint32_t sys_route_find_ports(uint8_t protocol, uint16_t universe) {
+    for (;;) {
+        uint32_t gen = __atomic_load_n(&s_route_gen, __ATOMIC_ACQUIRE);
+        uint32_t ports = sys_route_index_lookup(s_route_tab[gen & 1], SYS_ROUTE_SLOTS,
+                                                protocol, universe);
+        // Any later publish may have been followed by a rebuild of our
+        // table: only an unchanged generation proves the read was clean
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s_route_gen, __ATOMIC_RELAXED) == gen) {
+            return ports;
         }
     }
-    
-    // No match found
-    return -1;
+}
+
+int8_t sys_route_find_port(uint8_t protocol, uint16_t universe) {
+    uint32_t ports = sys_route_find_ports(protocol, universe);
+    return ports ? (int8_t)__builtin_ctz(ports) : -1;
+}
+
+bool sys_route_universe_used(uint16_t universe) {
+    universe &= 0x7FFF;
+    return (__atomic_load_n(&s_universe_bits[universe >> 5], __ATOMIC_RELAXED) >> (universe & 31)) & 1u;
 }
@@ -0,0 +1,29 @@
+/**
+ * @file sys_route_index.c
+ * @brief Routing index construction (linear probing)
+ */
+
+#include "sys_route_index.h"
+#include <string.h>
+
+void sys_route_index_clear(sys_route_entry_t *tab, size_t slots)
+{
+    memset(tab, 0, slots * sizeof(*tab));
+}
+
+bool sys_route_index_add(sys_route_entry_t *tab, size_t slots,
+                         uint8_t protocol, uint16_t universe, uint8_t port)
+{
+    uint32_t key = SYS_ROUTE_KEY(protocol, universe);
+    uint32_t i = sys_route_index_hash(key, slots);
+    for (size_t n = 0; n < slots; n++) {
+        sys_route_entry_t *e = &tab[i];
+        if (e->key == key || e->key == SYS_ROUTE_EMPTY) {
+            e->key = key;
+            e->ports |= 1u << port;
+            return true;
+        }
+        i = (i + 1) & (uint32_t)(slots - 1);
+    }
+    return false;
+}
@@ -7,7 +7,6 @@
 #include "sys_mod.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
-#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include <string.h>
@@ -20,9 +19,8 @@ extern esp_err_t sys_save_config_to_nvs(void);
 extern esp_err_t sys_buffer_init(void);
 extern esp_err_t sys_event_loop_init(void);
 extern sys_state_t* sys_get_state(void);
-extern sys_config_t* sys_get_config_mutable(void);
 extern const sys_config_t* sys_get_default_config(void);
-extern void sys_lazy_save_callback(void* arg);
+extern esp_err_t sys_persist_start(void);
 
 /* ========== INITIALIZATION ========== */
 
@@ -71,9 +69,10 @@ esp_err_t sys_mod_init(void) {
         ESP_LOGW(TAG, "NVS empty or corrupt, loading defaults");
         
         // Load default config
-        sys_config_t* cfg = sys_get_config_mutable();
+        sys_config_t* cfg = sys_config_edit_begin();
         const sys_config_t* defaults = sys_get_default_config();
         memcpy(cfg, defaults, sizeof(sys_config_t));
+        sys_config_publish();
         
         // Save defaults to NVS
         ret = sys_save_config_to_nvs();
@@ -95,24 +94,14 @@ esp_err_t sys_mod_init(void) {
     }
     ESP_LOGI(TAG, "  ✓ All buffers allocated");
     
-    // Step 6: Create lazy save timer
-    ESP_LOGI(TAG, "Step 6: Creating lazy save timer");
-    const esp_timer_create_args_t timer_args = {
-        .callback = &sys_lazy_save_callback,
-        .name = "sys_lazy_save",
-        .arg = NULL,
-        .dispatch_method = ESP_TIMER_TASK,
-        .skip_unhandled_events = true
-    };
-    
-    esp_timer_handle_t timer;
-    ret = esp_timer_create(&timer_args, &timer);
+    // Step 6: Start config persistence worker
+    ESP_LOGI(TAG, "Step 6: Starting config persistence worker");
+    ret = sys_persist_start();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create timer: %d", ret);
+        ESP_LOGE(TAG, "Failed to create persistence task: %d", ret);
         return ret;
     }
-    state->save_timer = (void*)timer;
-    ESP_LOGI(TAG, "  ✓ Timer created");
+    ESP_LOGI(TAG, "  ✓ Persistence worker started");
     
     // Initialize state flags
     state->config_dirty = false;
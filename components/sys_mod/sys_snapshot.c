@@ -17,7 +17,6 @@ static const char* TAG = "SYS_SNAP";
 
 /* Forward declaration */
 extern sys_state_t* sys_get_state(void);
-extern sys_config_t* sys_get_config_mutable(void);
 
 /* ========== SNAPSHOT OPERATIONS ========== */
 
@@ -51,27 +50,26 @@ esp_err_t sys_snapshot_record(int port_idx) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    // Save to NVS
+    // Save to NVS and commit
+    sys_flash_write_begin();
     ret = nvs_set_blob(nvs_handle, key, buffer, DMX_UNIVERSE_SIZE);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write snapshot %d: %d", port_idx, ret);
-        nvs_close(nvs_handle);
-        return ret;
+    } else {
+        ret = nvs_commit(nvs_handle);
+        if (ret != ESP_OK) ESP_LOGE(TAG, "Failed to commit snapshot %d: %d", port_idx, ret);
     }
-    
-    // Commit
-    ret = nvs_commit(nvs_handle);
+    sys_flash_write_end();
+
+    nvs_close(nvs_handle);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit snapshot %d: %d", port_idx, ret);
-        nvs_close(nvs_handle);
         return ret;
     }
-    
-    nvs_close(nvs_handle);
-    
+
     // Update flag in config
-    sys_config_t* cfg = sys_get_config_mutable();
+    sys_config_t* cfg = sys_config_edit_begin();
     cfg->failsafe.has_snapshot = true;
+    sys_config_publish();
     
     ESP_LOGI(TAG, "Snapshot recorded for port %d", port_idx);
     return ESP_OK;
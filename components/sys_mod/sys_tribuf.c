@@ -0,0 +1,39 @@
+/**
+ * @file sys_tribuf.c
+ * @brief Triple buffer index exchange
+ */
+
+#include "sys_tribuf.h"
+#include <string.h>
+
+void sys_tribuf_init(sys_tribuf_t *tb)
+{
+    memset(tb, 0, sizeof(*tb));
+    tb->write_idx = 0;
+    tb->pending = 1;
+    tb->read_idx = 2;
+}
+
+uint32_t sys_tribuf_publish(sys_tribuf_t *tb)
+{
+    uint32_t gen = ++tb->next_gen;
+    tb->gen[tb->write_idx] = gen;
+    // Release: the frame and its generation are visible before the index
+    uint8_t old = __atomic_exchange_n(&tb->pending, (uint8_t)(tb->write_idx | SYS_TRIBUF_FRESH),
+                                      __ATOMIC_ACQ_REL);
+    tb->write_idx = old & (SYS_TRIBUF_FRESH - 1);
+    return gen;
+}
+
+bool sys_tribuf_acquire(sys_tribuf_t *tb, const uint8_t **frame, uint32_t *gen)
+{
+    bool fresh = (__atomic_load_n(&tb->pending, __ATOMIC_RELAXED) & SYS_TRIBUF_FRESH) != 0;
+    if (fresh) {
+        // Acquire: pairs with the writer's release in sys_tribuf_publish()
+        uint8_t old = __atomic_exchange_n(&tb->pending, tb->read_idx, __ATOMIC_ACQ_REL);
+        tb->read_idx = old & (SYS_TRIBUF_FRESH - 1);
+    }
+    *frame = tb->frame[tb->read_idx];
+    if (gen) *gen = tb->gen[tb->read_idx];
+    return fresh;
+}
@@ -0,0 +1,21 @@
+#include "unity.h"
+
+/* Runner for the SYS_MOD host-side tests: one group per pure-logic module */
+
+void run_route_tests(void);
+void run_tribuf_tests(void);
+void run_evq_tests(void);
+void run_persist_tests(void);
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    run_route_tests();
+    run_tribuf_tests();
+    run_evq_tests();
+    run_persist_tests();
+    return UNITY_END();
+}
@@ -0,0 +1,251 @@
+#include "unity.h"
+#include "sys_persist.h"
+#include "esp_crc.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Host-side tests for the SYS_MOD config journal records */
+
+static void make_config(sys_config_t *cfg, uint8_t brightness)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->magic_number = SYS_CONFIG_MAGIC;
+    cfg->version = SYS_CONFIG_VERSION;
+    cfg->port_count = SYS_MAX_PORTS;
+    strcpy(cfg->device_label, "test-node");
+    cfg->led_brightness = brightness;
+    cfg->crc32 = esp_crc32_le(0, (const uint8_t *)cfg, sizeof(*cfg) - sizeof(uint32_t));
+}
+
+static void make_record(sys_persist_record_t *rec, uint8_t brightness, uint32_t seq)
+{
+    make_config(&rec->cfg, brightness);
+    sys_persist_seal(rec, seq);
+}
+
+void test_persist_seal_and_damage(void)
+{
+    static sys_persist_record_t rec;
+    make_record(&rec, 50, 7);
+    TEST_ASSERT_TRUE(sys_persist_valid(&rec));
+    TEST_ASSERT_EQUAL_UINT32(7, rec.seq);
+
+    /* Any byte of the record, header or config, invalidates it */
+    static const size_t offsets[] = {
+        0, offsetof(sys_persist_record_t, seq), offsetof(sys_persist_record_t, crc32),
+        offsetof(sys_persist_record_t, cfg) + 40, sizeof(sys_persist_record_t) - 1,
+    };
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+        uint8_t *p = (uint8_t *)&rec + offsets[i];
+        *p ^= 0x10;
+        TEST_ASSERT_FALSE(sys_persist_valid(&rec));
+        *p ^= 0x10;
+    }
+    TEST_ASSERT_TRUE(sys_persist_valid(&rec));
+
+    /* A resealed record with a stale config CRC is still refused */
+    rec.cfg.led_brightness = 60;
+    sys_persist_seal(&rec, 8);
+    TEST_ASSERT_FALSE(sys_persist_valid(&rec));
+}
+
+void test_persist_newest_and_wrap(void)
+{
+    static sys_persist_record_t a, b;
+    const sys_persist_record_t *recs[SYS_PERSIST_SLOTS] = { &a, &b };
+
+    make_record(&a, 10, 4);
+    make_record(&b, 20, 5);
+    TEST_ASSERT_EQUAL_INT(1, sys_persist_newest(recs));
+
+    /* Sequence numbers wrap: 0 follows 0xFFFFFFFF */
+    make_record(&a, 10, 0);
+    make_record(&b, 20, 0xFFFFFFFFu);
+    TEST_ASSERT_EQUAL_INT(0, sys_persist_newest(recs));
+
+    recs[0] = NULL;
+    TEST_ASSERT_EQUAL_INT(1, sys_persist_newest(recs));
+    recs[1] = NULL;
+    TEST_ASSERT_EQUAL_INT(-1, sys_persist_newest(recs));
+
+    TEST_ASSERT_EQUAL_INT(0, sys_persist_next_slot(-1));
+    TEST_ASSERT_EQUAL_INT(1, sys_persist_next_slot(0));
+    TEST_ASSERT_EQUAL_INT(0, sys_persist_next_slot(1));
+}
+
+/* Power cut during the Nth save: every prefix of the record reached flash,
+ * the rest is whatever the slot held before. Load must return either the
+ * new config or the previous one, never garbage. */
+void test_persist_torn_write(void)
+{
+    static sys_persist_record_t slots[SYS_PERSIST_SLOTS];
+    static sys_persist_record_t next;
+    memset(slots, 0xFF, sizeof(slots));     /* Erased flash */
+    const sys_persist_record_t *recs[SYS_PERSIST_SLOTS] = { &slots[0], &slots[1] };
+
+    uint32_t seq = 0, torn = 0, rolled_back = 0;
+    int newest = -1;
+    for (uint8_t save = 1; save <= 6; ++save) {
+        int slot = sys_persist_next_slot(newest);
+        make_record(&next, save, seq + 1);
+        static sys_persist_record_t before;
+        memcpy(&before, &slots[slot], sizeof(before));
+
+        for (size_t cut = 0; cut < sizeof(next); cut += 37) {
+            memcpy(&slots[slot], &before, sizeof(before));
+            memcpy(&slots[slot], &next, cut);
+            int got = sys_persist_newest(recs);
+            if (newest < 0) {
+                TEST_ASSERT_EQUAL_INT(-1, got);
+            } else {
+                TEST_ASSERT_EQUAL_INT(newest, got);
+                TEST_ASSERT_EQUAL_UINT8(save - 1, slots[got].cfg.led_brightness);
+            }
+            torn++;
+            rolled_back += got >= 0;
+        }
+
+        memcpy(&slots[slot], &next, sizeof(next));
+        newest = sys_persist_newest(recs);
+        TEST_ASSERT_EQUAL_INT(slot, newest);
+        TEST_ASSERT_EQUAL_UINT8(save, slots[newest].cfg.led_brightness);
+        seq = slots[newest].seq;
+    }
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%u torn writes, %u fell back to the previous record",
+             (unsigned)torn, (unsigned)rolled_back);
+    TEST_MESSAGE(msg);
+}
+
+void test_persist_diff(void)
+{
+    static sys_config_t a, b;
+    make_config(&a, 50);
+    memcpy(&b, &a, sizeof(b));
+    TEST_ASSERT_EQUAL_UINT32(0, sys_persist_diff(&a, &b));
+
+    /* The CRC alone is not a change */
+    b.crc32 ^= 1;
+    TEST_ASSERT_EQUAL_UINT32(0, sys_persist_diff(&a, &b));
+
+    b.led_brightness = 51;
+    b.ports[2].universe = 9;
+    TEST_ASSERT_EQUAL_UINT32(SYS_PERSIST_CHG_LED | SYS_PERSIST_CHG_PORT(2), sys_persist_diff(&a, &b));
+
+    memcpy(&b, &a, sizeof(b));
+    b.device_label[0] = 'x';
+    b.net.dhcp_enabled = !a.net.dhcp_enabled;
+    b.failsafe.mode = 1;
+    b.reserved2[0] = 1;
+    TEST_ASSERT_EQUAL_UINT32(SYS_PERSIST_CHG_LABEL | SYS_PERSIST_CHG_NET |
+                             SYS_PERSIST_CHG_FAILSAFE | SYS_PERSIST_CHG_OTHER,
+                             sys_persist_diff(&a, &b));
+}
+
+/* Config image of @p n ports as a build with that count stores it; port i
+ * is on universe 100 + i */
+static size_t make_image(uint8_t *img, uint32_t version, int n)
+{
+    size_t len = SYS_PERSIST_CFG_SIZE(n);
+    const size_t tail = sizeof(sys_config_t) - offsetof(sys_config_t, failsafe);
+    memset(img, 0, len);
+    uint32_t magic = SYS_CONFIG_MAGIC;
+    memcpy(img + offsetof(sys_config_t, magic_number), &magic, sizeof(magic));
+    memcpy(img + offsetof(sys_config_t, version), &version, sizeof(version));
+    strcpy((char *)img + offsetof(sys_config_t, device_label), "old-node");
+    if (version >= 2) img[offsetof(sys_config_t, port_count)] = (uint8_t)n;
+    for (int i = 0; i < n; ++i) {
+        dmx_port_cfg_t port = { .enabled = true, .universe = (uint16_t)(100 + i) };
+        memcpy(img + offsetof(sys_config_t, ports) + i * sizeof(port), &port, sizeof(port));
+    }
+    dmx_failsafe_t fs = { .mode = FAILSAFE_SNAPSHOT, .timeout_ms = 1234 };
+    memcpy(img + len - tail, &fs, sizeof(fs));
+    uint32_t crc = esp_crc32_le(0, img, len - sizeof(crc));
+    memcpy(img + len - sizeof(crc), &crc, sizeof(crc));
+    return len;
+}
+
+static void check_upgraded(const sys_config_t *cfg, const sys_config_t *defaults, int n)
+{
+    TEST_ASSERT_EQUAL_UINT32(SYS_CONFIG_VERSION, cfg->version);
+    TEST_ASSERT_EQUAL_UINT8(SYS_MAX_PORTS, cfg->port_count);
+    TEST_ASSERT_EQUAL_STRING("old-node", cfg->device_label);
+    for (int i = 0; i < SYS_MAX_PORTS; ++i) {
+        TEST_ASSERT_EQUAL_UINT16(i < n ? 100 + i : defaults->ports[i].universe, cfg->ports[i].universe);
+    }
+    TEST_ASSERT_EQUAL_UINT8(FAILSAFE_SNAPSHOT, cfg->failsafe.mode);
+    TEST_ASSERT_EQUAL_UINT16(1234, cfg->failsafe.timeout_ms);
+    TEST_ASSERT_EQUAL_HEX32(esp_crc32_le(0, (const uint8_t *)cfg, sizeof(*cfg) - sizeof(uint32_t)),
+                            cfg->crc32);
+}
+
+void test_persist_upgrade_port_count(void)
+{
+    static uint8_t img[SYS_PERSIST_REC_MAX];
+    static sys_config_t defaults, out;
+    make_config(&defaults, 50);
+    for (int i = 0; i < SYS_MAX_PORTS; ++i) defaults.ports[i].universe = (uint16_t)(900 + i);
+
+    /* Version 1: 4 ports, no count; then narrower and wider version 2 */
+    static const struct { uint32_t version; int ports; } cases[] = {
+        { 1, 4 }, { 2, 4 }, { 2, 8 }, { 2, SYS_PORTS_LIMIT },
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+        size_t len = make_image(img, cases[c].version, cases[c].ports);
+        TEST_ASSERT_TRUE(sys_persist_upgrade_config(img, len, &defaults, &out));
+        check_upgraded(&out, &defaults, cases[c].ports);
+
+        /* Its own size and CRC are checked */
+        TEST_ASSERT_FALSE(sys_persist_upgrade_config(img, len - 1, &defaults, &out));
+        img[offsetof(sys_config_t, ports)] ^= 1;
+        TEST_ASSERT_FALSE(sys_persist_upgrade_config(img, len, &defaults, &out));
+    }
+    /* A count that does not match the size */
+    size_t len = make_image(img, 2, 8);
+    img[offsetof(sys_config_t, port_count)] = 4;
+    TEST_ASSERT_FALSE(sys_persist_upgrade_config(img, len, &defaults, &out));
+}
+
+void test_persist_upgrade_record(void)
+{
+    static uint8_t blob[SYS_PERSIST_REC_MAX];
+    static sys_persist_record_t old, cur, copy;
+    static sys_config_t defaults;
+    make_config(&defaults, 50);
+
+    /* A version 1 record (4 ports), sealed the way that build did */
+    const size_t head = offsetof(sys_persist_record_t, cfg);
+    size_t cfg_len = make_image(blob + head, 1, 4);
+    uint32_t magic = SYS_PERSIST_MAGIC, seq = 5;
+    uint32_t crc = esp_crc32_le(0, (const uint8_t *)&seq, sizeof(seq));
+    crc = esp_crc32_le(crc, blob + head, cfg_len - sizeof(uint32_t));
+    memcpy(blob + offsetof(sys_persist_record_t, magic), &magic, sizeof(magic));
+    memcpy(blob + offsetof(sys_persist_record_t, seq), &seq, sizeof(seq));
+    memcpy(blob + offsetof(sys_persist_record_t, crc32), &crc, sizeof(crc));
+
+    TEST_ASSERT_TRUE(sys_persist_upgrade(blob, head + cfg_len, &defaults, &old));
+    TEST_ASSERT_TRUE(sys_persist_valid(&old));
+    TEST_ASSERT_EQUAL_UINT32(5, old.seq);
+    check_upgraded(&old.cfg, &defaults, 4);
+    blob[head + 40] ^= 1;
+    TEST_ASSERT_FALSE(sys_persist_upgrade(blob, head + cfg_len, &defaults, &copy));
+
+    /* A current record comes through unchanged and still wins on seq */
+    make_record(&cur, 60, 6);
+    TEST_ASSERT_TRUE(sys_persist_upgrade(&cur, sizeof(cur), &defaults, &copy));
+    TEST_ASSERT_EQUAL_MEMORY(&cur, &copy, sizeof(cur));
+    const sys_persist_record_t *recs[SYS_PERSIST_SLOTS] = { &old, &copy };
+    TEST_ASSERT_EQUAL_INT(1, sys_persist_newest(recs));
+}
+
+void run_persist_tests(void)
+{
+    RUN_TEST(test_persist_seal_and_damage);
+    RUN_TEST(test_persist_newest_and_wrap);
+    RUN_TEST(test_persist_torn_write);
+    RUN_TEST(test_persist_diff);
+    RUN_TEST(test_persist_upgrade_port_count);
+    RUN_TEST(test_persist_upgrade_record);
+}
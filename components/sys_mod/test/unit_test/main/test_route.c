@@ -0,0 +1,113 @@
+#include "unity.h"
+#include "test_bench.h"
+#include "sys_route_index.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Host-side tests for the SYS_MOD routing index */
+
+#define PROTO_ARTNET 0
+#define PROTO_SACN   1
+#define BENCH_ROUTES_MAX 512
+
+void test_route_fanout(void)
+{
+    sys_route_entry_t tab[SYS_ROUTE_SLOTS];
+    sys_route_index_clear(tab, SYS_ROUTE_SLOTS);
+
+    TEST_ASSERT_TRUE(sys_route_index_add(tab, SYS_ROUTE_SLOTS, PROTO_ARTNET, 0, 0));
+    TEST_ASSERT_TRUE(sys_route_index_add(tab, SYS_ROUTE_SLOTS, PROTO_ARTNET, 0, 2));
+    TEST_ASSERT_TRUE(sys_route_index_add(tab, SYS_ROUTE_SLOTS, PROTO_SACN, 0, 1));
+    TEST_ASSERT_TRUE(sys_route_index_add(tab, SYS_ROUTE_SLOTS, PROTO_ARTNET, 0x7FFF, 3));
+
+    /* One lookup returns every port on the universe; protocols are separate */
+    TEST_ASSERT_EQUAL_HEX32(0x5, sys_route_index_lookup(tab, SYS_ROUTE_SLOTS, PROTO_ARTNET, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x2, sys_route_index_lookup(tab, SYS_ROUTE_SLOTS, PROTO_SACN, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x8, sys_route_index_lookup(tab, SYS_ROUTE_SLOTS, PROTO_ARTNET, 0x7FFF));
+    TEST_ASSERT_EQUAL_HEX32(0, sys_route_index_lookup(tab, SYS_ROUTE_SLOTS, PROTO_SACN, 0x7FFF));
+    TEST_ASSERT_EQUAL_HEX32(0, sys_route_index_lookup(tab, SYS_ROUTE_SLOTS, PROTO_ARTNET, 1));
+}
+
+void test_route_full_table(void)
+{
+    sys_route_entry_t tab[8];
+    sys_route_index_clear(tab, 8);
+    for (uint16_t u = 0; u < 8; ++u) {
+        TEST_ASSERT_TRUE(sys_route_index_add(tab, 8, PROTO_SACN, u, u & 3));
+    }
+    /* Existing keys still accept ports, new keys are refused */
+    TEST_ASSERT_TRUE(sys_route_index_add(tab, 8, PROTO_SACN, 5, 0));
+    TEST_ASSERT_FALSE(sys_route_index_add(tab, 8, PROTO_SACN, 8, 0));
+    for (uint16_t u = 0; u < 8; ++u) {
+        uint32_t expect = (1u << (u & 3)) | (u == 5 ? 1u : 0u);
+        TEST_ASSERT_EQUAL_HEX32(expect, sys_route_index_lookup(tab, 8, PROTO_SACN, u));
+    }
+    TEST_ASSERT_EQUAL_HEX32(0, sys_route_index_lookup(tab, 8, PROTO_SACN, 8));
+}
+
+/* Reference: the linear scan the index replaced */
+typedef struct {
+    uint8_t protocol;
+    uint16_t universe;
+} bench_route_t;
+
+static uint32_t linear_find_ports(const bench_route_t *routes, size_t n, uint8_t protocol, uint16_t universe)
+{
+    uint32_t ports = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (routes[i].protocol == protocol && routes[i].universe == universe) ports |= 1u << (i & 31);
+    }
+    return ports;
+}
+
+void test_route_benchmark(void)
+{
+    static sys_route_entry_t tab[2 * BENCH_ROUTES_MAX];
+    static bench_route_t routes[BENCH_ROUTES_MAX];
+    const int lookups = 20000;
+    char msg[128];
+
+    for (size_t n = 4; n <= BENCH_ROUTES_MAX; n *= 2) {
+        size_t slots = 2 * n;
+        sys_route_index_clear(tab, slots);
+        for (size_t i = 0; i < n; ++i) {
+            /* Sparse 15-bit port-addresses across both protocols */
+            routes[i].protocol = (uint8_t)(i & 1);
+            routes[i].universe = (uint16_t)((i * 2654435761u) & 0x7FFF);
+            TEST_ASSERT_TRUE(sys_route_index_add(tab, slots, routes[i].protocol, routes[i].universe, (uint8_t)(i & 31)));
+        }
+
+        /* Half hits, half misses */
+        volatile uint32_t sink = 0;
+        uint64_t t0 = bench_now();
+        for (int k = 0; k < lookups; ++k) {
+            const bench_route_t *r = &routes[k % n];
+            sink += sys_route_index_lookup(tab, slots, r->protocol, (uint16_t)(r->universe ^ (k & 1)));
+        }
+        uint64_t hashed = bench_now() - t0;
+
+        t0 = bench_now();
+        for (int k = 0; k < lookups; ++k) {
+            const bench_route_t *r = &routes[k % n];
+            sink += linear_find_ports(routes, n, r->protocol, (uint16_t)(r->universe ^ (k & 1)));
+        }
+        uint64_t linear = bench_now() - t0;
+        (void)sink;
+
+        for (size_t i = 0; i < n; ++i) {
+            TEST_ASSERT_EQUAL_HEX32(linear_find_ports(routes, n, routes[i].protocol, routes[i].universe),
+                                    sys_route_index_lookup(tab, slots, routes[i].protocol, routes[i].universe));
+        }
+
+        snprintf(msg, sizeof(msg), "%3u routes: hash %llu " BENCH_UNIT "/lookup, linear %llu " BENCH_UNIT "/lookup",
+                 (unsigned)n, (unsigned long long)(hashed / lookups), (unsigned long long)(linear / lookups));
+        TEST_MESSAGE(msg);
+    }
+}
+
+void run_route_tests(void)
+{
+    RUN_TEST(test_route_fanout);
+    RUN_TEST(test_route_full_table);
+    RUN_TEST(test_route_benchmark);
+}
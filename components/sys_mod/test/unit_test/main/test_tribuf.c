@@ -0,0 +1,105 @@
+#include "unity.h"
+#include "sys_tribuf.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Host-side tests for the SYS_MOD frame triple buffer */
+
+#define STRESS_FRAMES 200000u
+
+/* Every byte derives from the generation: any mix of two frames shows */
+static void fill_frame(uint8_t *frame, uint32_t gen)
+{
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i) frame[i] = (uint8_t)(gen * 7u + (uint32_t)i);
+}
+
+static bool frame_intact(const uint8_t *frame, uint32_t gen)
+{
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i) {
+        if (frame[i] != (uint8_t)(gen * 7u + (uint32_t)i)) return false;
+    }
+    return true;
+}
+
+void test_tribuf_exchange(void)
+{
+    static sys_tribuf_t tb;
+    sys_tribuf_init(&tb);
+    const uint8_t *frame;
+    uint32_t gen;
+
+    /* Blank until the first publish */
+    TEST_ASSERT_FALSE(sys_tribuf_acquire(&tb, &frame, &gen));
+    TEST_ASSERT_EQUAL_UINT32(0, gen);
+    TEST_ASSERT_EQUAL_HEX8(0, frame[0]);
+
+    fill_frame(sys_tribuf_write_slot(&tb), 1);
+    TEST_ASSERT_EQUAL_UINT32(1, sys_tribuf_publish(&tb));
+    TEST_ASSERT_TRUE(sys_tribuf_acquire(&tb, &frame, &gen));
+    TEST_ASSERT_EQUAL_UINT32(1, gen);
+    TEST_ASSERT_TRUE(frame_intact(frame, 1));
+
+    /* Nothing new: same frame again */
+    const uint8_t *again;
+    TEST_ASSERT_FALSE(sys_tribuf_acquire(&tb, &again, &gen));
+    TEST_ASSERT_TRUE(again == frame);
+    TEST_ASSERT_EQUAL_UINT32(1, gen);
+
+    /* The writer never waits: frames the reader missed are replaced */
+    for (uint32_t g = 2; g <= 5; ++g) {
+        TEST_ASSERT_TRUE(sys_tribuf_write_slot(&tb) != frame);   /* reader's slot is off limits */
+        fill_frame(sys_tribuf_write_slot(&tb), g);
+        sys_tribuf_publish(&tb);
+    }
+    TEST_ASSERT_TRUE(frame_intact(frame, 1));
+    TEST_ASSERT_TRUE(sys_tribuf_acquire(&tb, &frame, &gen));
+    TEST_ASSERT_EQUAL_UINT32(5, gen);
+    TEST_ASSERT_TRUE(frame_intact(frame, 5));
+}
+
+static sys_tribuf_t s_stress_tb;
+
+static void *stress_writer(void *arg)
+{
+    (void)arg;
+    for (uint32_t g = 1; g <= STRESS_FRAMES; ++g) {
+        fill_frame(sys_tribuf_write_slot(&s_stress_tb), g);
+        sys_tribuf_publish(&s_stress_tb);
+    }
+    return NULL;
+}
+
+void test_tribuf_stress(void)
+{
+    sys_tribuf_init(&s_stress_tb);
+    pthread_t writer;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, stress_writer, NULL));
+
+    /* Read as fast as possible while the writer commits: every frame must
+     * be whole and generations must never go backwards */
+    uint32_t last = 0, fresh = 0, torn = 0, reads = 0;
+    while (last < STRESS_FRAMES) {
+        const uint8_t *frame;
+        uint32_t gen;
+        if (sys_tribuf_acquire(&s_stress_tb, &frame, &gen)) fresh++;
+        reads++;
+        TEST_ASSERT_GREATER_OR_EQUAL(last, gen);
+        if (gen && !frame_intact(frame, gen)) torn++;
+        last = gen;
+    }
+    pthread_join(writer, NULL);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%u frames published, %u reads, %u new frames, %u torn",
+             (unsigned)STRESS_FRAMES, (unsigned)reads, (unsigned)fresh, (unsigned)torn);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_GREATER_THAN(0, fresh);
+}
+
+void run_tribuf_tests(void)
+{
+    RUN_TEST(test_tribuf_exchange);
+    RUN_TEST(test_tribuf_stress);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file test_bench.h
+ * @brief Benchmark clock for the component unit tests
+ *
+ * Counts CPU cycles on target and nanoseconds on a Linux host; print
+ * results with BENCH_UNIT so the unit matches the build.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#endif
+
+#ifdef ESP_PLATFORM
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+static inline uint64_t bench_now(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_cpu_get_cycle_count();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
@@ -32,11 +32,11 @@ static const char *TAG = "MAIN";
 static void dmx_deferred_init_task(void *arg)
 {
     (void)arg;
-    const sys_config_t* cfg = sys_get_config();
     const int max_attempts = 3;
     for (int attempt = 1; attempt <= max_attempts; ++attempt) {
         ESP_LOGI(TAG, "DMX deferred init attempt %d/%d", attempt, max_attempts);
-        esp_err_t r = dmx_driver_init(cfg);
+        // Re-read after each back-off: a held snapshot is only valid briefly
+        esp_err_t r = dmx_driver_init(sys_get_config());
         if (r == ESP_OK) {
             ESP_LOGI(TAG, "DMX driver initialized (deferred)");
             esp_err_t s = dmx_start();
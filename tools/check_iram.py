@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+Link-time check of the DMX interrupt path placement.
+
+Flash erase/write (every NVS commit) turns the flash cache off on both
+cores until it finishes: only code in IRAM (or ROM) and data in internal
+DRAM can be touched. The core that did not start the write is held in an
+IRAM loop with only IRAM-safe interrupts enabled, so tasks stop on both
+cores whatever their placement, but the DMX frames already queued in
+hardware keep going as long as their ISRs never reach flash. Task code is
+therefore left in flash and not checked.
+
+The build runs this script on the linked ELF and fails if
+  - an ISR root or an object it touches was linked into flash (or PSRAM),
+  - anything reachable from the ISR roots calls a function in flash.
+
+Reachability follows direct calls (and call targets loaded from literals)
+into functions defined in the component archives given with --lib. Calls
+through pointers are not followed, so every driver callback is listed as
+a root.
+
+Usage (CMakeLists.txt does this after every link):
+  check_iram.py --elf app.elf --objdump <objdump> --nm <nm> --lib libmod_dmx.a ...
+"""
+
+import argparse
+import re
+import struct
+import subprocess
+import sys
+
+# Run from interrupt context: no flash at all
+ISR_ROOTS = [
+    'dmx_core_frame_done',      # completion hook, called by every backend
+    'dmx_rmt_on_trans_done',
+    'rmt_encode_dmx',           # RMT refill, runs from the RMT/DMA ISR
+    'dmx_lcd_on_trans_done',
+    'dmx_uart_isr',             # break done, FIFO refill and TX done; starts GDMA
+]
+
+# Objects the ISR roots read or write
+DATA = [
+    's_ports',                  # mod_dmx: in-flight frames and stats
+    's_stage',                  # RMT: staging buffer bookkeeping
+    's_isr',                    # RMT: interrupt counters
+    's_uart',                   # UART: frame, DMA descriptor and state
+    's_lcd',
+]
+
+# Only linked when the "lcd" backend is enabled (CONFIG_MODDMX_LCD_ENABLE)
+OPTIONAL = {'dmx_lcd_on_trans_done', 's_lcd'}
+
+SHN_ABS = 0xfff1
+STT_FUNC = 2
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+
+CALL_RE = re.compile(r'^(?:call(?:0|4|8|12|q)?|j|jmp|jal|bl)$')
+TARGET_RE = re.compile(r'^([0-9a-f]+) <([^>+]+)>')
+L32R_RE = re.compile(r'^a\d+, ([0-9a-f]+)')
+FUNC_RE = re.compile(r'^([0-9a-f]+) <([^>]+)>:$')
+INSN_RE = re.compile(r'^\s*([0-9a-f]+):\s+(\S+)\s*(.*)$')
+
+
+class Elf:
+    """Just enough of an ELF reader: sections, symbols, words by address"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        d = self.data
+        if d[:4] != b'\x7fELF':
+            raise ValueError(f'{path}: not an ELF file')
+        is64 = d[4] == 2
+        self.end = '<' if d[5] == 1 else '>'
+        e = self.end
+        if is64:
+            shoff, = struct.unpack_from(e + 'Q', d, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(e + 'HHH', d, 0x3a)
+            sh_fmt = e + 'IIQQQQIIQQ'
+        else:
+            shoff, = struct.unpack_from(e + 'I', d, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(e + 'HHH', d, 0x2e)
+            sh_fmt = e + 'IIIIIIIIII'
+
+        raw = [struct.unpack_from(sh_fmt, d, shoff + i * shentsize) for i in range(shnum)]
+        # name, type, flags, addr, offset, size, link, info, align, entsize
+        strtab_off = raw[shstrndx][4]
+        self.sections = []
+        for s in raw:
+            self.sections.append({
+                'name': self._str(strtab_off, s[0]), 'type': s[1], 'addr': s[3],
+                'offset': s[4], 'size': s[5], 'link': s[6], 'entsize': s[9],
+            })
+
+        self.symbols = []   # (name, addr, size, is_func, section name or '*ABS*')
+        for sec in self.sections:
+            if sec['type'] != SHT_SYMTAB:
+                continue
+            str_off = self.sections[sec['link']]['offset']
+            for i in range(sec['size'] // sec['entsize']):
+                off = sec['offset'] + i * sec['entsize']
+                if is64:
+                    name, info, _, shndx, value, size = struct.unpack_from(e + 'IBBHQQ', d, off)
+                else:
+                    name, value, size, info, _, shndx = struct.unpack_from(e + 'IIIBBH', d, off)
+                if name == 0 or shndx == 0:
+                    continue
+                if shndx == SHN_ABS:
+                    secname = '*ABS*'
+                elif shndx < len(self.sections):
+                    secname = self.sections[shndx]['name']
+                else:
+                    continue
+                self.symbols.append((self._str(str_off, name), value, size,
+                                     (info & 0xf) == STT_FUNC, secname))
+
+    def _str(self, base, off):
+        end = self.data.index(b'\0', base + off)
+        return self.data[base + off:end].decode('ascii', 'replace')
+
+    def word(self, addr):
+        for sec in self.sections:
+            if sec['type'] != SHT_NOBITS and sec['addr'] <= addr < sec['addr'] + sec['size'] and sec['addr']:
+                return struct.unpack_from(self.end + 'I', self.data, sec['offset'] + addr - sec['addr'])[0]
+        return None
+
+
+def in_iram(section):
+    return section.startswith('.iram') or section == '*ABS*'   # *ABS*: ROM functions
+
+
+def in_dram(section):
+    return section.startswith('.dram')
+
+
+def own_functions(nm, libs):
+    """Names of functions defined in our component archives"""
+    names = set()
+    for lib in libs:
+        out = subprocess.run([nm, '--defined-only', '-f', 'posix', lib],
+                             check=True, capture_output=True, text=True).stdout
+        for line in out.splitlines():
+            parts = line.split()
+            if len(parts) >= 2 and parts[1] in ('T', 't'):
+                names.add(parts[0])
+    return names
+
+
+def disassemble_iram(objdump, elf_path):
+    """{function address: [callee address, ...]} for every function in IRAM"""
+    out = subprocess.run([objdump, '-d', '--no-show-raw-insn', '-j', '.iram0.text', elf_path],
+                         check=True, capture_output=True, text=True).stdout
+    funcs = {}
+    cur = None
+    for line in out.splitlines():
+        m = FUNC_RE.match(line)
+        if m:
+            cur = funcs.setdefault(int(m.group(1), 16), [])
+            continue
+        m = INSN_RE.match(line)
+        if not m or cur is None:
+            continue
+        mnemonic, ops = m.group(2), m.group(3)
+        if CALL_RE.match(mnemonic):
+            t = TARGET_RE.match(ops)
+            if t:
+                cur.append(('call', int(t.group(1), 16)))
+        elif mnemonic == 'l32r':
+            t = L32R_RE.match(ops)
+            if t:
+                cur.append(('literal', int(t.group(1), 16)))
+    return funcs
+
+
+def check(elf, funcs, own):
+    errors = []
+    by_name = {}
+    func_at = {}
+    for name, addr, size, is_func, section in elf.symbols:
+        by_name.setdefault(name, []).append((addr, is_func, section))
+        if is_func:
+            func_at.setdefault(addr, (name, section))
+
+    def callees(addr):
+        for kind, target in funcs.get(addr, []):
+            if kind == 'literal':
+                target = elf.word(target)
+                if target is None:
+                    continue
+            sym = func_at.get(target)
+            if sym and target != addr:
+                yield target, sym
+
+    visited = set()
+
+    def visit(addr, name, section, path):
+        if addr in visited:
+            return
+        visited.add(addr)
+        if not in_iram(section):
+            errors.append(f'{" -> ".join(path)}: {name} is in {section}')
+            return
+        for target, (cname, csection) in callees(addr):
+            if cname in own:
+                visit(target, cname, csection, path + [cname])
+            elif not in_iram(csection):
+                errors.append(f'{" -> ".join(path)}: calls {cname} in {csection}')
+
+    for root in ISR_ROOTS:
+        syms = [s for s in by_name.get(root, []) if s[1]]
+        if not syms:
+            if root not in OPTIONAL:
+                errors.append(f'{root}: not found in ELF')
+            continue
+        for addr, _, section in syms:
+            visit(addr, root, section, [root])
+
+    for obj in DATA:
+        syms = [s for s in by_name.get(obj, []) if not s[1]]
+        if not syms:
+            if obj not in OPTIONAL:
+                errors.append(f'{obj}: not found in ELF')
+            continue
+        for _, _, section in syms:
+            if not in_dram(section):
+                errors.append(f'{obj}: data is in {section}, not internal DRAM')
+
+    return errors, len(visited)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    ap.add_argument('--elf', required=True)
+    ap.add_argument('--objdump', required=True)
+    ap.add_argument('--nm', required=True)
+    ap.add_argument('--lib', action='append', default=[],
+                    help='component archive whose functions are followed (repeatable)')
+    args = ap.parse_args()
+
+    elf = Elf(args.elf)
+    errors, checked = check(elf, disassemble_iram(args.objdump, args.elf),
+                            own_functions(args.nm, args.lib))
+    if errors:
+        for e in errors:
+            print(f'check_iram: {e}', file=sys.stderr)
+        print(f'check_iram: {len(errors)} DMX ISR placement error(s); '
+              'see components/mod_dmx/README.md', file=sys.stderr)
+        return 1
+    print(f'check_iram: DMX ISR path OK ({checked} functions in IRAM)')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())